@@ -0,0 +1,276 @@
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <calibration/CheckerboardCalibration.hpp>
+#include <calibration/CameraIntrinsics.hpp>
+#include <capture/CameraSource.hpp>
+#include <capture/NetworkSource.hpp>
+#include <util/Process.hpp>
+#include <CameraServer.hpp>
+#include <Config.hpp>
+
+/**
+ * The tracking service, runs the camera pipeline outside of SteamVR and
+ * publishes the poses to the driver through shared memory.
+ *
+ * The service can be stopped and started at any time, the driver marks the
+ * trackers as out of range while it is gone and picks it up again once it
+ * is back. If the camera goes away the service exits with an error, so it
+ * can be restarted by whatever started it.
+ */
+
+/**
+ * Set by the signal handler to stop the service
+ */
+static std::atomic<bool> mStop { false };
+
+/**
+ * How many views of the checkerboard the camera calibration takes
+ */
+constexpr int CALIBRATION_VIEWS = 25;
+
+/**
+ * Set by the signal handler to load the pose network again
+ */
+static std::atomic<bool> mReloadModel { false };
+
+static void OnSignal(int) {
+    mStop = true;
+}
+
+static void OnReloadSignal(int) {
+    mReloadModel = true;
+}
+
+/**
+ * An option that sets an integer in the config, flags are set to 1
+ */
+struct IntOption {
+    const char* name;
+    int* value;
+    bool flag;
+    const char* help;
+};
+
+static void Usage(const char* name, const std::vector<IntOption>& options) {
+    std::printf("usage: %s [options]\n", name);
+    for (const auto& option : options) {
+        std::printf("  %-22s %s\n", option.flag ? option.name : (std::string(option.name) + " <n>").c_str(), option.help);
+    }
+    std::printf("  %-22s %s\n", "--cameras <a,b,...>", "track with all of these local cameras");
+    std::printf("  %-22s %s\n", "--video <file>", "play a recorded video instead of a camera, and stop at its end");
+    std::printf("  %-22s %s\n", "--intrinsics <file>", "the lens of the camera the video was recorded with");
+    std::printf("  %-22s %s\n", "--model <file>", "the pose network, loaded again on SIGHUP");
+    std::printf("  %-22s %s\n", "--lifter <file>", "lift the keypoints with this temporal network");
+    std::printf("  %-22s %s\n", "--cpus <a,b,...>", "only run on the given CPUs");
+    std::printf("  %-22s %s\n", "--nice <n>", "the priority of the service, -20 to 19");
+}
+
+/**
+ * Parse a comma separated list of numbers, CPUs or cameras
+ */
+static bool ParseList(const char* list, std::vector<int>& values) {
+    const char* current = list;
+    while (*current != '\0') {
+        char* end;
+        long value = std::strtol(current, &end, 10);
+        if (end == current || (*end != ',' && *end != '\0')) {
+            return false;
+        }
+        values.push_back(static_cast<int>(value));
+        current = *end == ',' ? end + 1 : end;
+    }
+    return !values.empty();
+}
+
+/**
+ * Calibrate the lens of the camera from a checkerboard held in front of it, and
+ * save it where the pipeline looks for it
+ */
+static int RunCameraCalibration(const Config& config, int columns, int rows) {
+    std::unique_ptr<FrameSource> source;
+    int camera = -1;
+    if (config.networkPort != 0) {
+        source = std::make_unique<NetworkSource>(static_cast<uint16_t>(config.networkPort));
+    } else {
+        camera = config.cameras.empty() ? config.cameraIndex : config.cameras.front();
+        source = std::make_unique<CameraSource>(camera);
+    }
+
+    std::printf("hold a checkerboard with %dx%d inner corners in front of the camera, all over the frame, "
+                "at different distances and angles\n", columns, rows);
+
+    CheckerboardCalibration calibration(columns, rows);
+    while (!mStop && calibration.GetViewCount() < CALIBRATION_VIEWS) {
+        Frame* frame = source->Next();
+        if (frame == nullptr) {
+            break;
+        }
+
+        if (calibration.AddFrame(frame->image)) {
+            std::printf("view %d of %d\n", calibration.GetViewCount(), CALIBRATION_VIEWS);
+        }
+        source->Release(frame);
+    }
+    source->Close();
+
+    CameraIntrinsics intrinsics;
+    double error;
+    if (!calibration.Solve(intrinsics, error)) {
+        std::printf("not enough views of the checkerboard to calibrate\n");
+        return 1;
+    }
+
+    std::string path = CameraIntrinsics::GetDefaultPath(camera);
+    std::printf("calibrated with an error of %.3f pixels\n", error);
+    if (!intrinsics.Save(path)) {
+        std::printf("failed to save %s\n", path.c_str());
+        return 1;
+    }
+    std::printf("saved to %s\n", path.c_str());
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    Config& config = GetConfig();
+
+    // the switches are bools in the config, parse them as ints
+    int motionGate = config.motionGate;
+    int noFitting = !config.skeletonFitting;
+    int pinThreads = config.pinThreads;
+    int proposalParser = config.proposalParser;
+    int taskPool = config.taskPool;
+    int calibrateCamera = 0;
+    int boardColumns = 9;
+    int boardRows = 6;
+    std::vector<IntOption> options = {
+        { "--camera", &config.cameraIndex, false, "the index of the local camera" },
+        { "--port", &config.networkPort, false, "receive the camera of a phone on this UDP port" },
+        { "--persons", &config.maxPersons, false, "how many people to track" },
+        { "--keyframe", &config.keyframeInterval, false, "run the network every N frames" },
+        { "--motion-gate", &motionGate, true, "skip the network when nothing moved" },
+        { "--decode-threads", &config.decodeThreads, false, "threads decoding MJPEG frames" },
+        { "--no-fitting", &noFitting, true, "don't fit the skeleton of the user to the keypoints" },
+        { "--proposal-parser", &proposalParser, true, "parse the network output with our own parser" },
+        { "--pin", &pinThreads, true, "pin every pipeline thread to a core of its own" },
+        { "--realtime", &config.realtimePriority, false, "run the pipeline threads with this SCHED_FIFO priority" },
+        { "--task-pool", &taskPool, true, "run the pipeline as tasks on a pool of workers" },
+        { "--workers", &config.workers, false, "workers of the task pool, one per core by default" },
+        { "--calibrate-camera", &calibrateCamera, true, "calibrate the lens of the camera with a checkerboard" },
+        { "--board-columns", &boardColumns, false, "inner corners along a row of the checkerboard" },
+        { "--board-rows", &boardRows, false, "inner corners along a column of the checkerboard" },
+    };
+
+    std::vector<int> cpus;
+    bool setNice = false;
+    int nice = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool found = false;
+
+        for (const auto& option : options) {
+            if (std::strcmp(arg, option.name) != 0) {
+                continue;
+            }
+
+            if (option.flag) {
+                *option.value = 1;
+            } else if (i + 1 < argc) {
+                *option.value = std::atoi(argv[++i]);
+            } else {
+                break;
+            }
+            found = true;
+            break;
+        }
+
+        if (!found && std::strcmp(arg, "--cpus") == 0 && i + 1 < argc) {
+            found = ParseList(argv[++i], cpus);
+        } else if (!found && std::strcmp(arg, "--cameras") == 0 && i + 1 < argc) {
+            found = ParseList(argv[++i], config.cameras);
+        } else if (!found && std::strcmp(arg, "--video") == 0 && i + 1 < argc) {
+            config.video = argv[++i];
+            found = true;
+        } else if (!found && std::strcmp(arg, "--intrinsics") == 0 && i + 1 < argc) {
+            config.videoIntrinsics = argv[++i];
+            found = true;
+        } else if (!found && std::strcmp(arg, "--model") == 0 && i + 1 < argc) {
+            config.poseModel = argv[++i];
+            found = true;
+        } else if (!found && std::strcmp(arg, "--lifter") == 0 && i + 1 < argc) {
+            config.lifterModel = argv[++i];
+            found = true;
+        } else if (!found && std::strcmp(arg, "--nice") == 0 && i + 1 < argc) {
+            nice = std::atoi(argv[++i]);
+            setNice = true;
+            found = true;
+        }
+
+        if (!found) {
+            Usage(argv[0], options);
+            return 1;
+        }
+    }
+    config.motionGate = motionGate != 0;
+    config.skeletonFitting = noFitting == 0;
+    config.pinThreads = pinThreads != 0;
+    config.proposalParser = proposalParser != 0;
+    config.taskPool = taskPool != 0;
+
+    // without a decoder the MJPEG frames would never come out
+    if (config.decodeThreads < 1) {
+        std::printf("decoding MJPEG frames on a single thread\n");
+        config.decodeThreads = 1;
+    }
+
+    // set these before any thread is started, so all of them get it
+    if (!cpus.empty() && !SetProcessAffinity(cpus)) {
+        std::printf("failed to set the CPU affinity, running on all CPUs\n");
+    }
+    if (setNice && !SetProcessPriority(nice)) {
+        std::printf("failed to set the priority to %d, running at the default priority\n", nice);
+    }
+
+    std::signal(SIGINT, OnSignal);
+    std::signal(SIGTERM, OnSignal);
+#ifdef SIGHUP
+    std::signal(SIGHUP, OnReloadSignal);
+#endif
+
+    if (calibrateCamera) {
+        return RunCameraCalibration(config, boardColumns, boardRows);
+    }
+
+    if (!StartCameraServer()) {
+        std::printf("failed to start the camera server\n");
+        return 1;
+    }
+
+    while (!mStop && IsCameraServerRunning()) {
+        // the model file was replaced, the trackers keep going while it is built
+        if (mReloadModel.exchange(false) && !SwapPoseModel(config.poseModel)) {
+            std::printf("still loading the last pose network\n");
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+
+    // if we did not ask it to stop, the camera is gone, a video just ended
+    bool failed = !mStop && config.video.empty();
+    StopCameraServer();
+
+    if (failed) {
+        std::printf("the camera stopped\n");
+        return 1;
+    }
+
+    return 0;
+}
@@ -1,126 +1,678 @@
-#include <hyperpose/hyperpose.hpp>
-#include <opencv2/opencv.hpp>
-
-#include <atomic>
-#include <thread>
-
-#include <pose/Pose3D.hpp>
-
-#include "CameraServer.hpp"
-
-/**
- * Allows the stop function to tell the camera server to stop
- */
-static std::atomic<bool> mRunning = false;
-
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-/**
- * Setup the model that we are going to use
- */
-static auto mHyperPoseEngine = hyperpose::dnn::tensorrt(
-            hyperpose::dnn::onnx{ "ppn-resnet50-V2-HW=384x384.onnx" },
-            { 384, 384 },
-            1
-        );
-
-/**
- * Setup the parser we are going to use
- */
-static auto mHyperPoseParser = hyperpose::parser::pose_proposal(mHyperPoseEngine.input_size());
-
-static void LoadModel() {
-
-}
-
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-/**
- * The thread that handles capturing
- */
-static std::thread mCaptureThread;
-
-/**
- * Handle capture
- */
-static void CaptureThread() {
-    cv::VideoCapture vidCapture1 {0, cv::CAP_V4L2};
-
-    mRunning = true;
-    while (mRunning) {
-        // capture the two images
-        cv::Mat capture1;
-        vidCapture1 >> capture1;
-
-        // Do the HyperPose pose estimation
-        auto featureMaps = mHyperPoseEngine.inference({ capture1 });
-        auto poses = mHyperPoseParser.process(featureMaps.front());
-
-        // find the pose with the best score and use it
-        hyperpose::human_t* bestPose = nullptr;
-        for (auto& pose : poses) {
-            if (bestPose != nullptr && bestPose->score < pose.score) {
-                bestPose = &pose;
-            } else if (bestPose == nullptr) {
-                bestPose = &pose;
-            }
-        }
-
-        // check if we even found a good pose
-        if (bestPose != nullptr) {
-            // we got a pose, reconstruct setup the points for 3d reconstruction
-            std::array<vector2, hyperpose::COCO_N_PARTS> positions {
-                vector2(bestPose->parts[0].x, bestPose->parts[0].y),
-                vector2(bestPose->parts[1].x, bestPose->parts[1].y),
-                vector2(bestPose->parts[2].x, bestPose->parts[2].y),
-                vector2(bestPose->parts[3].x, bestPose->parts[3].y),
-                vector2(bestPose->parts[4].x, bestPose->parts[4].y),
-                vector2(bestPose->parts[5].x, bestPose->parts[5].y),
-                vector2(bestPose->parts[6].x, bestPose->parts[6].y),
-                vector2(bestPose->parts[7].x, bestPose->parts[7].y),
-                vector2(bestPose->parts[8].x, bestPose->parts[8].y),
-                vector2(bestPose->parts[9].x, bestPose->parts[9].y),
-                vector2(bestPose->parts[10].x, bestPose->parts[10].y),
-                vector2(bestPose->parts[11].x, bestPose->parts[11].y),
-                vector2(bestPose->parts[12].x, bestPose->parts[12].y),
-                vector2(bestPose->parts[13].x, bestPose->parts[13].y),
-                vector2(bestPose->parts[14].x, bestPose->parts[14].y),
-                vector2(bestPose->parts[15].x, bestPose->parts[15].y),
-                vector2(bestPose->parts[16].x, bestPose->parts[16].y),
-                vector2(bestPose->parts[17].x, bestPose->parts[17].y),
-            };
-
-            // do the 3d reconstruction
-            // TODO: have the rel order so we would have better things
-            Pose3D pose3d = Pose3D(positions, std::array<int, 11>());
-
-            // update all the positions of the virtual trackers now that we have a new position
-            GetDriverInstance().LeftLegTracker.UpdatePoint(pose3d.joints[JT_LEFT_ANKLE]);
-            GetDriverInstance().RightLegTracker.UpdatePoint(pose3d.joints[JT_RIGHT_ANKLE]);
-            GetDriverInstance().HipTracker.UpdatePoint(middle(pose3d.joints[JT_LEFT_HIP], pose3d.joints[JT_RIGHT_HIP]));
-        } else {
-            GetDriverInstance().LeftLegTracker.UpdateOutOfRange();
-            GetDriverInstance().RightLegTracker.UpdateOutOfRange();
-            GetDriverInstance().HipTracker.UpdateOutOfRange();
-        }
-    }
-}
-
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-// TODO: the contorl server, allowing an external app to control which cameras and stuff we are going to use
-
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-[[noreturn]] void StartCameraServer() {
-    // create the capture server thread
-    mCaptureThread = std::thread(CaptureThread);
-}
-
-void StopCameraServer() {
-    // tell everything to stop
-    mRunning = true;
-
-    // wait for all threads to stop
-    mCaptureThread.join();
-}
+#include <hyperpose/hyperpose.hpp>
+#include <opencv2/opencv.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <mutex>
+
+#include <calibration/CameraIntrinsics.hpp>
+#include <capture/CameraSource.hpp>
+#include <capture/NetworkSource.hpp>
+#include <capture/VideoSource.hpp>
+#include <ipc/PoseChannel.hpp>
+#include <util/AllocationAudit.hpp>
+#include <util/Process.hpp>
+#include <util/TaskPool.hpp>
+#include <util/Time.hpp>
+#include <tracking/RegionOfInterest.hpp>
+#include <tracking/KeypointFlow.hpp>
+#include <tracking/MotionGate.hpp>
+#include <tracking/PoseAssociator.hpp>
+#include <pose/Pose3D.hpp>
+#include <pose/ProposalParser.hpp>
+#include <pose/SkeletonFitter.hpp>
+#include <pose/TemporalLifter.hpp>
+
+#include "CameraServer.hpp"
+#include "PipelineThreads.hpp"
+#include "Config.hpp"
+
+/**
+ * Allows the stop function to tell the camera server to stop
+ */
+static std::atomic<bool> mRunning = false;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * The size of the network input, every model we load is built for it
+ */
+constexpr int NETWORK_INPUT_SIZE = 384;
+
+/**
+ * A pose network built for TensorRT, and the HyperPose parser for its output
+ */
+struct PoseEngine {
+    std::string path;
+    hyperpose::dnn::tensorrt engine;
+    hyperpose::parser::pose_proposal parser;
+
+    explicit PoseEngine(const std::string& path)
+        : path(path)
+        , engine(hyperpose::dnn::onnx{ path }, { NETWORK_INPUT_SIZE, NETWORK_INPUT_SIZE }, 1)
+        , parser(engine.input_size())
+    {
+    }
+};
+
+/**
+ * The engines are double buffered, a new model is built into the slot that is not
+ * in use while the active one keeps serving frames, and the pipelines switch to it
+ * between two inferences
+ */
+static std::array<std::unique_ptr<PoseEngine>, 2> mEngines;
+static int mActiveEngine = 0;
+
+/**
+ * The active engine is shared by all the cameras, only one of them can
+ * use it at a time, and it is only switched while holding this
+ */
+static std::mutex mEngineMutex;
+
+/**
+ * Builds the next model, away from the pipeline threads
+ */
+static std::thread mModelThread;
+static std::atomic<bool> mModelLoading = false;
+
+/**
+ * Build the engine of a model, TensorRT takes a while for a new
+ * one and HyperPose throws if it can't
+ *
+ * @return The engine, or null if the model could not be loaded
+ */
+static std::unique_ptr<PoseEngine> LoadModel(const std::string& path) {
+    if (!std::filesystem::exists(path)) {
+        std::printf("the pose network %s does not exist\n", path.c_str());
+        return nullptr;
+    }
+
+    try {
+        return std::make_unique<PoseEngine>(path);
+    } catch (const std::exception& exception) {
+        std::printf("failed to load the pose network %s: %s\n", path.c_str(), exception.what());
+        return nullptr;
+    }
+}
+
+/**
+ * Build a new model and switch the pipelines over to it
+ */
+static void ModelThread(std::string path) {
+    SetThreadName("pmfbt-model");
+
+    std::unique_ptr<PoseEngine> engine = LoadModel(path);
+    if (engine == nullptr) {
+        mModelLoading = false;
+        return;
+    }
+
+    // only the pointers change hands under the lock, a pipeline waits
+    // for at most one inference of the old engine to finish
+    std::unique_ptr<PoseEngine> old;
+    {
+        std::lock_guard<std::mutex> guard{mEngineMutex};
+        int next = 1 - mActiveEngine;
+        mEngines[next] = std::move(engine);
+        old = std::move(mEngines[mActiveEngine]);
+        mActiveEngine = next;
+    }
+
+    // tearing the old engine down takes a while as well, the pipelines
+    // no longer see it so it is done here
+    old.reset();
+    std::printf("switched to the pose network %s\n", path.c_str());
+    mModelLoading = false;
+}
+
+/**
+ * The temporal lifting network, if one was given, shared by all the cameras
+ */
+static LifterModel mLifterModel;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Everything that tracks the people seen by a single camera
+ */
+struct CameraPipeline {
+    /**
+     * Where the frames come from, a phone on the network or a local camera
+     */
+    std::unique_ptr<FrameSource> source;
+
+    /**
+     * The lens of the camera, the keypoints are undistorted with it if it was calibrated
+     */
+    CameraIntrinsics intrinsics;
+
+    /**
+     * Where the poses go to, the driver reads them from there
+     */
+    PoseWriter poseWriter;
+
+    RegionOfInterest regionOfInterest;
+    KeypointFlow keypointFlow;
+    MotionGate motionGate;
+    PoseAssociator associator;
+
+    /**
+     * Our own parser, and the poses it found in the last frame
+     */
+    ProposalParser proposalParser;
+    ParsedPoses parsedPoses;
+
+    /**
+     * The skeleton of everyone we track, and who it belongs to
+     */
+    std::array<SkeletonFitter, MAX_PERSONS> fitters;
+    std::array<uint32_t, MAX_PERSONS> fitterIds;
+
+    /**
+     * The keypoint history of everyone we track, when lifting with the
+     * temporal network, they belong to the same people as the fitters
+     */
+    std::array<TemporalLifter, MAX_PERSONS> lifters;
+
+    /**
+     * Are we tracking anyone, how long ago the network last ran
+     * and for how many frames we reused the poses without any motion
+     */
+    bool tracking;
+    int framesSinceKeyframe;
+    int framesStill;
+
+    PoseFeedFrame poses;
+
+    /**
+     * Set while a task for this camera is queued or running, so
+     * its frames are processed one at a time and in order
+     */
+    std::atomic<bool> scheduled;
+
+    CameraPipeline()
+        : source()
+        , intrinsics()
+        , poseWriter()
+        , regionOfInterest({ NETWORK_INPUT_SIZE, NETWORK_INPUT_SIZE })
+        , keypointFlow()
+        , motionGate()
+        , associator()
+        , proposalParser()
+        , parsedPoses()
+        , fitters()
+        , fitterIds()
+        , lifters()
+        , tracking(false)
+        , framesSinceKeyframe(0)
+        , framesStill(0)
+        , poses()
+        , scheduled(false)
+    {
+        for (auto& lifter : lifters) {
+            lifter.SetModel(&mLifterModel);
+        }
+    }
+};
+
+/**
+ * All the cameras, the first one publishes to the feed the driver reads
+ */
+static std::vector<std::unique_ptr<CameraPipeline>> mPipelines;
+
+/**
+ * The thread that handles capturing, with a single camera
+ */
+static std::thread mCaptureThread;
+
+/**
+ * Runs the pipelines of all the cameras otherwise
+ */
+static std::unique_ptr<TaskPool> mTaskPool;
+
+/**
+ * Run the network on the frame and match the poses it found to the people we track
+ *
+ * @param pipeline  [IN/OUT]    The camera the frame is from
+ * @param frame     [IN]        The full camera frame
+ */
+static void EstimatePoses(CameraPipeline& pipeline, const cv::Mat& frame) {
+    int maxPersons = GetConfig().maxPersons;
+    auto& regionOfInterest = pipeline.regionOfInterest;
+    auto& associator = pipeline.associator;
+    auto& parsedPoses = pipeline.parsedPoses;
+    std::unique_lock<std::mutex> engineLock{mEngineMutex};
+    PoseEngine& engine = *mEngines[mActiveEngine];
+
+    // only run the network on the region the user was last seen in, with
+    // more than one person we always need the full frame
+    if (maxPersons > 1) {
+        regionOfInterest.Reset();
+    }
+
+    // Do the HyperPose inference, it hands everything around in
+    // vectors it allocates, that's out of our hands
+    const cv::Mat& input = regionOfInterest.Crop(frame);
+    auto featureMaps = [&] {
+        LibraryAllocations libraryAllocations;
+        return engine.engine.inference({ input });
+    }();
+
+    // parse the poses ourselves if we can, and fall back to HyperPose
+    // if the model is not laid out the way we expect
+    std::vector<hyperpose::human_t> fallbackPoses;
+    hyperpose::human_t* poses = parsedPoses.poses.data();
+    size_t count = 0;
+    if (GetConfig().proposalParser && pipeline.proposalParser.Parse(featureMaps.front(), parsedPoses)) {
+        engineLock.unlock();
+        count = parsedPoses.count;
+    } else {
+        LibraryAllocations libraryAllocations;
+        fallbackPoses = engine.parser.process(featureMaps.front());
+        engineLock.unlock();
+        poses = fallbackPoses.data();
+        count = fallbackPoses.size();
+    }
+
+    // get the keypoints back to full frame coordinates
+    for (size_t i = 0; i < count; i++) {
+        regionOfInterest.MapToFrame(poses[i]);
+    }
+
+    associator.Update(poses, count, maxPersons);
+
+    // crop around the user on the next frame, or look at the
+    // full frame if we lost them
+    auto& person = associator.GetPerson(0);
+    if (maxPersons == 1 && person.active && person.missedFrames == 0) {
+        regionOfInterest.Update(person.pose);
+    } else {
+        regionOfInterest.Reset();
+    }
+}
+
+static_assert(JT_COUNT == POSE_FEED_JOINTS, "The feed must have all of our joints");
+static_assert(CocoTopology::KEYPOINT_COUNT == hyperpose::COCO_N_PARTS, "HyperPose gives us the keypoints of COCO");
+
+/**
+ * Get the keypoints of a person for the skeleton fitting, in our joints, as an ideal
+ * camera would see them. Only the keypoints are undistorted, the tracking keeps
+ * working on the ones in the frame.
+ */
+static void GetObservation(const hyperpose::human_t& pose, const CameraIntrinsics& intrinsics, SkeletonObservation& observation) {
+    if (!intrinsics.IsValid()) {
+        GetJointKeypoints<CocoTopology>(pose.parts.data(), observation.points, observation.confidences);
+        return;
+    }
+
+    auto parts = pose.parts;
+    for (auto& part : parts) {
+        if (part.has_value) {
+            intrinsics.Undistort(part.x, part.y);
+        }
+    }
+    GetJointKeypoints<CocoTopology>(parts.data(), observation.points, observation.confidences);
+}
+
+/**
+ * Put a person into the pose feed, lifting them with the temporal network or fitting
+ * their skeleton if we can, and reconstructing the single frame otherwise
+ */
+static void PublishPerson(const TrackedPerson& person, const SkeletonObservation& observation, int64_t timestamp,
+                          SkeletonFitter& fitter, TemporalLifter& lifter, PoseFeedPerson& out) {
+    const auto& pose = person.pose;
+
+    std::array<vector3, JT_COUNT> joints;
+    bool lifted = lifter.IsReady() && lifter.Lift(timestamp, observation, joints);
+    if (!lifted && (!GetConfig().skeletonFitting || !fitter.Fit(observation, joints))) {
+        joints = Pose3D(observation.points, {}).joints;
+    }
+
+    // never hand a broken pose to the driver, it would end up in SteamVR
+    for (const auto& joint : joints) {
+        if (!std::isfinite(joint.x) || !std::isfinite(joint.y) || !std::isfinite(joint.z)) {
+            out.active = false;
+            return;
+        }
+    }
+
+    out.score = pose.score;
+    for (int i = 0; i < JT_COUNT; i++) {
+        out.confidences[i] = observation.confidences[i];
+        out.joints[i] = { joints[i].x, joints[i].y, joints[i].z };
+    }
+}
+
+/**
+ * Track the people in a single frame and publish them
+ *
+ * @param pipeline  [IN/OUT]    The camera the frame is from
+ * @param frame     [IN]        The frame, given back to the source once we are done with it
+ */
+static void ProcessFrame(CameraPipeline& pipeline, Frame* frame) {
+    const Config& config = GetConfig();
+    auto& associator = pipeline.associator;
+    auto& poses = pipeline.poses;
+
+    const cv::Mat& capture1 = frame->image;
+    poses.frameIndex = frame->index;
+    poses.captureTime = frame->timestamp;
+
+    // if nothing moved since the keypoints were updated we can just reuse them
+    bool still = false;
+    if (config.motionGate) {
+        bool moved = pipeline.motionGate.HasMotion(capture1, config.motionThreshold);
+        still = pipeline.tracking && !moved && ++pipeline.framesStill < config.motionRefreshInterval;
+    }
+
+    if (!still) {
+        pipeline.framesStill = 0;
+
+        // between keyframes we only move the keypoints along with the optical flow,
+        // this only works for a single person
+        auto& user = associator.GetPerson(0);
+        bool singlePerson = config.maxPersons == 1;
+        bool propagated = false;
+        if (singlePerson && pipeline.tracking && ++pipeline.framesSinceKeyframe < config.keyframeInterval) {
+            propagated = pipeline.keypointFlow.Propagate(capture1, user.pose);
+            if (propagated) {
+                pipeline.regionOfInterest.Update(user.pose);
+            }
+        }
+
+        // this is a keyframe, or the flow was not good enough, run the network
+        if (!propagated) {
+            pipeline.framesSinceKeyframe = 0;
+            EstimatePoses(pipeline, capture1);
+            pipeline.tracking = associator.IsTracking();
+            if (singlePerson && pipeline.tracking && config.keyframeInterval > 1) {
+                pipeline.keypointFlow.SetKeyframe(capture1, user.pose);
+            }
+        }
+
+        // the keypoints now come from this frame
+        if (pipeline.tracking && config.motionGate) {
+            pipeline.motionGate.SetReference();
+        }
+    }
+
+    // we are done with the image, let the source reuse it
+    pipeline.source->Release(frame);
+
+    // publish everyone we track, the driver marks
+    // everyone else as out of range
+    for (int slot = 0; slot < MAX_PERSONS; slot++) {
+        const auto& person = associator.GetPerson(slot);
+        auto& out = poses.persons[slot];
+
+        bool tracked = slot < config.maxPersons && person.active;
+        out.id = tracked ? person.id + 1 : 0;
+        out.active = tracked && person.missedFrames == 0;
+
+        // someone else took the slot, they have their own skeleton
+        if (pipeline.fitterIds[slot] != out.id) {
+            pipeline.fitters[slot].Reset();
+            pipeline.lifters[slot].Reset();
+            pipeline.fitterIds[slot] = out.id;
+        }
+
+        if (out.active) {
+            SkeletonObservation observation;
+            GetObservation(person.pose, pipeline.intrinsics, observation);
+            PublishPerson(person, observation, poses.captureTime, pipeline.fitters[slot], pipeline.lifters[slot], out);
+        }
+    }
+
+    poses.publishTime = GetMicroseconds();
+    pipeline.poseWriter.Publish(poses);
+}
+
+static_assert(SP_REALTIME == POSE_FEED_SCHEDULING_REALTIME && SP_NICE == POSE_FEED_SCHEDULING_NICE, "The feed uses our policies");
+
+/**
+ * Handle capture, with a single camera
+ */
+static void CaptureThread() {
+    CameraPipeline& pipeline = *mPipelines.front();
+    ThreadScheduling scheduling = SetupPipelineThread("pmfbt-capture");
+    pipeline.poseWriter.SetScheduling(scheduling.policy, scheduling.priority, scheduling.cpuMask);
+
+    // once running, nothing in here should allocate
+    AllocationAudit allocationAudit { "pmfbt-capture" };
+
+    while (mRunning) {
+        // wait for the newest frame
+        Frame* frame = pipeline.source->Next();
+        if (frame == nullptr) {
+            break;
+        }
+
+        ProcessFrame(pipeline, frame);
+        allocationAudit.EndFrame();
+    }
+
+    // let the service know we stopped, so it can exit and be restarted
+    mRunning = false;
+}
+
+static void RunCamera(void* context);
+
+/**
+ * Queue the next frame of a camera, unless it already has a task
+ *
+ * @param pipeline  [IN] The camera
+ * @param timestamp [IN] The capture time of its frame, older frames run first
+ */
+static void ScheduleCamera(CameraPipeline& pipeline, int64_t timestamp) {
+    if (!pipeline.scheduled.exchange(true)) {
+        mTaskPool->Submit({ RunCamera, &pipeline, timestamp });
+    }
+}
+
+/**
+ * Called by the source of a camera for every new frame
+ */
+static void OnFrame(void* context, int64_t timestamp) {
+    ScheduleCamera(*static_cast<CameraPipeline*>(context), timestamp);
+}
+
+/**
+ * Process the newest frame of a camera, as a task
+ */
+static void RunCamera(void* context) {
+    CameraPipeline& pipeline = *static_cast<CameraPipeline*>(context);
+
+    // the workers run all kinds of tasks, only the frames themselves must not
+    // allocate, every worker checks the frames it ran
+    static thread_local AllocationAudit allocationAudit { "pmfbt-worker" };
+
+    Frame* frame = pipeline.source->TryNext();
+    if (frame != nullptr && mRunning) {
+        allocationAudit.BeginFrame();
+        ProcessFrame(pipeline, frame);
+        allocationAudit.EndFrame();
+    } else if (frame != nullptr) {
+        pipeline.source->Release(frame);
+    }
+
+    // a frame that came in while we were busy did not queue a task, so check for
+    // one after we let go, the listener takes care of everything after that
+    pipeline.scheduled = false;
+    int64_t timestamp;
+    if (pipeline.source->HasNext(timestamp)) {
+        ScheduleCamera(pipeline, timestamp);
+    } else if (pipeline.source->IsClosed()) {
+        // let the service know the camera is gone, so it can exit and be restarted
+        mRunning = false;
+    }
+}
+
+/**
+ * Set up every worker of the task pool as a pipeline thread
+ */
+static void StartWorker(int worker) {
+    ThreadScheduling scheduling = SetupPipelineThread("pmfbt-worker");
+
+    // the workers all end up the same, the first one tells the readers
+    if (worker == 0) {
+        for (auto& pipeline : mPipelines) {
+            pipeline->poseWriter.SetScheduling(scheduling.policy, scheduling.priority, scheduling.cpuMask);
+        }
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// TODO: the contorl server, allowing an external app to control which cameras and stuff we are going to use
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool StartCameraServer() {
+    const Config& config = GetConfig();
+
+    // a phone on the network or a recorded video comes first, then the local cameras
+    bool remote = config.networkPort != 0 || !config.video.empty();
+    int cameraCount = (remote ? 1 : 0) + static_cast<int>(config.cameras.size());
+    if (cameraCount == 0) {
+        cameraCount = 1;
+    }
+    if (cameraCount > MAX_CAMERAS) {
+        std::printf("only using the first %d cameras\n", MAX_CAMERAS);
+        cameraCount = MAX_CAMERAS;
+    }
+
+    // the pose network has to be there before the first frame, later
+    // ones are built while this one keeps running
+    mEngines[0] = LoadModel(config.poseModel);
+    mActiveEngine = 0;
+    if (mEngines[0] == nullptr) {
+        return false;
+    }
+
+    // the pipelines pick the lifting network up when they are created
+    if (!config.lifterModel.empty()) {
+        if (mLifterModel.Load(config.lifterModel)) {
+            std::printf("lifting with %s, %d frames of %d channels\n", config.lifterModel.c_str(),
+                        mLifterModel.GetReceptiveField(), mLifterModel.GetChannels());
+        } else {
+            std::printf("failed to load the lifting network %s, fitting the skeleton instead\n", config.lifterModel.c_str());
+        }
+    }
+
+    // the first camera has the feed the driver reads, the others have their own
+    for (int i = 0; i < cameraCount; i++) {
+        auto pipeline = std::make_unique<CameraPipeline>();
+        std::string name = i == 0 ? POSE_FEED_NAME : std::string(POSE_FEED_NAME) + "-" + std::to_string(i);
+        if (!pipeline->poseWriter.Open(name.c_str())) {
+            std::printf("failed to open the pose channel %s\n", name.c_str());
+            mPipelines.clear();
+            mEngines = {};
+            return false;
+        }
+        mPipelines.push_back(std::move(pipeline));
+    }
+
+    // with more than one camera the pipelines share the workers of a task pool
+    mRunning = true;
+    if (cameraCount > 1 || config.taskPool) {
+        int workers = config.workers > 0 ? config.workers : static_cast<int>(GetPhysicalCores().size());
+        mTaskPool = std::make_unique<TaskPool>(workers, StartWorker);
+    }
+
+    // open the frame sources, with the lens of every camera if it was calibrated
+    for (int i = 0; i < cameraCount; i++) {
+        int camera = -1;
+        std::string intrinsicsPath;
+        if (i == 0 && !config.video.empty()) {
+            // nothing is known about the lens of a recording, unless we are told
+            intrinsicsPath = config.videoIntrinsics;
+            auto video = std::make_unique<VideoSource>(config.video);
+            if (!video->IsOpened()) {
+                std::printf("failed to open the video %s\n", config.video.c_str());
+                StopCameraServer();
+                return false;
+            }
+            mPipelines[i]->source = std::move(video);
+        } else if (i == 0 && config.networkPort != 0) {
+            mPipelines[i]->source = std::make_unique<NetworkSource>(static_cast<uint16_t>(config.networkPort), mTaskPool.get());
+            intrinsicsPath = CameraIntrinsics::GetDefaultPath(camera);
+        } else {
+            camera = config.cameras.empty() ? config.cameraIndex : config.cameras[i - (remote ? 1 : 0)];
+            mPipelines[i]->source = std::make_unique<CameraSource>(camera, mTaskPool.get());
+            intrinsicsPath = CameraIntrinsics::GetDefaultPath(camera);
+        }
+
+        if (intrinsicsPath.empty()) {
+            continue;
+        }
+        if (mPipelines[i]->intrinsics.Load(intrinsicsPath)) {
+            std::printf("undistorting the keypoints of camera %d with %s\n", i, intrinsicsPath.c_str());
+        } else if (intrinsicsPath == config.videoIntrinsics) {
+            std::printf("failed to load the intrinsics %s, the video is not undistorted\n", intrinsicsPath.c_str());
+        }
+    }
+
+    if (mTaskPool == nullptr) {
+        // create the capture server thread
+        mCaptureThread = std::thread(CaptureThread);
+        return true;
+    }
+
+    // a frame that came in before the listener was set has no task yet
+    for (auto& pipeline : mPipelines) {
+        pipeline->source->SetListener(OnFrame, pipeline.get());
+        ScheduleCamera(*pipeline, 0);
+    }
+    return true;
+}
+
+bool SwapPoseModel(const std::string& path) {
+    if (!mRunning || mModelLoading.exchange(true)) {
+        return false;
+    }
+
+    // the last one is done, it only has to be joined
+    if (mModelThread.joinable()) {
+        mModelThread.join();
+    }
+    mModelThread = std::thread(ModelThread, path);
+    return true;
+}
+
+bool IsCameraServerRunning() {
+    return mRunning;
+}
+
+void StopCameraServer() {
+    // tell everything to stop, and wake up the capture thread if it waits for a frame
+    mRunning = false;
+    for (auto& pipeline : mPipelines) {
+        if (pipeline->source != nullptr) {
+            pipeline->source->Close();
+        }
+    }
+
+    // wait for all threads to stop, the workers before the sources
+    // since they may still be decoding their frames
+    if (mCaptureThread.joinable()) {
+        mCaptureThread.join();
+    }
+    if (mModelThread.joinable()) {
+        mModelThread.join();
+    }
+    if (mTaskPool != nullptr) {
+        mTaskPool->Stop();
+    }
+    mPipelines.clear();
+    mTaskPool.reset();
+    mEngines = {};
+}
@@ -1,15 +1,32 @@
-#pragma once
-
-#include "PmfbtDriver.hpp"
-
-/**
- * Start the camera server thread, it will stream position
- * updates to the trackers
- */
-[[noreturn]] void StartCameraServer();
-
-/**
- * Stop the camera server
- */
-void StopCameraServer();
-
+#pragma once
+
+#include <string>
+
+/**
+ * Open the camera and start the camera server thread, it will publish
+ * the poses it finds to the driver
+ *
+ * @return False if the pose network could not be loaded or the pose channel could not be opened
+ */
+bool StartCameraServer();
+
+/**
+ * Build the pose network in this file in the background, the cameras keep using the
+ * current one until it is ready and switch to it between two frames
+ *
+ * @param path  [IN] The ONNX model, built for the same input size as the current one
+ *
+ * @return False if the server is not running or another model is still being loaded
+ */
+bool SwapPoseModel(const std::string& path);
+
+/**
+ * Is the camera server still running, it stops on its own
+ * if the camera goes away
+ */
+bool IsCameraServerRunning();
+
+/**
+ * Stop the camera server
+ */
+void StopCameraServer();
@@ -0,0 +1,6 @@
+#include "Config.hpp"
+
+Config& GetConfig() {
+    static Config instance;
+    return instance;
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/**
+ * The maximum amount of people we can track at the same time, each
+ * of them gets their own set of trackers
+ */
+constexpr int MAX_PERSONS = 4;
+
+/**
+ * The maximum amount of cameras we can track with at the same time
+ */
+constexpr int MAX_CAMERAS = 4;
+
+/**
+ * All the tunables of the tracking pipeline, these have sane
+ * defaults so everything works without any configuration
+ */
+struct Config {
+
+    /**
+     * The index of the local camera to capture from
+     */
+    int cameraIndex = 0;
+
+    /**
+     * If not zero, receive the frames from a phone streaming RTP to this
+     * UDP port instead of the local camera
+     */
+    int networkPort = 0;
+
+    /**
+     * If not empty, play this recorded video instead of the local camera
+     * or the phone, the service stops at the end of it
+     */
+    std::string video;
+
+    /**
+     * The lens of the camera the video was recorded with, saved by --calibrate-camera,
+     * the keypoints of a video are not undistorted without it
+     */
+    std::string videoIntrinsics;
+
+    /**
+     * The local cameras to capture from, every camera has a pipeline and a pose
+     * feed of its own. When empty only cameraIndex is used, and a phone on the
+     * network always comes first.
+     */
+    std::vector<int> cameras;
+
+    /**
+     * Run the pipelines as tasks on a pool of worker threads instead of a capture
+     * thread per camera, the oldest frame is always processed first. This is always
+     * done with more than one camera.
+     */
+    bool taskPool = false;
+
+    /**
+     * How many workers the task pool has, zero for one per physical core
+     */
+    int workers = 0;
+
+    /**
+     * Run the full network only every N frames, in between the keypoints are
+     * propagated from the last keyframe with optical flow. A value of 1 runs
+     * the network on every frame.
+     */
+    int keyframeInterval = 1;
+
+    /**
+     * Skip the network when the frame did not change since the keypoints were
+     * last updated, and reuse the previous keypoints instead.
+     */
+    bool motionGate = false;
+
+    /**
+     * The mean absolute luma difference per pixel, over a single tile, that
+     * counts as motion
+     */
+    int motionThreshold = 6;
+
+    /**
+     * Even without motion, refresh the keypoints every N frames so we
+     * never get stuck on a stale pose
+     */
+    int motionRefreshInterval = 30;
+
+    /**
+     * How many people to track, up to MAX_PERSONS. With more than one person
+     * the network always runs on the full frame, and the keyframe mode is
+     * not used.
+     */
+    int maxPersons = 1;
+
+    /**
+     * Ask the local camera for MJPEG, which most USB cameras need for high
+     * frame rates, and decode it ourselves. Cameras without MJPEG keep
+     * their default format.
+     */
+    bool cameraMjpeg = true;
+
+    /**
+     * How many threads decode MJPEG frames, at least one, more than one only
+     * helps when frames arrive faster than a single core can decode them
+     */
+    int decodeThreads = 2;
+
+    /**
+     * MJPEG frames are decoded at 1/2, 1/4 or 1/8 of their size as long
+     * as the longer side stays at least this big, the network input is
+     * only 384x384 anyways
+     */
+    int decodeMinSize = 640;
+
+    /**
+     * Fit a skeleton with the bone lengths of the user to the keypoints of every
+     * frame, instead of reconstructing every frame on its own with the average
+     * proportions
+     */
+    bool skeletonFitting = true;
+
+    /**
+     * The pose network, the service builds it again from this file
+     * when it gets SIGHUP
+     */
+    std::string poseModel = "ppn-resnet50-V2-HW=384x384.onnx";
+
+    /**
+     * If set, lift the keypoints to 3d with the temporal network in this file, over
+     * the keypoints of the last frames, instead of fitting a skeleton
+     */
+    std::string lifterModel;
+
+    /**
+     * Parse the output of the network with our own parser instead of the one of
+     * HyperPose, models it can't parse always use the HyperPose one. Off until the
+     * parser-agreement test passes on maps recorded from the real network.
+     */
+    bool proposalParser = false;
+
+    /**
+     * Pin every thread of the pipeline to a physical core of its own, so the
+     * scheduler doesn't move them around and they keep their caches warm
+     */
+    bool pinThreads = false;
+
+    /**
+     * Run the threads of the pipeline with this SCHED_FIFO priority, 1 to 99, so the
+     * game can't delay them. Zero keeps the normal scheduler, and so does a system
+     * that doesn't allow it.
+     */
+    int realtimePriority = 0;
+
+};
+
+/**
+ * Get the global configuration of the pipeline
+ */
+Config& GetConfig();
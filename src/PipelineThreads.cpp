@@ -0,0 +1,48 @@
+#include <atomic>
+#include <cstdio>
+
+#include "PipelineThreads.hpp"
+#include "Config.hpp"
+
+/**
+ * The names of the scheduling policies for the log
+ */
+static const char* POLICY_NAMES[] = {
+    "default",
+    "nice",
+    "realtime",
+};
+
+/**
+ * The next core to hand out
+ */
+static std::atomic<int> mNextCore = 0;
+
+ThreadScheduling SetupPipelineThread(const char* name) {
+    const Config& config = GetConfig();
+    SetThreadName(name);
+
+    // give every thread a core of its own, starting from the last one since the
+    // first cores are where the system and the game like to run
+    uint64_t cpuMask = 0;
+    if (config.pinThreads) {
+        static const std::vector<int> cores = GetPhysicalCores();
+        int cpu = cores[cores.size() - 1 - mNextCore++ % cores.size()];
+        if (SetThreadAffinity({ cpu })) {
+            cpuMask = cpu < 64 ? static_cast<uint64_t>(1) << cpu : 0;
+        } else {
+            std::printf("%s: failed to pin to cpu %d\n", name, cpu);
+        }
+    }
+
+    // without the permissions we keep the priority of the process, which is set by --nice
+    if (config.realtimePriority > 0 && !SetThreadRealtime(config.realtimePriority)) {
+        std::printf("%s: not allowed to use realtime priority %d\n", name, config.realtimePriority);
+    }
+
+    ThreadScheduling scheduling = GetThreadScheduling();
+    scheduling.cpuMask = cpuMask;
+    std::printf("%s: %s priority %d, cpus %llx\n", name, POLICY_NAMES[scheduling.policy], scheduling.priority,
+                static_cast<unsigned long long>(scheduling.cpuMask));
+    return scheduling;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <util/Process.hpp>
+
+/**
+ * Set up the calling thread of the pipeline as the config says, pin it to a
+ * physical core of its own and move it to the real time scheduler. Whatever the
+ * system refuses is skipped, and the thread runs with what it got.
+ *
+ * @param name  [IN] The name of the thread
+ *
+ * @return How the thread ended up being scheduled
+ */
+ThreadScheduling SetupPipelineThread(const char* name);
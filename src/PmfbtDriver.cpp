@@ -1,75 +1,439 @@
-#include "PmfbtDriver.hpp"
-
-#include "PmfbtTracker.hpp"
-#include "CameraServer.hpp"
-
-vr::EVRInitError PmfbtDriver::Init(vr::IVRDriverContext* driver_context) {
-    VR_INIT_SERVER_DRIVER_CONTEXT(driver_context);
-
-    // add all devices
-    vr::VRServerDriverHost()->TrackedDeviceAdded(
-            "PMFBT Left Leg",
-            vr::TrackedDeviceClass_GenericTracker,
-            &LeftLegTracker);
-
-    vr::VRServerDriverHost()->TrackedDeviceAdded(
-            "PMFBT Right Leg",
-            vr::TrackedDeviceClass_GenericTracker,
-            &RightLegTracker);
-
-    vr::VRServerDriverHost()->TrackedDeviceAdded(
-            "PMFBT Hip",
-            vr::TrackedDeviceClass_GenericTracker,
-            &HipTracker);
-
-    // start the camera server (handles all the camera inputs)
-    StartCameraServer();
-
-    return vr::VRInitError_None;
-}
-
-void PmfbtDriver::Cleanup() {
-    StopCameraServer();
-
-    VR_CLEANUP_SERVER_DRIVER_CONTEXT();
-}
-
-const char* const* PmfbtDriver::GetInterfaceVersions() {
-    return vr::k_InterfaceVersions;
-}
-
-void PmfbtDriver::RunFrame() {
-    vr::VREvent_t event{};
-    while (vr::VRServerDriverHost()->PollNextEvent(&event, sizeof(event))) {
-        // TODO: handle the event
-    }
-}
-
-bool PmfbtDriver::ShouldBlockStandbyMode() {
-    return false;
-}
-
-void PmfbtDriver::EnterStandby() {
-    // TODO: pause the tracking
-}
-
-void PmfbtDriver::LeaveStandby() {
-    // TODO: resume the tracking
-}
-
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-//
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-PmfbtDriver& GetDriverInstance() {
-    static PmfbtDriver instance;
-    return instance;
-}
-
-extern "C" void* HmdDriverFactory(const char* interface_name, int* return_code) {
-    if (std::string_view(interface_name) == vr::IServerTrackedDeviceProvider_Version) {
-        return &GetDriverInstance();
-    } else {
-        return nullptr;
-    }
+#include <algorithm>
+#include <string>
+#include <array>
+
+#include <util/Time.hpp>
+
+#include "PmfbtDriver.hpp"
+
+#include "PmfbtTracker.hpp"
+
+/**
+ * If the service did not publish anything for this long it is considered
+ * dead or stuck, and the trackers are marked as out of range until it is
+ * started again
+ */
+constexpr int64_t SERVICE_TIMEOUT = 500000;
+
+/**
+ * How sure the network has to be of the head to use it for calibration
+ */
+constexpr float MIN_HEAD_CONFIDENCE = 0.5f;
+
+/**
+ * The oldest frame we look up the HMD pose for, in seconds
+ */
+constexpr float MAX_FRAME_AGE = 0.25f;
+
+/**
+ * How often to save the calibration while it changes
+ */
+constexpr int64_t CALIBRATION_SAVE_INTERVAL = 30000000;
+
+/**
+ * How often to look for the controllers again
+ */
+constexpr int64_t HAND_LOOKUP_INTERVAL = 1000000;
+
+PmfbtDriver::PmfbtDriver() {
+    for (auto& person : Persons) {
+        for (auto& tracker : person.Trackers) {
+            tracker.SetMutex(&poseMutex);
+        }
+    }
+}
+
+void PmfbtDriver::AddPerson(int index) {
+    auto& person = Persons[index];
+
+    // the first person keeps the plain names, everyone else gets a number
+    std::string suffix = index == 0 ? "" : " " + std::to_string(index + 1);
+
+    for (int i = 0; i < TRACKER_COUNT; i++) {
+        vr::VRServerDriverHost()->TrackedDeviceAdded(
+                (TRACKERS[i].name + suffix).c_str(),
+                vr::TrackedDeviceClass_GenericTracker,
+                &person.Trackers[i]);
+    }
+
+    person.Added = true;
+}
+
+/**
+ * Get a joint out of the feed
+ */
+static vector3 GetJoint(const PoseFeedPerson& pose, JointType joint) {
+    const auto& position = pose.joints[joint];
+    return vector3(position.x, position.y, position.z);
+}
+
+/**
+ * Get the position of a tracker from the joints it is placed between
+ */
+static vector3 GetTrackerPosition(const PoseFeedPerson& pose, const TrackerDefinition& tracker) {
+    vector3 first = GetJoint(pose, tracker.first);
+    vector3 second = GetJoint(pose, tracker.second);
+    return first + (second - first) * tracker.blend;
+}
+
+static vector3 GetTrackerPosition(const std::array<vector3, JT_COUNT>& joints, const TrackerDefinition& tracker) {
+    const vector3& first = joints[tracker.first];
+    const vector3& second = joints[tracker.second];
+    return first + (second - first) * tracker.blend;
+}
+
+/**
+ * Get the position of a device out of its pose
+ */
+static vector3 GetDevicePosition(const vr::TrackedDevicePose_t& device) {
+    const auto& matrix = device.mDeviceToAbsoluteTracking.m;
+    return vector3(matrix[0][3], matrix[1][3], matrix[2][3]);
+}
+
+void PmfbtDriver::FindHands() {
+    hands[0] = vr::k_unTrackedDeviceIndexInvalid;
+    hands[1] = vr::k_unTrackedDeviceIndexInvalid;
+
+    for (vr::TrackedDeviceIndex_t i = 0; i < vr::k_unMaxTrackedDeviceCount; i++) {
+        auto props = vr::VRProperties()->TrackedDeviceToPropertyContainer(i);
+        if (props == vr::k_ulInvalidPropertyContainer
+                || vr::VRProperties()->GetInt32Property(props, vr::Prop_DeviceClass_Int32) != vr::TrackedDeviceClass_Controller) {
+            continue;
+        }
+
+        switch (vr::VRProperties()->GetInt32Property(props, vr::Prop_ControllerRoleHint_Int32)) {
+            case vr::TrackedControllerRole_RightHand: hands[0] = i; break;
+            case vr::TrackedControllerRole_LeftHand: hands[1] = i; break;
+            default: break;
+        }
+    }
+}
+
+void PmfbtDriver::GetAnchors(float age, BodyAnchors& anchors) {
+    vr::TrackedDevicePose_t devices[vr::k_unMaxTrackedDeviceCount] {};
+    vr::VRServerDriverHost()->GetRawTrackedDevicePoses(-age, devices, vr::k_unMaxTrackedDeviceCount);
+
+    const auto& hmd = devices[vr::k_unTrackedDeviceIndex_Hmd];
+    anchors.hmdValid = hmd.bPoseIsValid;
+    anchors.hmd = GetDevicePosition(hmd);
+
+    for (int side = 0; side < 2; side++) {
+        vr::TrackedDeviceIndex_t index = hands[side];
+        anchors.handValid[side] = index < vr::k_unMaxTrackedDeviceCount && devices[index].bPoseIsValid;
+        if (anchors.handValid[side]) {
+            anchors.hands[side] = GetDevicePosition(devices[index]);
+        }
+    }
+}
+
+void PmfbtDriver::UpdateCalibration(const PoseFeedFrame& frame, const BodyAnchors& anchors) {
+    // the first person is the one wearing the HMD
+    const auto& pose = frame.persons[0];
+    if (!pose.active || pose.confidences[JT_HEAD] < MIN_HEAD_CONFIDENCE || !anchors.hmdValid) {
+        return;
+    }
+
+    if (calibration.AddSample(GetJoint(pose, JT_HEAD), anchors.hmd)) {
+        calibration.Solve();
+    }
+
+    // keep it for the next time, without writing to the disk all the time
+    // and never on this thread
+    int64_t now = GetMicroseconds();
+    if (calibration.HasChanged() && now - lastCalibrationSave > CALIBRATION_SAVE_INTERVAL && !saving.exchange(true)) {
+        savingTransform = calibration.GetTransform();
+        calibration.MarkSaved();
+        saveTasks->Submit({ SaveCalibration, this, now });
+        lastCalibrationSave = now;
+    }
+}
+
+void PmfbtDriver::SaveCalibration(void* context) {
+    auto* driver = static_cast<PmfbtDriver*>(context);
+    PlayspaceCalibration::Save(driver->calibrationPath, driver->savingTransform);
+    driver->saving = false;
+}
+
+void PmfbtDriver::UpdateSolver(const PoseFeedFrame& frame, const BodyAnchors& anchors) {
+    const auto& pose = frame.persons[0];
+    if (!calibration.IsCalibrated() || !pose.active) {
+        solver.Reset();
+        return;
+    }
+
+    std::array<vector3, JT_COUNT> joints;
+    std::array<float, JT_COUNT> confidences;
+    for (int i = 0; i < JT_COUNT; i++) {
+        joints[i] = calibration.Apply(GetJoint(pose, static_cast<JointType>(i)));
+        confidences[i] = pose.confidences[i];
+    }
+    solver.SetObservation(frame.captureTime, joints, confidences, anchors);
+}
+
+void PmfbtDriver::SolveUser() {
+    auto& person = Persons[0];
+    if (!person.Added || !solver.HasObservation()) {
+        return;
+    }
+
+    BodyAnchors anchors;
+    GetAnchors(0.0f, anchors);
+
+    std::array<vector3, JT_COUNT> joints;
+    solver.Solve(anchors, joints);
+
+    {
+        std::lock_guard<std::mutex> guard{this->poseMutex};
+        for (int i = 0; i < TRACKER_COUNT; i++) {
+            if (!fused[i]) {
+                SetTrackerPose(0, i, PmfbtTracker::MakePose(GetTrackerPosition(joints, TRACKERS[i])));
+            }
+        }
+    }
+
+    SubmitPoses();
+}
+
+void PmfbtDriver::OnImuSamples(void* context, int tracker, const ImuSample* samples, int count) {
+    static_cast<PmfbtDriver*>(context)->ApplyImu(tracker, samples, count);
+}
+
+void PmfbtDriver::ApplyImu(int tracker, const ImuSample* samples, int count) {
+    // only the user wears phones, and only on the trackers we have
+    if (tracker >= TRACKER_COUNT || !Persons[0].Added) {
+        return;
+    }
+
+    auto& target = Persons[0].Trackers[tracker];
+    vr::DriverPose_t pose;
+    {
+        // the filter stays locked until the pose is set, so a reset can not be
+        // followed by a pose from before it
+        std::lock_guard<std::mutex> guard{this->imuMutex};
+        auto& filter = imuFilters[tracker];
+        for (int i = 0; i < count; i++) {
+            filter.Predict(samples[i]);
+        }
+
+        // until the camera corrects it the IMU alone drifts away in no time
+        int64_t now = GetMicroseconds();
+        if (!filter.IsTracking(now)) {
+            return;
+        }
+
+        ImuState state;
+        filter.GetState(state);
+
+        pose = PmfbtTracker::MakePose(state, now);
+        std::lock_guard<std::mutex> poseGuard{this->poseMutex};
+        target.SetPose(pose);
+    }
+    target.SubmitPose(pose);
+}
+
+void PmfbtDriver::UpdateImu(const PoseFeedFrame& frame) {
+    const auto& pose = frame.persons[0];
+    bool visible = calibration.IsCalibrated() && pose.active;
+
+    int64_t now = GetMicroseconds();
+    std::lock_guard<std::mutex> guard{this->imuMutex};
+    for (int i = 0; i < TRACKER_COUNT; i++) {
+        if (visible) {
+            imuFilters[i].Correct(frame.captureTime, calibration.Apply(GetTrackerPosition(pose, TRACKERS[i])));
+        }
+        fused[i] = imuFilters[i].IsTracking(now);
+    }
+}
+
+void PmfbtDriver::ApplyFrame(const PoseFeedFrame& frame) {
+    // where the devices were when the frame was captured
+    float age = std::clamp(static_cast<float>(GetMicroseconds() - frame.captureTime) / 1000000.0f, 0.0f, MAX_FRAME_AGE);
+    BodyAnchors anchors;
+    GetAnchors(age, anchors);
+
+    UpdateCalibration(frame, anchors);
+    UpdateSolver(frame, anchors);
+    UpdateImu(frame);
+
+    // the poses are meaningless in the play space until we are calibrated
+    bool calibrated = calibration.IsCalibrated();
+
+    // let the server know about anyone who just showed up, this must be done
+    // without the lock since the server may ask for their pose right away
+    for (int i = 0; i < MAX_PERSONS; i++) {
+        if (calibrated && frame.persons[i].active && !Persons[i].Added) {
+            AddPerson(i);
+        }
+    }
+
+    // update all the trackers in one go
+    {
+        std::lock_guard<std::mutex> guard{this->poseMutex};
+        for (int i = 0; i < MAX_PERSONS; i++) {
+            const auto& pose = frame.persons[i];
+            auto& person = Persons[i];
+            if (!person.Added) {
+                continue;
+            }
+
+            // the solver moves the user on every frame of the server
+            if (i == 0 && solver.HasObservation()) {
+                continue;
+            }
+
+            for (int j = 0; j < TRACKER_COUNT; j++) {
+                // the IMU moves it, and it was corrected with this frame already
+                if (i == 0 && fused[j]) {
+                    continue;
+                }
+
+                if (calibrated && pose.active) {
+                    vector3 position = calibration.Apply(GetTrackerPosition(pose, TRACKERS[j]));
+                    SetTrackerPose(i, j, PmfbtTracker::MakePose(position));
+                } else {
+                    SetTrackerPose(i, j, PmfbtTracker::MakeOutOfRangePose());
+                }
+            }
+        }
+    }
+
+    SubmitPoses();
+}
+
+void PmfbtDriver::LoseTracking() {
+    vr::DriverPose_t outOfRange = PmfbtTracker::MakeOutOfRangePose();
+    solver.Reset();
+
+    {
+        std::lock_guard<std::mutex> guard{this->imuMutex};
+        for (auto& filter : imuFilters) {
+            filter.Reset();
+        }
+        fused.fill(false);
+    }
+
+    {
+        std::lock_guard<std::mutex> guard{this->poseMutex};
+        for (int i = 0; i < MAX_PERSONS; i++) {
+            for (int j = 0; j < TRACKER_COUNT; j++) {
+                SetTrackerPose(i, j, outOfRange);
+            }
+        }
+    }
+
+    SubmitPoses();
+}
+
+void PmfbtDriver::SetTrackerPose(int person, int tracker, const vr::DriverPose_t& pose) {
+    Persons[person].Trackers[tracker].SetPose(pose);
+    pendingPoses[person][tracker] = pose;
+    pending[person][tracker] = true;
+}
+
+void PmfbtDriver::SubmitPoses() {
+    for (int i = 0; i < MAX_PERSONS; i++) {
+        auto& person = Persons[i];
+        for (int j = 0; j < TRACKER_COUNT; j++) {
+            if (pending[i][j] && person.Added) {
+                person.Trackers[j].SubmitPose(pendingPoses[i][j]);
+            }
+            pending[i][j] = false;
+        }
+    }
+}
+
+vr::EVRInitError PmfbtDriver::Init(vr::IVRDriverContext* driver_context) {
+    VR_INIT_SERVER_DRIVER_CONTEXT(driver_context);
+
+    // the first person always exists, the rest are added once they show up
+    AddPerson(0);
+
+    // the service may not be running yet, that is fine, it
+    // will find the channel once it starts
+    poses.Open();
+
+    // start from the last calibration, it gets refined as the user moves
+    calibrationPath = PlayspaceCalibration::GetDefaultPath();
+    calibration.Load(calibrationPath);
+    saveTasks = std::make_unique<TaskPool>(1, nullptr);
+
+    // the phones are optional, without them the trackers follow the camera alone
+    imu.Open(IMU_DEFAULT_PORT, OnImuSamples, this);
+
+    return vr::VRInitError_None;
+}
+
+void PmfbtDriver::Cleanup() {
+    imu.Close();
+
+    // a save that was still queued is lost with the pool, so write it here
+    saveTasks.reset();
+    if (calibration.HasChanged() || saving) {
+        calibration.Save(calibrationPath);
+        saving = false;
+    }
+
+    VR_CLEANUP_SERVER_DRIVER_CONTEXT();
+}
+
+const char* const* PmfbtDriver::GetInterfaceVersions() {
+    return vr::k_InterfaceVersions;
+}
+
+void PmfbtDriver::RunFrame() {
+    int64_t now = GetMicroseconds();
+    if (now - lastHandLookup > HAND_LOOKUP_INTERVAL) {
+        FindHands();
+        lastHandLookup = now;
+    }
+
+    // take the newest poses from the tracking service
+    if (poses.IsOpen() || poses.Open()) {
+        PoseFeedFrame frame;
+        if (poses.ReadLatest(frame)) {
+            ApplyFrame(frame);
+            lastFrameTime = now;
+            receiving = true;
+        } else if (receiving && now - lastFrameTime > SERVICE_TIMEOUT) {
+            LoseTracking();
+            receiving = false;
+        }
+    }
+
+    // the user follows the HMD on every frame, not just the ones with a new pose
+    SolveUser();
+
+    vr::VREvent_t event{};
+    while (vr::VRServerDriverHost()->PollNextEvent(&event, sizeof(event))) {
+        // TODO: handle the event
+    }
+}
+
+bool PmfbtDriver::ShouldBlockStandbyMode() {
+    return false;
+}
+
+void PmfbtDriver::EnterStandby() {
+    // TODO: pause the tracking
+}
+
+void PmfbtDriver::LeaveStandby() {
+    // TODO: resume the tracking
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+PmfbtDriver& GetDriverInstance() {
+    static PmfbtDriver instance;
+    return instance;
+}
+
+extern "C" void* HmdDriverFactory(const char* interface_name, int* return_code) {
+    if (std::string_view(interface_name) == vr::IServerTrackedDeviceProvider_Version) {
+        return &GetDriverInstance();
+    } else {
+        return nullptr;
+    }
 }
\ No newline at end of file
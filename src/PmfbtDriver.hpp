@@ -1,30 +1,213 @@
-#pragma once
-
-#include <string_view>
-#include <array>
-
-#include <openvr_driver.h>
-
-#include "PmfbtTracker.hpp"
-
-class PmfbtDriver final : public vr::IServerTrackedDeviceProvider {
-public:
-    PmfbtTracker RightLegTracker;
-    PmfbtTracker LeftLegTracker;
-    PmfbtTracker HipTracker;
-
-public:
-    vr::EVRInitError Init(vr::IVRDriverContext* driver_context);
-    void Cleanup();
-    const char* const* GetInterfaceVersions();
-    void RunFrame();
-    bool ShouldBlockStandbyMode();
-    void EnterStandby();
-    void LeaveStandby();
-};
-
-/**
- * Get the global instance of the driver so we can
- * access it from anywhere
- */
-PmfbtDriver& GetDriverInstance();
+#pragma once
+
+#include <string_view>
+#include <cstdint>
+#include <string>
+#include <atomic>
+#include <memory>
+#include <array>
+#include <mutex>
+
+#include <openvr_driver.h>
+
+#include <calibration/PlayspaceCalibration.hpp>
+#include <tracking/BodySolver.hpp>
+#include <tracking/ImuFilter.hpp>
+#include <capture/ImuSource.hpp>
+#include <ipc/PoseChannel.hpp>
+#include <util/TaskPool.hpp>
+#include <pose/Joints.hpp>
+
+#include "PmfbtTracker.hpp"
+#include "Trackers.hpp"
+#include "Config.hpp"
+
+/**
+ * The virtual trackers of a single person
+ */
+struct PersonTrackers {
+    /**
+     * The trackers, in the order of the TRACKERS table
+     */
+    std::array<PmfbtTracker, TRACKER_COUNT> Trackers;
+
+    /**
+     * Were the trackers added to the server already, they
+     * are added once the person is first seen
+     */
+    bool Added = false;
+};
+
+class PmfbtDriver final : public vr::IServerTrackedDeviceProvider {
+public:
+    /**
+     * The trackers of each of the people we track, the index
+     * is the slot of the person in the tracking service
+     */
+    std::array<PersonTrackers, MAX_PERSONS> Persons;
+
+private:
+    /**
+     * The poses published by the tracking service, which runs the
+     * camera pipeline in its own process
+     */
+    PoseReader poses;
+
+    /**
+     * Moves the poses from the camera into the play space, it is found from
+     * the HMD poses as the user moves around, and kept on disk
+     */
+    PlayspaceCalibration calibration;
+    std::string calibrationPath;
+    int64_t lastCalibrationSave = 0;
+
+    /**
+     * Writes the calibration to the disk on a worker of its own, so the frames
+     * of the server never wait for the disk. The transform is copied for it, and
+     * a new save waits until the last one is done.
+     */
+    std::unique_ptr<TaskPool> saveTasks;
+    matrix4 savingTransform;
+    std::atomic<bool> saving { false };
+
+    /**
+     * Fills in the first person, the one wearing the HMD, between the frames of the
+     * camera from the HMD and the controllers
+     */
+    BodySolver solver;
+
+    /**
+     * The devices of the controllers, right then left, they are looked up again
+     * every now and then since they come and go
+     */
+    vr::TrackedDeviceIndex_t hands[2] = { vr::k_unTrackedDeviceIndexInvalid, vr::k_unTrackedDeviceIndexInvalid };
+    int64_t lastHandLookup = 0;
+
+    /**
+     * The phones strapped to the trackers of the first person, each tracker with
+     * a phone is moved by its IMU between the camera frames
+     */
+    ImuSource imu;
+    std::array<ImuFilter, TRACKER_COUNT> imuFilters;
+
+    /**
+     * Which trackers of the first person follow their IMU, they are left alone
+     * by the camera frames and by the solver
+     */
+    std::array<bool, TRACKER_COUNT> fused = {};
+
+    /**
+     * Protects the filters, the samples arrive on the thread of the IMU source, it
+     * is never taken while the pose mutex is held
+     */
+    std::mutex imuMutex;
+
+    /**
+     * Protects the poses of all the trackers, a frame takes it
+     * once to update all of them
+     */
+    std::mutex poseMutex;
+
+    /**
+     * The poses set in the last pass over the trackers, copied out while the pose
+     * mutex is held so they can be submitted without taking it again
+     */
+    std::array<std::array<vr::DriverPose_t, TRACKER_COUNT>, MAX_PERSONS> pendingPoses = {};
+    std::array<std::array<bool, TRACKER_COUNT>, MAX_PERSONS> pending = {};
+
+    /**
+     * When we last got a frame from the service, and if the trackers
+     * are still live, if the service stops we mark them out of range
+     */
+    int64_t lastFrameTime = 0;
+    bool receiving = false;
+
+    /**
+     * Expose the trackers of the person to the server
+     */
+    void AddPerson(int index);
+
+    /**
+     * Find which devices are the controllers
+     */
+    void FindHands();
+
+    /**
+     * Get where the HMD and the controllers are
+     *
+     * @param age       [IN]    How many seconds ago
+     * @param anchors   [OUT]   Their positions
+     */
+    void GetAnchors(float age, BodyAnchors& anchors);
+
+    /**
+     * Write the copy of the calibration to the disk, as a task
+     */
+    static void SaveCalibration(void* context);
+
+    /**
+     * Match the head of the user with the HMD to improve the calibration
+     */
+    void UpdateCalibration(const PoseFeedFrame& frame, const BodyAnchors& anchors);
+
+    /**
+     * Give the first person to the solver
+     */
+    void UpdateSolver(const PoseFeedFrame& frame, const BodyAnchors& anchors);
+
+    /**
+     * Move the trackers of the first person to where the HMD is now, this
+     * is done on every frame of the server
+     */
+    void SolveUser();
+
+    /**
+     * Move the tracker with the samples of its IMU and publish it, on the thread
+     * of the IMU source
+     */
+    static void OnImuSamples(void* context, int tracker, const ImuSample* samples, int count);
+    void ApplyImu(int tracker, const ImuSample* samples, int count);
+
+    /**
+     * Correct the filters with where the camera saw the first person
+     */
+    void UpdateImu(const PoseFeedFrame& frame);
+
+    /**
+     * Update the trackers with a new frame from the service
+     */
+    void ApplyFrame(const PoseFeedFrame& frame);
+
+    /**
+     * Mark all the trackers out of range
+     */
+    void LoseTracking();
+
+    /**
+     * Set the pose of a tracker and keep it to be submitted, the pose mutex must be held
+     */
+    void SetTrackerPose(int person, int tracker, const vr::DriverPose_t& pose);
+
+    /**
+     * Tell the server about the poses set since the last time, without the pose mutex
+     */
+    void SubmitPoses();
+
+public:
+    PmfbtDriver();
+
+public:
+    vr::EVRInitError Init(vr::IVRDriverContext* driver_context);
+    void Cleanup();
+    const char* const* GetInterfaceVersions();
+    void RunFrame();
+    bool ShouldBlockStandbyMode();
+    void EnterStandby();
+    void LeaveStandby();
+};
+
+/**
+ * Get the global instance of the driver so we can
+ * access it from anywhere
+ */
+PmfbtDriver& GetDriverInstance();
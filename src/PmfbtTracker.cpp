@@ -1,95 +1,128 @@
-#include "PmfbtTracker.hpp"
-
-PmfbtTracker::PmfbtTracker()
-    : objectId(vr::k_unTrackedDeviceIndexInvalid)
-    , lastPose()
-    , mutex()
-{
-    // setup an invalid pose
-    this->lastPose.poseIsValid = false;
-    this->lastPose.result = vr::TrackingResult_Uninitialized;
-}
-
-void PmfbtTracker::UpdatePoint(const vector3& new_point) {
-    vr::DriverPose_t newPose{};
-
-    // setup generic information
-    newPose.deviceIsConnected = true;
-    newPose.poseIsValid = true;
-    newPose.result = vr::TrackingResult_Running_OK;
-
-
-    // actually set the pose
-    {
-        std::lock_guard<std::mutex> guard{this->mutex};
-        this->lastPose = newPose;
-    }
-
-    // notify the server we got a new pose
-    vr::VRServerDriverHost()->TrackedDevicePoseUpdated(this->objectId, this->lastPose, sizeof(this->lastPose));
-}
-
-void PmfbtTracker::UpdateOutOfRange() {
-    vr::DriverPose_t newPose{};
-
-    // setup generic information
-    newPose.deviceIsConnected = true;
-    newPose.poseIsValid = true;
-    newPose.result = vr::TrackingResult_Running_OutOfRange;
-
-    // actually set the pose
-    {
-        std::lock_guard<std::mutex> guard{this->mutex};
-        this->lastPose = newPose;
-    }
-
-    // notify the server we got out-of-range
-    vr::VRServerDriverHost()->TrackedDevicePoseUpdated(this->objectId, this->lastPose, sizeof(this->lastPose));
-}
-
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-// The OpenVR interface
-////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-/**
- * Will setup the device's properties
- */
-vr::EVRInitError PmfbtTracker::Activate(uint32_t unObjectId) {
-    this->objectId = unObjectId;
-    auto props = vr::VRProperties()->TrackedDeviceToPropertyContainer(this->objectId);
-
-    // opt-out of hand selection
-    vr::VRProperties()->SetInt32Property(props, vr::Prop_ControllerRoleHint_Int32, vr::TrackedControllerRole_OptOut);
-
-    return vr::VRInitError_None;
-}
-
-void PmfbtTracker::Deactivate() {
-    this->objectId = vr::k_unTrackedDeviceIndexInvalid;
-}
-
-void* PmfbtTracker::GetComponent(const char *pchComponentNameAndVersion) {
-    return nullptr;
-}
-
-void PmfbtTracker::DebugRequest(const char *pchRequest, char *pchResponseBuffer, uint32_t unResponseBufferSize) {
-
-}
-
-/**
- * Just return the last valid pose, makes sure to
- * take the mutex so we will not race with the tracking
- * thread.
- */
-vr::DriverPose_t PmfbtTracker::GetPose() {
-    std::lock_guard<std::mutex> guard{this->mutex};
-    return this->lastPose;
-}
-
-/**
- * We don't have standby mode on a per-device
- * level
- */
-void PmfbtTracker::EnterStandby() {
-
-}
+#include "PmfbtTracker.hpp"
+
+PmfbtTracker::PmfbtTracker()
+    : objectId(vr::k_unTrackedDeviceIndexInvalid)
+    , lastPose()
+    , mutex(nullptr)
+{
+    // setup an invalid pose
+    this->lastPose.poseIsValid = false;
+    this->lastPose.result = vr::TrackingResult_Uninitialized;
+}
+
+void PmfbtTracker::SetMutex(std::mutex* poseMutex) {
+    this->mutex = poseMutex;
+}
+
+/**
+ * The generic information of every pose we report
+ */
+static vr::DriverPose_t MakeBasePose() {
+    vr::DriverPose_t pose{};
+    pose.deviceIsConnected = true;
+    pose.poseIsValid = true;
+
+    // no rotation unless the tracker has an IMU, the position is all we have
+    pose.qRotation.w = 1;
+    pose.qWorldFromDriverRotation.w = 1;
+    pose.qDriverFromHeadRotation.w = 1;
+
+    return pose;
+}
+
+vr::DriverPose_t PmfbtTracker::MakePose(const vector3& point) {
+    vr::DriverPose_t pose = MakeBasePose();
+    pose.result = vr::TrackingResult_Running_OK;
+
+    pose.vecPosition[0] = point.x;
+    pose.vecPosition[1] = point.y;
+    pose.vecPosition[2] = point.z;
+
+    return pose;
+}
+
+vr::DriverPose_t PmfbtTracker::MakePose(const ImuState& state, int64_t now) {
+    vr::DriverPose_t pose = MakePose(state.position);
+
+    pose.qRotation.w = state.rotation[0];
+    pose.qRotation.x = state.rotation[1];
+    pose.qRotation.y = state.rotation[2];
+    pose.qRotation.z = state.rotation[3];
+
+    pose.vecVelocity[0] = state.velocity.x;
+    pose.vecVelocity[1] = state.velocity.y;
+    pose.vecVelocity[2] = state.velocity.z;
+
+    pose.vecAngularVelocity[0] = state.angularVelocity.x;
+    pose.vecAngularVelocity[1] = state.angularVelocity.y;
+    pose.vecAngularVelocity[2] = state.angularVelocity.z;
+
+    // the server moves the pose forward with the velocities to the present
+    pose.poseTimeOffset = static_cast<double>(state.time - now) / 1000000.0;
+
+    return pose;
+}
+
+vr::DriverPose_t PmfbtTracker::MakeOutOfRangePose() {
+    vr::DriverPose_t pose = MakeBasePose();
+    pose.result = vr::TrackingResult_Running_OutOfRange;
+    return pose;
+}
+
+void PmfbtTracker::SetPose(const vr::DriverPose_t& pose) {
+    this->lastPose = pose;
+}
+
+void PmfbtTracker::SubmitPose(const vr::DriverPose_t& pose) {
+    // notify the server we got a new pose, unless it does not know about us yet
+    if (this->objectId != vr::k_unTrackedDeviceIndexInvalid) {
+        vr::VRServerDriverHost()->TrackedDevicePoseUpdated(this->objectId, pose, sizeof(pose));
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// The OpenVR interface
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Will setup the device's properties
+ */
+vr::EVRInitError PmfbtTracker::Activate(uint32_t unObjectId) {
+    this->objectId = unObjectId;
+    auto props = vr::VRProperties()->TrackedDeviceToPropertyContainer(this->objectId);
+
+    // opt-out of hand selection
+    vr::VRProperties()->SetInt32Property(props, vr::Prop_ControllerRoleHint_Int32, vr::TrackedControllerRole_OptOut);
+
+    return vr::VRInitError_None;
+}
+
+void PmfbtTracker::Deactivate() {
+    this->objectId = vr::k_unTrackedDeviceIndexInvalid;
+}
+
+void* PmfbtTracker::GetComponent(const char *pchComponentNameAndVersion) {
+    return nullptr;
+}
+
+void PmfbtTracker::DebugRequest(const char *pchRequest, char *pchResponseBuffer, uint32_t unResponseBufferSize) {
+
+}
+
+/**
+ * Just return the last valid pose, makes sure to
+ * take the mutex so we will not race with the driver
+ * updating the poses.
+ */
+vr::DriverPose_t PmfbtTracker::GetPose() {
+    std::lock_guard<std::mutex> guard{*this->mutex};
+    return this->lastPose;
+}
+
+/**
+ * We don't have standby mode on a per-device
+ * level
+ */
+void PmfbtTracker::EnterStandby() {
+
+}
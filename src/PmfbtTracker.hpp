@@ -1,56 +1,80 @@
-#pragma once
-
-#include <openvr_driver.h>
-
-#include <cstdint>
-#include <mutex>
-
-#include <math/vector3.hpp>
-
-class PmfbtTracker : public vr::ITrackedDeviceServerDriver {
-private:
-    /**
-     * The OpenVR object ID
-     */
-    uint32_t objectId;
-
-    /**
-     * The last pose that we got, this is returned
-     * from the GetPose function
-     */
-    vr::DriverPose_t lastPose;
-
-    /**
-     * Mutex to protect the lastPose (this is needed
-     * when we make the lastPose be updated from a
-     * different thread)
-     */
-    std::mutex mutex;
-
-public:
-
-    PmfbtTracker();
-
-    /**
-     * This function will cause the tracker to update it's
-     * internal pose to point to the given point.
-     */
-    void UpdatePoint(const vector3& new_point);
-
-    /**
-     * Update the device that the user is out-of-range (aka, we
-     * can not find it)
-     */
-    void UpdateOutOfRange();
-
-    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-    // The OpenVR interface
-    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-
-    vr::EVRInitError Activate(uint32_t unObjectId) final;
-    void Deactivate() final;
-    void *GetComponent( const char *pchComponentNameAndVersion ) final;
-    void DebugRequest( const char *pchRequest, char *pchResponseBuffer, uint32_t unResponseBufferSize ) final;
-    vr::DriverPose_t GetPose() final;
-    void EnterStandby() final;
-};
+#pragma once
+
+#include <openvr_driver.h>
+
+#include <cstdint>
+#include <mutex>
+
+#include <tracking/ImuFilter.hpp>
+#include <math/vector3.hpp>
+
+class PmfbtTracker : public vr::ITrackedDeviceServerDriver {
+private:
+    /**
+     * The OpenVR object ID
+     */
+    uint32_t objectId;
+
+    /**
+     * The last pose that we got, this is returned
+     * from the GetPose function
+     */
+    vr::DriverPose_t lastPose;
+
+    /**
+     * Protects the lastPose, it is shared by all the trackers so a
+     * frame can update all of them while taking it once
+     */
+    std::mutex* mutex;
+
+public:
+
+    PmfbtTracker();
+
+    /**
+     * Set the mutex that protects the pose, must be called before
+     * the tracker is given to the server
+     */
+    void SetMutex(std::mutex* poseMutex);
+
+    /**
+     * Make a pose of a tracker at the given point
+     */
+    static vr::DriverPose_t MakePose(const vector3& point);
+
+    /**
+     * Make a pose of a tracker with an IMU on it, with its rotation and velocity
+     *
+     * @param state [IN] The state of the filter of the tracker
+     * @param now   [IN] The current time, the pose is moved forward from the last sample to it
+     */
+    static vr::DriverPose_t MakePose(const ImuState& state, int64_t now);
+
+    /**
+     * Make a pose of a tracker the user is out-of-range of (aka, we
+     * can not find it)
+     */
+    static vr::DriverPose_t MakeOutOfRangePose();
+
+    /**
+     * Set the pose of the tracker, the mutex must be held
+     */
+    void SetPose(const vr::DriverPose_t& pose);
+
+    /**
+     * Tell the server about a pose, the one given to SetPose copied out while the
+     * mutex was held, so the mutex is not taken again for every tracker
+     */
+    void SubmitPose(const vr::DriverPose_t& pose);
+
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+    // The OpenVR interface
+    ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    vr::EVRInitError Activate(uint32_t unObjectId) final;
+    void Deactivate() final;
+    void *GetComponent( const char *pchComponentNameAndVersion ) final;
+    void DebugRequest( const char *pchRequest, char *pchResponseBuffer, uint32_t unResponseBufferSize ) final;
+    vr::DriverPose_t GetPose() final;
+    void EnterStandby() final;
+};
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <array>
+
+#include <pose/Joints.hpp>
+
+/**
+ * A virtual tracker, placed on a joint or somewhere on the line between
+ * two joints
+ */
+struct TrackerDefinition {
+    /**
+     * The name the tracker is exposed to SteamVR with, for the first person
+     */
+    const char* name;
+
+    /**
+     * The tracker is at first + (second - first) * blend, a tracker on a
+     * single joint uses the same joint twice
+     */
+    JointType first;
+    JointType second;
+    float blend;
+};
+
+/**
+ * All the virtual trackers of a person, the first three keep the names of
+ * the original trackers so existing SteamVR bindings keep working
+ */
+constexpr std::array<TrackerDefinition, 8> TRACKERS = {{
+    { "PMFBT Left Leg",     JT_LEFT_ANKLE,      JT_LEFT_ANKLE,  0.0f },
+    { "PMFBT Right Leg",    JT_RIGHT_ANKLE,     JT_RIGHT_ANKLE, 0.0f },
+    { "PMFBT Hip",          JT_LEFT_HIP,        JT_RIGHT_HIP,   0.5f },
+    { "PMFBT Left Knee",    JT_LEFT_KNEE,       JT_LEFT_KNEE,   0.0f },
+    { "PMFBT Right Knee",   JT_RIGHT_KNEE,      JT_RIGHT_KNEE,  0.0f },
+    { "PMFBT Chest",        JT_COLLARBONE,      JT_TAILBONE,    0.25f },
+    { "PMFBT Left Elbow",   JT_LEFT_ELBOW,      JT_LEFT_ELBOW,  0.0f },
+    { "PMFBT Right Elbow",  JT_RIGHT_ELBOW,     JT_RIGHT_ELBOW, 0.0f },
+}};
+
+constexpr int TRACKER_COUNT = static_cast<int>(TRACKERS.size());
@@ -0,0 +1,114 @@
+#include <filesystem>
+#include <fstream>
+
+#include <pose/Skeleton.hpp>
+
+#include "CameraIntrinsics.hpp"
+#include "PlayspaceCalibration.hpp"
+
+/**
+ * The first line of the intrinsics file
+ */
+constexpr const char* FILE_HEADER = "pmfbt-intrinsics 1";
+
+/**
+ * The distortion is inverted by fixed point iteration, a wide lens
+ * needs a few more than the 5 OpenCV does by default
+ */
+constexpr int UNDISTORT_ITERATIONS = 8;
+
+CameraIntrinsics::CameraIntrinsics()
+    : fx(FOCAL_LENGTH)
+    , fy(FOCAL_LENGTH)
+    , cx(0.5f)
+    , cy(0.5f)
+    , distortion()
+    , valid(false)
+{
+}
+
+void CameraIntrinsics::Set(const std::array<float, 2>& focal, const std::array<float, 2>& center, const std::array<float, 5>& coefficients) {
+    this->fx = focal[0];
+    this->fy = focal[1];
+    this->cx = center[0];
+    this->cy = center[1];
+    this->distortion = coefficients;
+    this->valid = this->fx > 0.0f && this->fy > 0.0f;
+}
+
+bool CameraIntrinsics::IsValid() const {
+    return this->valid;
+}
+
+void CameraIntrinsics::Undistort(float& x, float& y) const {
+    const float k1 = this->distortion[0];
+    const float k2 = this->distortion[1];
+    const float p1 = this->distortion[2];
+    const float p2 = this->distortion[3];
+    const float k3 = this->distortion[4];
+
+    // the distorted point on the plane at a distance of one
+    float distortedX = (x - this->cx) / this->fx;
+    float distortedY = (y - this->cy) / this->fy;
+
+    // find the point that distorts to it
+    float undistortedX = distortedX;
+    float undistortedY = distortedY;
+    for (int i = 0; i < UNDISTORT_ITERATIONS; i++) {
+        float r2 = undistortedX * undistortedX + undistortedY * undistortedY;
+        float radial = 1.0f / (1.0f + ((k3 * r2 + k2) * r2 + k1) * r2);
+        float tangentialX = 2.0f * p1 * undistortedX * undistortedY + p2 * (r2 + 2.0f * undistortedX * undistortedX);
+        float tangentialY = p1 * (r2 + 2.0f * undistortedY * undistortedY) + 2.0f * p2 * undistortedX * undistortedY;
+        undistortedX = (distortedX - tangentialX) * radial;
+        undistortedY = (distortedY - tangentialY) * radial;
+    }
+
+    // and project it with the ideal camera
+    x = 0.5f + FOCAL_LENGTH * undistortedX;
+    y = 0.5f + FOCAL_LENGTH * undistortedY;
+}
+
+bool CameraIntrinsics::Load(const std::string& path) {
+    std::ifstream in(path);
+    std::string header;
+    if (!std::getline(in, header) || header != FILE_HEADER) {
+        return false;
+    }
+
+    std::array<float, 2> focal;
+    std::array<float, 2> center;
+    std::array<float, 5> coefficients;
+    if (!(in >> focal[0] >> focal[1] >> center[0] >> center[1])) {
+        return false;
+    }
+    for (float& coefficient : coefficients) {
+        if (!(in >> coefficient)) {
+            return false;
+        }
+    }
+
+    Set(focal, center, coefficients);
+    return this->valid;
+}
+
+bool CameraIntrinsics::Save(const std::string& path) const {
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+
+    out.precision(9);
+    out << FILE_HEADER << std::endl;
+    out << this->fx << " " << this->fy << " " << this->cx << " " << this->cy << std::endl;
+    out << this->distortion[0] << " " << this->distortion[1] << " " << this->distortion[2] << " "
+        << this->distortion[3] << " " << this->distortion[4] << std::endl;
+    return static_cast<bool>(out);
+}
+
+std::string CameraIntrinsics::GetDefaultPath(int camera) {
+    std::string name = camera < 0 ? "camera-phone.txt" : "camera-" + std::to_string(camera) + ".txt";
+    return (std::filesystem::path(PlayspaceCalibration::GetDefaultPath()).parent_path() / name).string();
+}
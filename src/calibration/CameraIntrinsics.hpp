@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <array>
+
+/**
+ * The intrinsics and the lens distortion of a camera, in the model of OpenCV
+ * (k1, k2, p1, p2, k3).
+ *
+ * The focal length and the principal point are kept relative to the width and
+ * height of the image, like the keypoints, so they hold for any resolution with
+ * the same aspect ratio, including the reduced size MJPEG decodes.
+ *
+ * Only the keypoints are undistorted, never the frame, which takes a couple of
+ * microseconds a person instead of a pass over every pixel.
+ */
+class CameraIntrinsics {
+private:
+    /**
+     * The focal length and the principal point, relative to the size of the image
+     */
+    float fx;
+    float fy;
+    float cx;
+    float cy;
+
+    /**
+     * The radial (k1, k2, k3) and tangential (p1, p2) distortion
+     */
+    std::array<float, 5> distortion;
+
+    bool valid;
+
+public:
+
+    CameraIntrinsics();
+
+    /**
+     * Set the intrinsics from a calibration
+     *
+     * @param focal         [IN] The focal length in x and y, relative to the width and height of the image
+     * @param center        [IN] The principal point, relative to the width and height of the image
+     * @param coefficients  [IN] k1, k2, p1, p2, k3
+     */
+    void Set(const std::array<float, 2>& focal, const std::array<float, 2>& center, const std::array<float, 5>& coefficients);
+
+    bool IsValid() const;
+
+    /**
+     * Move a keypoint to where an ideal camera with square pixels and a focal length
+     * of FOCAL_LENGTH would have seen it, which is what the reconstruction expects
+     *
+     * @param x [IN/OUT] The x of the keypoint, in normalized image coordinates
+     * @param y [IN/OUT] The y of the keypoint, in normalized image coordinates
+     */
+    void Undistort(float& x, float& y) const;
+
+    bool Load(const std::string& path);
+    bool Save(const std::string& path) const;
+
+    /**
+     * Where the intrinsics of a camera are kept, next to the play space calibration
+     *
+     * @param camera    [IN] The index of the local camera, or -1 for the phone on the network
+     */
+    static std::string GetDefaultPath(int camera);
+};
@@ -0,0 +1,108 @@
+#include <cmath>
+
+#include "CheckerboardCalibration.hpp"
+
+/**
+ * The fewest views we solve from, the distortion needs the board
+ * in most parts of the frame
+ */
+constexpr size_t MIN_VIEWS = 10;
+
+/**
+ * How far the outer corners of the board must move on average since the last
+ * view, relative to the width of the frame, for a new view to be taken
+ */
+constexpr float MIN_VIEW_CHANGE = 0.05f;
+
+CheckerboardCalibration::CheckerboardCalibration(int columns, int rows)
+    : boardSize(columns, rows)
+    , views()
+    , imageSize()
+    , gray()
+    , corners()
+{
+}
+
+/**
+ * Check that the board moved or turned enough since the last view, from its outer corners
+ */
+static bool IsNewView(const std::vector<cv::Point2f>& last, const std::vector<cv::Point2f>& current, cv::Size boardSize, cv::Size imageSize) {
+    const size_t outer[] = {
+        0,
+        static_cast<size_t>(boardSize.width - 1),
+        current.size() - boardSize.width,
+        current.size() - 1,
+    };
+
+    float moved = 0.0f;
+    for (size_t index : outer) {
+        moved += std::hypot(current[index].x - last[index].x, current[index].y - last[index].y);
+    }
+    return moved / 4.0f > MIN_VIEW_CHANGE * static_cast<float>(imageSize.width);
+}
+
+bool CheckerboardCalibration::AddFrame(const cv::Mat& frame) {
+    if (frame.channels() == 3) {
+        cv::cvtColor(frame, this->gray, cv::COLOR_BGR2GRAY);
+    } else {
+        this->gray = frame;
+    }
+
+    // the views of a different resolution don't mix, start over
+    if (!this->views.empty() && frame.size() != this->imageSize) {
+        this->views.clear();
+    }
+    this->imageSize = frame.size();
+
+    int flags = cv::CALIB_CB_ADAPTIVE_THRESH | cv::CALIB_CB_NORMALIZE_IMAGE | cv::CALIB_CB_FAST_CHECK;
+    if (!cv::findChessboardCorners(this->gray, this->boardSize, this->corners, flags)) {
+        return false;
+    }
+
+    if (!this->views.empty() && !IsNewView(this->views.back(), this->corners, this->boardSize, this->imageSize)) {
+        return false;
+    }
+
+    cv::cornerSubPix(this->gray, this->corners, cv::Size(5, 5), cv::Size(-1, -1),
+                     cv::TermCriteria(cv::TermCriteria::EPS + cv::TermCriteria::COUNT, 30, 0.01));
+    this->views.push_back(this->corners);
+    return true;
+}
+
+int CheckerboardCalibration::GetViewCount() const {
+    return static_cast<int>(this->views.size());
+}
+
+bool CheckerboardCalibration::Solve(CameraIntrinsics& intrinsics, double& error) const {
+    if (this->views.size() < MIN_VIEWS) {
+        return false;
+    }
+
+    // the board in squares, the size of a square doesn't matter for the intrinsics
+    std::vector<cv::Point3f> board;
+    for (int row = 0; row < this->boardSize.height; row++) {
+        for (int column = 0; column < this->boardSize.width; column++) {
+            board.emplace_back(static_cast<float>(column), static_cast<float>(row), 0.0f);
+        }
+    }
+    std::vector<std::vector<cv::Point3f>> boards(this->views.size(), board);
+
+    cv::Mat cameraMatrix;
+    cv::Mat coefficients;
+    std::vector<cv::Mat> rotations;
+    std::vector<cv::Mat> translations;
+    error = cv::calibrateCamera(boards, this->views, this->imageSize, cameraMatrix, coefficients, rotations, translations);
+
+    // keep it relative to the size of the frame, like the keypoints
+    auto width = static_cast<double>(this->imageSize.width);
+    auto height = static_cast<double>(this->imageSize.height);
+    const double* distortion = coefficients.ptr<double>();
+    intrinsics.Set(
+            { static_cast<float>(cameraMatrix.at<double>(0, 0) / width), static_cast<float>(cameraMatrix.at<double>(1, 1) / height) },
+            { static_cast<float>(cameraMatrix.at<double>(0, 2) / width), static_cast<float>(cameraMatrix.at<double>(1, 2) / height) },
+            {
+                static_cast<float>(distortion[0]), static_cast<float>(distortion[1]), static_cast<float>(distortion[2]),
+                static_cast<float>(distortion[3]), static_cast<float>(distortion[4])
+            });
+    return intrinsics.IsValid();
+}
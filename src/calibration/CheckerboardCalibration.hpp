@@ -0,0 +1,61 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+#include <vector>
+
+#include "CameraIntrinsics.hpp"
+
+/**
+ * Finds the intrinsics and the lens distortion of a camera from views of a
+ * checkerboard held in front of it, with the calibration of OpenCV.
+ *
+ * A view is only taken once the board moved or turned enough since the last
+ * one, so holding it still does not fill the views with the same pose. The
+ * board should be seen all over the frame, the corners most of all since that
+ * is where the distortion is, and at a few different angles.
+ */
+class CheckerboardCalibration {
+private:
+    /**
+     * The amount of inner corners of the board
+     */
+    cv::Size boardSize;
+
+    /**
+     * The corners found in every view, in pixels
+     */
+    std::vector<std::vector<cv::Point2f>> views;
+    cv::Size imageSize;
+
+    /**
+     * Temporaries for finding the corners
+     */
+    cv::Mat gray;
+    std::vector<cv::Point2f> corners;
+
+public:
+
+    /**
+     * @param columns   [IN] The inner corners along a row of the board
+     * @param rows      [IN] The inner corners along a column of the board
+     */
+    CheckerboardCalibration(int columns, int rows);
+
+    /**
+     * Look for the board in a frame
+     *
+     * @return True if the board was found and the view was taken
+     */
+    bool AddFrame(const cv::Mat& frame);
+
+    int GetViewCount() const;
+
+    /**
+     * Solve the intrinsics from the views so far
+     *
+     * @param intrinsics    [OUT] The intrinsics
+     * @param error         [OUT] The root mean square reprojection error, in pixels
+     */
+    bool Solve(CameraIntrinsics& intrinsics, double& error) const;
+};
@@ -0,0 +1,357 @@
+#include <filesystem>
+#include <fstream>
+#include <cstdlib>
+#include <cmath>
+
+#include "PlayspaceCalibration.hpp"
+
+/**
+ * How much of the weight of the older samples is kept with every new sample,
+ * the calibration effectively remembers the last thousand or so samples
+ */
+constexpr double FORGET = 0.999;
+
+/**
+ * How far the HMD has to move, in meters, before we take another sample
+ */
+constexpr float MIN_SAMPLE_DISTANCE = 0.05f;
+
+/**
+ * The total weight of the samples needed before solving
+ */
+constexpr double MIN_WEIGHT = 50.0;
+
+/**
+ * How spread out the HMD positions must be, in meters, along at least two axes,
+ * points along a single line leave the rotation around that line unknown
+ */
+constexpr double MIN_SPREAD = 0.15;
+
+/**
+ * The first line of the calibration file
+ */
+constexpr const char* FILE_HEADER = "pmfbt-calibration 1";
+
+/**
+ * A single NaN would poison the running sums for good, so anything that goes
+ * into them or comes out of them is checked first
+ */
+static bool IsFinite(const vector3& point) {
+    return std::isfinite(point.x) && std::isfinite(point.y) && std::isfinite(point.z);
+}
+
+static bool IsFinite(const matrix4& matrix) {
+    for (const auto& row : matrix.m) {
+        for (float value : row) {
+            if (!std::isfinite(value)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Find the eigenvalues and eigenvectors of a symmetric matrix with the
+ * Jacobi method, the matrix is destroyed. The eigenvectors are the columns.
+ */
+template <int N>
+static void JacobiEigen(double (&a)[N][N], double (&values)[N], double (&vectors)[N][N]) {
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j < N; j++) {
+            vectors[i][j] = i == j ? 1.0 : 0.0;
+        }
+    }
+
+    for (int sweep = 0; sweep < 50; sweep++) {
+        double off = 0.0;
+        for (int p = 0; p < N; p++) {
+            for (int q = p + 1; q < N; q++) {
+                off += a[p][q] * a[p][q];
+            }
+        }
+        if (off < 1e-24) {
+            break;
+        }
+
+        for (int p = 0; p < N; p++) {
+            for (int q = p + 1; q < N; q++) {
+                if (std::abs(a[p][q]) < 1e-30) {
+                    continue;
+                }
+
+                // the rotation that zeroes a[p][q]
+                double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+                double t = (theta >= 0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+                double c = 1.0 / std::sqrt(t * t + 1.0);
+                double s = t * c;
+
+                for (int k = 0; k < N; k++) {
+                    double kp = a[k][p];
+                    double kq = a[k][q];
+                    a[k][p] = c * kp - s * kq;
+                    a[k][q] = s * kp + c * kq;
+                }
+                for (int k = 0; k < N; k++) {
+                    double pk = a[p][k];
+                    double qk = a[q][k];
+                    a[p][k] = c * pk - s * qk;
+                    a[q][k] = s * pk + c * qk;
+                }
+                for (int k = 0; k < N; k++) {
+                    double kp = vectors[k][p];
+                    double kq = vectors[k][q];
+                    vectors[k][p] = c * kp - s * kq;
+                    vectors[k][q] = s * kp + c * kq;
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < N; i++) {
+        values[i] = a[i][i];
+    }
+}
+
+PlayspaceCalibration::PlayspaceCalibration()
+    : weight(0.0)
+    , sumCamera()
+    , sumPlayspace()
+    , sumCameraSquared(0.0)
+    , sumCross()
+    , sumPlayspaceOuter()
+    , lastSample()
+    , haveSample(false)
+    , transform(matrix4::identity())
+    , calibrated(false)
+    , changed(false)
+{
+}
+
+bool PlayspaceCalibration::AddSample(const vector3& camera, const vector3& playspace) {
+    if (!IsFinite(camera) || !IsFinite(playspace)) {
+        return false;
+    }
+    if (haveSample && lastSample.distance(playspace) < MIN_SAMPLE_DISTANCE) {
+        return false;
+    }
+    lastSample = playspace;
+    haveSample = true;
+
+    const double x[3] = { camera.x, camera.y, camera.z };
+    const double y[3] = { playspace.x, playspace.y, playspace.z };
+
+    // forget a bit of the old samples and add the new one
+    weight = weight * FORGET + 1.0;
+    sumCameraSquared = sumCameraSquared * FORGET + x[0] * x[0] + x[1] * x[1] + x[2] * x[2];
+    for (int i = 0; i < 3; i++) {
+        sumCamera[i] = sumCamera[i] * FORGET + x[i];
+        sumPlayspace[i] = sumPlayspace[i] * FORGET + y[i];
+        for (int j = 0; j < 3; j++) {
+            sumCross[i][j] = sumCross[i][j] * FORGET + x[i] * y[j];
+            sumPlayspaceOuter[i][j] = sumPlayspaceOuter[i][j] * FORGET + y[i] * y[j];
+        }
+    }
+
+    return true;
+}
+
+bool PlayspaceCalibration::Solve() {
+    if (weight < MIN_WEIGHT) {
+        return false;
+    }
+
+    double meanCamera[3];
+    double meanPlayspace[3];
+    for (int i = 0; i < 3; i++) {
+        meanCamera[i] = sumCamera[i] / weight;
+        meanPlayspace[i] = sumPlayspace[i] / weight;
+    }
+
+    // make sure the HMD moved along at least two axes
+    double spread[3][3];
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            spread[i][j] = sumPlayspaceOuter[i][j] / weight - meanPlayspace[i] * meanPlayspace[j];
+        }
+    }
+    double spreadValues[3];
+    double spreadVectors[3][3];
+    JacobiEigen(spread, spreadValues, spreadVectors);
+    int small = 0;
+    for (double value : spreadValues) {
+        if (value < MIN_SPREAD * MIN_SPREAD) {
+            small++;
+        }
+    }
+    if (small > 1) {
+        return false;
+    }
+
+    // the cross covariance of the centered samples
+    double s[3][3];
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            s[i][j] = sumCross[i][j] - weight * meanCamera[i] * meanPlayspace[j];
+        }
+    }
+
+    // the rotation is the eigenvector of the largest eigenvalue of this
+    // matrix, as a quaternion (Horn, 1987)
+    double n[4][4] = {
+        { s[0][0] + s[1][1] + s[2][2], s[1][2] - s[2][1], s[2][0] - s[0][2], s[0][1] - s[1][0] },
+        { s[1][2] - s[2][1], s[0][0] - s[1][1] - s[2][2], s[0][1] + s[1][0], s[2][0] + s[0][2] },
+        { s[2][0] - s[0][2], s[0][1] + s[1][0], -s[0][0] + s[1][1] - s[2][2], s[1][2] + s[2][1] },
+        { s[0][1] - s[1][0], s[2][0] + s[0][2], s[1][2] + s[2][1], -s[0][0] - s[1][1] + s[2][2] },
+    };
+    double values[4];
+    double vectors[4][4];
+    JacobiEigen(n, values, vectors);
+
+    int largest = 0;
+    for (int i = 1; i < 4; i++) {
+        if (values[i] > values[largest]) {
+            largest = i;
+        }
+    }
+
+    double q[4];
+    double length = 0.0;
+    for (int i = 0; i < 4; i++) {
+        q[i] = vectors[i][largest];
+        length += q[i] * q[i];
+    }
+    length = std::sqrt(length);
+    for (double& value : q) {
+        value /= length;
+    }
+
+    matrix4 rotation = matrix4::similarity(1.0f,
+                                           static_cast<float>(q[0]), static_cast<float>(q[1]),
+                                           static_cast<float>(q[2]), static_cast<float>(q[3]),
+                                           vector3::zero());
+
+    // the scale that best matches the spread of the two sets
+    double variance = sumCameraSquared - weight * (meanCamera[0] * meanCamera[0] + meanCamera[1] * meanCamera[1] + meanCamera[2] * meanCamera[2]);
+    double trace = 0.0;
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            trace += rotation.m[i][j] * s[j][i];
+        }
+    }
+    if (variance <= 0.0 || trace <= 0.0) {
+        return false;
+    }
+    double scale = trace / variance;
+
+    vector3 center = rotation.transform(vector3(
+            static_cast<float>(meanCamera[0]),
+            static_cast<float>(meanCamera[1]),
+            static_cast<float>(meanCamera[2])));
+    vector3 translation(
+            static_cast<float>(meanPlayspace[0] - scale * center.x),
+            static_cast<float>(meanPlayspace[1] - scale * center.y),
+            static_cast<float>(meanPlayspace[2] - scale * center.z));
+
+    matrix4 solved = matrix4::similarity(static_cast<float>(scale),
+                                         static_cast<float>(q[0]), static_cast<float>(q[1]),
+                                         static_cast<float>(q[2]), static_cast<float>(q[3]),
+                                         translation);
+    if (!IsFinite(solved)) {
+        return false;
+    }
+
+    transform = solved;
+    calibrated = true;
+    changed = true;
+    return true;
+}
+
+bool PlayspaceCalibration::IsCalibrated() const {
+    return calibrated;
+}
+
+bool PlayspaceCalibration::HasChanged() const {
+    return changed;
+}
+
+vector3 PlayspaceCalibration::Apply(const vector3& camera) const {
+    return transform.transform(camera);
+}
+
+bool PlayspaceCalibration::Load(const std::string& path) {
+    std::ifstream in(path);
+    std::string header;
+    if (!std::getline(in, header) || header != FILE_HEADER) {
+        return false;
+    }
+
+    matrix4 loaded;
+    for (auto& row : loaded.m) {
+        for (float& value : row) {
+            if (!(in >> value)) {
+                return false;
+            }
+        }
+    }
+    if (!IsFinite(loaded)) {
+        return false;
+    }
+
+    transform = loaded;
+    calibrated = true;
+    changed = false;
+    return true;
+}
+
+const matrix4& PlayspaceCalibration::GetTransform() const {
+    return transform;
+}
+
+void PlayspaceCalibration::MarkSaved() {
+    changed = false;
+}
+
+bool PlayspaceCalibration::Save(const std::string& path) {
+    if (!Save(path, transform)) {
+        return false;
+    }
+
+    changed = false;
+    return true;
+}
+
+bool PlayspaceCalibration::Save(const std::string& path, const matrix4& transform) {
+    // never write over a good calibration with a broken one
+    if (!IsFinite(transform)) {
+        return false;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+
+    out.precision(9);
+    out << FILE_HEADER << std::endl;
+    for (const auto& row : transform.m) {
+        out << row[0] << " " << row[1] << " " << row[2] << " " << row[3] << std::endl;
+    }
+
+    return static_cast<bool>(out);
+}
+
+std::string PlayspaceCalibration::GetDefaultPath() {
+#ifdef _WIN32
+    const char* base = std::getenv("APPDATA");
+    std::string directory = base != nullptr ? base : ".";
+#else
+    const char* config = std::getenv("XDG_CONFIG_HOME");
+    const char* home = std::getenv("HOME");
+    std::string directory = config != nullptr ? config : (home != nullptr ? std::string(home) + "/.config" : ".");
+#endif
+    return directory + "/pmfbt/calibration.txt";
+}
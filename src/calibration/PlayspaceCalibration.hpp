@@ -0,0 +1,109 @@
+#pragma once
+
+#include <string>
+
+#include <math/matrix4.hpp>
+
+/**
+ * Finds the transform from the camera space of the reconstructed poses to the
+ * play space of SteamVR, from pairs of the reconstructed head and the HMD
+ * position, while the user moves around.
+ *
+ * The transform is a similarity (scale, rotation and translation), solved in
+ * closed form with Horn's quaternion method from running sums of the samples.
+ * Adding a sample and solving both take constant time. Older samples are slowly
+ * forgotten, so the calibration follows the camera if it gets moved.
+ */
+class PlayspaceCalibration {
+private:
+    /**
+     * Exponentially weighted sums of the samples, enough to solve the
+     * transform at any time without keeping the samples around
+     */
+    double weight;
+    double sumCamera[3];
+    double sumPlayspace[3];
+    double sumCameraSquared;
+    double sumCross[3][3];
+    double sumPlayspaceOuter[3][3];
+
+    /**
+     * Where the HMD was at the last sample, we only take a new sample
+     * once it moved a bit so standing still does not flood the sums
+     */
+    vector3 lastSample;
+    bool haveSample;
+
+    /**
+     * The current solution
+     */
+    matrix4 transform;
+    bool calibrated;
+
+    /**
+     * Did the solution change since it was last saved
+     */
+    bool changed;
+
+public:
+
+    PlayspaceCalibration();
+
+    /**
+     * Add a pair of positions of the same point
+     *
+     * @param camera    [IN] The reconstructed position
+     * @param playspace [IN] The position in the play space
+     *
+     * @return False if the sample was too close to the previous one, or not finite
+     */
+    bool AddSample(const vector3& camera, const vector3& playspace);
+
+    /**
+     * Solve the transform from the samples so far, the previous solution is
+     * kept if the samples are not spread out enough yet
+     *
+     * @return True if the transform was updated
+     */
+    bool Solve();
+
+    bool IsCalibrated() const;
+    bool HasChanged() const;
+
+    /**
+     * Move a point from the camera to the play space
+     */
+    vector3 Apply(const vector3& camera) const;
+
+    /**
+     * Load a transform that was saved before, it is used until the
+     * new samples give a good enough solution
+     */
+    bool Load(const std::string& path);
+
+    /**
+     * The current solution
+     */
+    const matrix4& GetTransform() const;
+
+    /**
+     * Forget the changes so far, once a copy of the transform is on its way to the disk
+     */
+    void MarkSaved();
+
+    /**
+     * Save the current transform
+     */
+    bool Save(const std::string& path);
+
+    /**
+     * Save a copy of a transform, this does not touch the calibration so it can be
+     * done on any thread. A transform that is not finite is never saved.
+     */
+    static bool Save(const std::string& path, const matrix4& transform);
+
+    /**
+     * Where the calibration is kept, in the config directory of the user
+     */
+    static std::string GetDefaultPath();
+};
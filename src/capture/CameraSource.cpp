@@ -0,0 +1,74 @@
+#include <util/Time.hpp>
+#include <PipelineThreads.hpp>
+#include <Config.hpp>
+
+#include "CameraSource.hpp"
+
+CameraSource::CameraSource(int index, TaskPool* taskPool)
+    // a frame per decode thread, one waiting and one in the pipeline
+    : FrameSource(GetConfig().decodeThreads + 2)
+#ifdef LINUX
+    , capture(index, cv::CAP_V4L2)
+#else
+    , capture(index, cv::CAP_ANY)
+#endif
+    , jpegDecodePool()
+    , raw()
+    , encoded()
+    , thread()
+    , running(true)
+{
+    // we want the newest frame, not a queue of old ones
+    capture.set(cv::CAP_PROP_BUFFERSIZE, 1);
+
+    // ask for MJPEG, and only skip the OpenCV decode if the camera agreed to it
+    if (GetConfig().cameraMjpeg) {
+        int mjpg = cv::VideoWriter::fourcc('M', 'J', 'P', 'G');
+        capture.set(cv::CAP_PROP_FOURCC, mjpg);
+        if (static_cast<int>(capture.get(cv::CAP_PROP_FOURCC)) == mjpg && capture.set(cv::CAP_PROP_CONVERT_RGB, 0)) {
+            jpegDecodePool = std::make_unique<JpegDecodePool>(pool, GetConfig().decodeThreads, GetConfig().decodeMinSize, taskPool);
+        }
+    }
+
+    thread = std::thread(&CameraSource::CaptureThread, this);
+}
+
+CameraSource::~CameraSource() {
+    running = false;
+    thread.join();
+}
+
+void CameraSource::CaptureThread() {
+    SetupPipelineThread("pmfbt-camera");
+    uint64_t index = 0;
+
+    while (running && capture.isOpened()) {
+        // grab first, the timestamp should be as close to the exposure as we can get
+        if (!capture.grab()) {
+            break;
+        }
+        int64_t timestamp = GetMicroseconds();
+
+        if (jpegDecodePool != nullptr) {
+            if (!capture.retrieve(raw) || raw.empty()) {
+                continue;
+            }
+
+            encoded.assign(raw.data, raw.data + raw.total() * raw.elemSize());
+            jpegDecodePool->Submit(encoded, timestamp, index++);
+            continue;
+        }
+
+        Frame* frame = pool.Acquire();
+        if (!capture.retrieve(frame->image)) {
+            pool.Discard(frame);
+            continue;
+        }
+
+        frame->timestamp = timestamp;
+        frame->index = index++;
+        pool.Publish(frame);
+    }
+
+    pool.Close();
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "FrameSource.hpp"
+#include "JpegDecodePool.hpp"
+
+/**
+ * Captures frames from a local camera (V4L2 on linux)
+ */
+class CameraSource final : public FrameSource {
+private:
+    cv::VideoCapture capture;
+
+    /**
+     * When the camera gives us MJPEG we take the raw frames and decode
+     * them ourselves, scaled down and on multiple threads
+     */
+    std::unique_ptr<JpegDecodePool> jpegDecodePool;
+    cv::Mat raw;
+    std::vector<uint8_t> encoded;
+
+    /**
+     * The thread reading from the camera
+     */
+    std::thread thread;
+    std::atomic<bool> running;
+
+    void CaptureThread();
+
+public:
+
+    /**
+     * @param index     [IN] The index of the camera device
+     * @param taskPool  [IN] Decode on the task pool instead of our own threads, can be null
+     */
+    explicit CameraSource(int index, TaskPool* taskPool = nullptr);
+    ~CameraSource() override;
+};
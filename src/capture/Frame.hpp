@@ -0,0 +1,25 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+#include <cstdint>
+
+/**
+ * A single captured frame
+ */
+struct Frame {
+    /**
+     * The image itself, the buffer is reused between frames
+     */
+    cv::Mat image;
+
+    /**
+     * When the frame was captured, in microseconds of the monotonic clock
+     */
+    int64_t timestamp;
+
+    /**
+     * Increasing index of the frame in its source
+     */
+    uint64_t index;
+};
@@ -0,0 +1,139 @@
+#include "FramePool.hpp"
+
+FramePool::FramePool(size_t count)
+    : frames(count)
+    , available()
+    , pending(nullptr)
+    , lastIndex(0)
+    , dropped(0)
+    , closed(false)
+    , listener(nullptr)
+    , listenerContext(nullptr)
+    , mutex()
+    , condition()
+{
+    available.reserve(count);
+    for (auto& frame : frames) {
+        available.push_back(&frame);
+    }
+}
+
+Frame* FramePool::Acquire() {
+    std::lock_guard<std::mutex> guard{this->mutex};
+
+    if (!available.empty()) {
+        Frame* frame = available.back();
+        available.pop_back();
+        return frame;
+    }
+
+    // everything is in use, the pending frame is going to be stale anyways
+    Frame* frame = pending;
+    pending = nullptr;
+    dropped++;
+    return frame;
+}
+
+void FramePool::Publish(Frame* frame) {
+    Listener notify;
+    void* context;
+    int64_t timestamp;
+    {
+        std::lock_guard<std::mutex> guard{this->mutex};
+
+        // a frame that finished after a newer one is useless
+        if (frame->index < lastIndex) {
+            available.push_back(frame);
+            dropped++;
+            return;
+        }
+
+        if (pending != nullptr) {
+            available.push_back(pending);
+            dropped++;
+        }
+
+        // once we let go the frame may be taken and given back already
+        pending = frame;
+        lastIndex = frame->index;
+        timestamp = frame->timestamp;
+        notify = listener;
+        context = listenerContext;
+    }
+
+    condition.notify_one();
+    if (notify != nullptr) {
+        notify(context, timestamp);
+    }
+}
+
+void FramePool::Discard(Frame* frame) {
+    std::lock_guard<std::mutex> guard{this->mutex};
+    available.push_back(frame);
+}
+
+Frame* FramePool::Wait() {
+    std::unique_lock<std::mutex> lock{this->mutex};
+    condition.wait(lock, [this] { return pending != nullptr || closed; });
+
+    Frame* frame = pending;
+    pending = nullptr;
+    return frame;
+}
+
+Frame* FramePool::TryTake() {
+    std::lock_guard<std::mutex> guard{this->mutex};
+    Frame* frame = pending;
+    pending = nullptr;
+    return frame;
+}
+
+bool FramePool::HasPending(int64_t& timestamp) {
+    std::lock_guard<std::mutex> guard{this->mutex};
+    if (pending == nullptr) {
+        return false;
+    }
+
+    timestamp = pending->timestamp;
+    return true;
+}
+
+void FramePool::SetListener(Listener listener, void* context) {
+    std::lock_guard<std::mutex> guard{this->mutex};
+    this->listener = listener;
+    this->listenerContext = context;
+}
+
+void FramePool::Release(Frame* frame) {
+    std::lock_guard<std::mutex> guard{this->mutex};
+    available.push_back(frame);
+}
+
+void FramePool::Close() {
+    Listener notify;
+    void* context;
+    {
+        std::lock_guard<std::mutex> guard{this->mutex};
+        if (closed) {
+            return;
+        }
+        closed = true;
+        notify = listener;
+        context = listenerContext;
+    }
+
+    condition.notify_all();
+    if (notify != nullptr) {
+        notify(context, 0);
+    }
+}
+
+bool FramePool::IsClosed() {
+    std::lock_guard<std::mutex> guard{this->mutex};
+    return closed;
+}
+
+uint64_t FramePool::GetDropped() {
+    std::lock_guard<std::mutex> guard{this->mutex};
+    return dropped;
+}
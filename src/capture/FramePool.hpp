@@ -0,0 +1,134 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <vector>
+#include <mutex>
+
+#include "Frame.hpp"
+
+/**
+ * A fixed set of frames that is passed between a producer (the capture or
+ * decode thread) and the pipeline, so image buffers are reused instead of
+ * allocated every frame.
+ *
+ * Only the newest frame is kept for the pipeline, if the pipeline is slower
+ * than the producer the older frames are dropped, which keeps the latency low.
+ */
+class FramePool {
+public:
+    /**
+     * Told about every published frame, and with a zero timestamp when the
+     * pool is closed
+     */
+    using Listener = void (*)(void* context, int64_t timestamp);
+
+private:
+    /**
+     * All the frames we own
+     */
+    std::vector<Frame> frames;
+
+    /**
+     * The frames nobody uses right now
+     */
+    std::vector<Frame*> available;
+
+    /**
+     * The newest frame that the pipeline did not take yet
+     */
+    Frame* pending;
+
+    /**
+     * The index of the newest frame that was published, older
+     * frames that finish late are dropped
+     */
+    uint64_t lastIndex;
+
+    /**
+     * How many frames were dropped
+     */
+    uint64_t dropped;
+
+    /**
+     * Set once the producer will not give any more frames
+     */
+    bool closed;
+
+    /**
+     * Called outside of the lock, so it can take the frame right away
+     */
+    Listener listener;
+    void* listenerContext;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+
+public:
+
+    /**
+     * @param count [IN] The amount of frames, must be at least one per
+     *                   producer thread plus two
+     */
+    explicit FramePool(size_t count);
+
+    /**
+     * Get a free frame to fill, if there is none the pending frame
+     * is dropped and reused.
+     */
+    Frame* Acquire();
+
+    /**
+     * Give a filled frame to the pipeline, replacing the pending frame
+     */
+    void Publish(Frame* frame);
+
+    /**
+     * Give back a frame that was acquired but not filled
+     */
+    void Discard(Frame* frame);
+
+    /**
+     * Wait for the next frame for the pipeline
+     *
+     * @return The newest frame, or nullptr if the pool was closed
+     */
+    Frame* Wait();
+
+    /**
+     * Take the next frame for the pipeline without waiting
+     *
+     * @return The newest frame, or nullptr if there is none yet
+     */
+    Frame* TryTake();
+
+    /**
+     * Check if there is a frame waiting for the pipeline
+     *
+     * @param timestamp [OUT] The capture time of the waiting frame
+     */
+    bool HasPending(int64_t& timestamp);
+
+    /**
+     * Get told about new frames instead of waiting for them, for
+     * pipelines that run as tasks
+     */
+    void SetListener(Listener listener, void* context);
+
+    /**
+     * Give back a frame that the pipeline is done with
+     */
+    void Release(Frame* frame);
+
+    /**
+     * Wake up the pipeline and stop giving frames
+     */
+    void Close();
+
+    bool IsClosed();
+
+    /**
+     * How many frames were dropped so far
+     */
+    uint64_t GetDropped();
+};
@@ -0,0 +1,38 @@
+#include "FrameSource.hpp"
+
+FrameSource::FrameSource(size_t poolSize)
+    : pool(poolSize)
+{
+}
+
+Frame* FrameSource::Next() {
+    return pool.Wait();
+}
+
+Frame* FrameSource::TryNext() {
+    return pool.TryTake();
+}
+
+bool FrameSource::HasNext(int64_t& timestamp) {
+    return pool.HasPending(timestamp);
+}
+
+void FrameSource::SetListener(FramePool::Listener listener, void* context) {
+    pool.SetListener(listener, context);
+}
+
+void FrameSource::Release(Frame* frame) {
+    pool.Release(frame);
+}
+
+void FrameSource::Close() {
+    pool.Close();
+}
+
+bool FrameSource::IsClosed() {
+    return pool.IsClosed();
+}
+
+uint64_t FrameSource::GetDroppedFrames() {
+    return pool.GetDropped();
+}
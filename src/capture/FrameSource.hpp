@@ -0,0 +1,71 @@
+#pragma once
+
+#include "FramePool.hpp"
+
+/**
+ * Something that produces frames for the pipeline, the frames are
+ * produced on their own thread into the frame pool, so capture and
+ * decoding overlap with the processing of the previous frame.
+ */
+class FrameSource {
+protected:
+    /**
+     * The frames passed to the pipeline
+     */
+    FramePool pool;
+
+public:
+
+    explicit FrameSource(size_t poolSize);
+    virtual ~FrameSource() = default;
+
+    FrameSource(const FrameSource&) = delete;
+    FrameSource& operator=(const FrameSource&) = delete;
+
+    /**
+     * Wait for the newest frame, it must be given back with Release
+     *
+     * @return The frame, or nullptr if the source stopped
+     */
+    Frame* Next();
+
+    /**
+     * Take the newest frame without waiting, it must be given back with Release
+     *
+     * @return The frame, or nullptr if there is no new frame
+     */
+    Frame* TryNext();
+
+    /**
+     * Check for a new frame without taking it
+     *
+     * @param timestamp [OUT] The capture time of the frame
+     */
+    bool HasNext(int64_t& timestamp);
+
+    /**
+     * Call the listener for every new frame, and once when the source
+     * stops, from the thread that produced the frame
+     */
+    void SetListener(FramePool::Listener listener, void* context);
+
+    /**
+     * Give back a frame that we are done with
+     */
+    void Release(Frame* frame);
+
+    /**
+     * Stop giving frames, wakes up anyone waiting in Next
+     */
+    void Close();
+
+    /**
+     * Check if the source stopped, it may still have one last frame
+     */
+    bool IsClosed();
+
+    /**
+     * How many frames were dropped because we could not keep up
+     */
+    uint64_t GetDroppedFrames();
+};
@@ -0,0 +1,96 @@
+#ifdef PMFBT_HAVE_FFMPEG
+extern "C" {
+    #include <libavcodec/avcodec.h>
+    #include <libswscale/swscale.h>
+}
+#endif
+
+#include "H264Decoder.hpp"
+
+#ifdef PMFBT_HAVE_FFMPEG
+
+H264Decoder::H264Decoder()
+    : context(nullptr)
+    , packet(av_packet_alloc())
+    , frame(av_frame_alloc())
+    , scaler(nullptr)
+{
+    const AVCodec* codec = avcodec_find_decoder(AV_CODEC_ID_H264);
+    if (codec == nullptr) {
+        return;
+    }
+
+    // we want every picture out as soon as possible, frame threading
+    // would add a frame of latency per thread
+    context = avcodec_alloc_context3(codec);
+    context->flags |= AV_CODEC_FLAG_LOW_DELAY;
+    context->flags2 |= AV_CODEC_FLAG2_FAST;
+    context->thread_type = FF_THREAD_SLICE;
+
+    if (avcodec_open2(context, codec, nullptr) < 0) {
+        avcodec_free_context(&context);
+    }
+}
+
+H264Decoder::~H264Decoder() {
+    sws_freeContext(scaler);
+    av_frame_free(&frame);
+    av_packet_free(&packet);
+    avcodec_free_context(&context);
+}
+
+bool H264Decoder::IsSupported() {
+    return avcodec_find_decoder(AV_CODEC_ID_H264) != nullptr;
+}
+
+bool H264Decoder::Decode(const uint8_t* data, size_t size, cv::Mat& output) {
+    if (context == nullptr) {
+        return false;
+    }
+
+    packet->data = const_cast<uint8_t*>(data);
+    packet->size = static_cast<int>(size);
+    if (avcodec_send_packet(context, packet) < 0) {
+        return false;
+    }
+
+    if (avcodec_receive_frame(context, frame) < 0) {
+        return false;
+    }
+
+    // convert to the BGR the rest of the pipeline works with
+    output.create(frame->height, frame->width, CV_8UC3);
+    scaler = sws_getCachedContext(scaler,
+            frame->width, frame->height, static_cast<AVPixelFormat>(frame->format),
+            frame->width, frame->height, AV_PIX_FMT_BGR24,
+            SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+
+    uint8_t* planes[] = { output.data };
+    int strides[] = { static_cast<int>(output.step) };
+    sws_scale(scaler, frame->data, frame->linesize, 0, frame->height, planes, strides);
+
+    av_frame_unref(frame);
+    return true;
+}
+
+#else
+
+H264Decoder::H264Decoder()
+    : context(nullptr)
+    , packet(nullptr)
+    , frame(nullptr)
+    , scaler(nullptr)
+{
+}
+
+H264Decoder::~H264Decoder() = default;
+
+bool H264Decoder::IsSupported() {
+    return false;
+}
+
+bool H264Decoder::Decode(const uint8_t*, size_t, cv::Mat&) {
+    return false;
+}
+
+#endif
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+#include <cstdint>
+#include <cstddef>
+
+struct AVCodecContext;
+struct AVPacket;
+struct AVFrame;
+struct SwsContext;
+
+/**
+ * Decodes an H.264 Annex B stream one access unit at a time, this needs
+ * the driver to be built with FFmpeg, otherwise nothing is decoded.
+ */
+class H264Decoder {
+private:
+    AVCodecContext* context;
+    AVPacket* packet;
+    AVFrame* frame;
+    SwsContext* scaler;
+
+public:
+
+    H264Decoder();
+    ~H264Decoder();
+
+    H264Decoder(const H264Decoder&) = delete;
+    H264Decoder& operator=(const H264Decoder&) = delete;
+
+    /**
+     * Is H.264 decoding supported in this build
+     */
+    static bool IsSupported();
+
+    /**
+     * Decode a single access unit
+     *
+     * @param data      [IN]    The access unit, in Annex B format
+     * @param size      [IN]    The size of the access unit
+     * @param output    [OUT]   The decoded BGR image, reused between frames
+     *
+     * @return True if we got a picture out of it
+     */
+    bool Decode(const uint8_t* data, size_t size, cv::Mat& output);
+};
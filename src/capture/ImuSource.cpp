@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <cstring>
+
+#include <util/Process.hpp>
+#include <util/Time.hpp>
+
+#include "ImuSource.hpp"
+
+/**
+ * Room for a second of samples from a few phones while we are not scheduled
+ */
+constexpr int RECEIVE_BUFFER_SIZE = 256 * 1024;
+
+/**
+ * How long to wait for a packet before checking if we should stop
+ */
+constexpr int RECEIVE_TIMEOUT_MS = 100;
+
+/**
+ * The largest datagram there can be, so nothing is ever cut short
+ */
+constexpr size_t MAX_PACKET_SIZE = 65536;
+
+/**
+ * How fast the clock offset can drift upward, in microseconds per second, this
+ * covers the difference between the clock of the phone and ours
+ */
+constexpr int64_t CLOCK_DRIFT = 200;
+
+/**
+ * A sequence this far behind the last one is a phone that started over
+ */
+constexpr uint32_t SEQUENCE_RESTART = 1000;
+
+ImuSource::ImuSource()
+    : socket()
+    , listener(nullptr)
+    , context(nullptr)
+    , clocks()
+    , packet(MAX_PACKET_SIZE)
+    , samples()
+    , thread()
+    , running(false)
+{
+}
+
+ImuSource::~ImuSource() {
+    Close();
+}
+
+bool ImuSource::Open(uint16_t port, Listener listener, void* context) {
+    Close();
+
+    if (!socket.Bind(port, RECEIVE_BUFFER_SIZE)) {
+        return false;
+    }
+
+    this->listener = listener;
+    this->context = context;
+    for (auto& clock : clocks) {
+        clock.valid = false;
+    }
+
+    running = true;
+    thread = std::thread(&ImuSource::ReceiveThread, this);
+    return true;
+}
+
+void ImuSource::Close() {
+    running = false;
+    if (thread.joinable()) {
+        thread.join();
+    }
+    socket.Close();
+}
+
+void ImuSource::ReceiveThread() {
+    SetThreadName("pmfbt-imu");
+
+    while (running) {
+        int size = socket.Receive(packet.data(), packet.size(), RECEIVE_TIMEOUT_MS);
+        if (size < 0) {
+            break;
+        }
+
+        if (size > 0) {
+            HandlePacket(size, GetMicroseconds());
+        }
+    }
+}
+
+void ImuSource::HandlePacket(size_t size, int64_t arrival) {
+    if (size < sizeof(ImuPacketHeader)) {
+        return;
+    }
+
+    ImuPacketHeader header;
+    std::memcpy(&header, packet.data(), sizeof(header));
+    if (header.magic != IMU_PACKET_MAGIC || header.version != IMU_PACKET_VERSION
+            || header.tracker >= IMU_MAX_TRACKERS || header.count == 0 || header.count > IMU_PACKET_MAX_SAMPLES
+            || size != sizeof(header) + header.count * sizeof(ImuPacketSample)) {
+        return;
+    }
+
+    // drop whatever comes out of order, unless the phone started over
+    auto& clock = clocks[header.tracker];
+    int32_t ahead = static_cast<int32_t>(header.sequence - clock.sequence);
+    if (clock.valid && ahead <= 0 && ahead > -static_cast<int32_t>(SEQUENCE_RESTART)) {
+        return;
+    }
+    if (clock.valid && ahead <= 0) {
+        clock.valid = false;
+    }
+    clock.sequence = header.sequence;
+
+    // the newest sample was taken right before the packet was sent
+    ImuPacketSample sample;
+    std::memcpy(&sample, packet.data() + sizeof(header) + (header.count - 1) * sizeof(sample), sizeof(sample));
+    int64_t offset = arrival - sample.time;
+    if (!clock.valid) {
+        clock.offset = offset;
+    } else {
+        int64_t drifted = clock.offset + (arrival - clock.lastUpdate) * CLOCK_DRIFT / 1000000;
+        clock.offset = std::min(offset, drifted);
+    }
+    clock.lastUpdate = arrival;
+    clock.valid = true;
+
+    for (int i = 0; i < header.count; i++) {
+        std::memcpy(&sample, packet.data() + sizeof(header) + i * sizeof(sample), sizeof(sample));
+        samples[i].time = sample.time + clock.offset;
+        samples[i].acceleration = vector3(sample.acceleration[0], sample.acceleration[1], sample.acceleration[2]);
+        samples[i].rotationRate = vector3(sample.rotationRate[0], sample.rotationRate[1], sample.rotationRate[2]);
+    }
+
+    listener(context, header.tracker, samples, header.count);
+}
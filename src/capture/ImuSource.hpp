@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <math/vector3.hpp>
+#include <net/ImuPacket.hpp>
+#include <net/UdpSocket.hpp>
+
+/**
+ * The most trackers that can have a phone on them
+ */
+constexpr int IMU_MAX_TRACKERS = 16;
+
+/**
+ * A single sample of an IMU, in the axes of the device
+ */
+struct ImuSample {
+    /**
+     * When it was taken, on our clock
+     */
+    int64_t time;
+
+    /**
+     * In m/s^2 including gravity, and in rad/s
+     */
+    vector3 acceleration;
+    vector3 rotationRate;
+};
+
+/**
+ * Receives the IMU samples phones strapped to the body stream over UDP, and
+ * hands them over packet by packet from a thread of its own, as soon as they
+ * arrive.
+ */
+class ImuSource {
+public:
+    /**
+     * Called on the receive thread with the samples of a packet, oldest first
+     */
+    using Listener = void (*)(void* context, int tracker, const ImuSample* samples, int count);
+
+private:
+    UdpSocket socket;
+    Listener listener;
+    void* context;
+
+    /**
+     * Maps the clock of every phone to ours, like the network source we track the
+     * smallest offset between the two, which is the packet that had the least delay
+     * in the network, and let it drift slowly to follow the clock of the phone
+     */
+    struct SenderClock {
+        bool valid;
+        uint32_t sequence;
+        int64_t offset;
+        int64_t lastUpdate;
+    };
+    SenderClock clocks[IMU_MAX_TRACKERS];
+
+    /**
+     * The packet, and its samples on our clock
+     */
+    std::vector<uint8_t> packet;
+    ImuSample samples[IMU_PACKET_MAX_SAMPLES];
+
+    std::thread thread;
+    std::atomic<bool> running;
+
+    void ReceiveThread();
+    void HandlePacket(size_t size, int64_t arrival);
+
+public:
+
+    ImuSource();
+    ~ImuSource();
+
+    ImuSource(const ImuSource&) = delete;
+    ImuSource& operator=(const ImuSource&) = delete;
+
+    /**
+     * Start listening for the phones
+     *
+     * @param port      [IN] The UDP port the phones send to
+     * @param listener  [IN] Gets the samples
+     * @param context   [IN] Passed to the listener
+     */
+    bool Open(uint16_t port, Listener listener, void* context);
+
+    void Close();
+};
@@ -0,0 +1,271 @@
+#include <algorithm>
+#include <cmath>
+
+#include "RtpPayload.hpp"
+#include "JitterBuffer.hpp"
+
+/**
+ * The bounds of the delay we wait for missing packets, in microseconds
+ */
+constexpr int64_t MIN_DELAY = 2000;
+constexpr int64_t MAX_DELAY = 40000;
+
+/**
+ * How many jitters to wait for, the larger the more reordering we tolerate
+ */
+constexpr double JITTER_FACTOR = 3.0;
+
+/**
+ * The maximum amount of packets in a single frame
+ */
+constexpr size_t MAX_PACKETS = 1024;
+
+/**
+ * The initial size of the buffer of each frame, enough for most frames so
+ * we don't need to grow it after the first few frames
+ */
+constexpr size_t INITIAL_FRAME_SIZE = 256 * 1024;
+
+/**
+ * Wrap-around aware comparisons of sequence numbers and timestamps
+ */
+static bool SequenceBefore(uint16_t a, uint16_t b) {
+    return static_cast<int16_t>(a - b) < 0;
+}
+
+static bool TimestampBefore(uint32_t a, uint32_t b) {
+    return static_cast<int32_t>(a - b) < 0;
+}
+
+JitterBuffer::JitterBuffer()
+    : slots()
+    , independentFrames(false)
+    , haveLast(false)
+    , lastTimestamp(0)
+    , haveLastEnd(false)
+    , lastEndSequence(0)
+    , jitter(0)
+    , haveTransit(false)
+    , lastTransit(0)
+    , dropped(0)
+{
+    for (auto& slot : slots) {
+        slot.used = false;
+        slot.packets.reserve(MAX_PACKETS);
+        slot.data.reserve(INITIAL_FRAME_SIZE);
+    }
+}
+
+void JitterBuffer::Reset(bool independent) {
+    for (auto& slot : slots) {
+        slot.used = false;
+    }
+
+    independentFrames = independent;
+    haveLast = false;
+    haveLastEnd = false;
+    jitter = 0;
+    haveTransit = false;
+}
+
+void JitterBuffer::Insert(uint16_t sequence, uint32_t timestamp, bool marker, bool frameStart, const uint8_t* data, size_t size, int64_t arrival) {
+    // update the jitter estimate
+    double transit = static_cast<double>(arrival) - timestamp * (1000000.0 / RTP_CLOCK_RATE);
+    if (haveTransit) {
+        jitter += (std::abs(transit - lastTransit) - jitter) / 16.0;
+    }
+    lastTransit = transit;
+    haveTransit = true;
+
+    // we already handed out a newer frame
+    if (haveLast && !TimestampBefore(lastTimestamp, timestamp)) {
+        return;
+    }
+
+    // find the frame of this packet
+    Slot* slot = nullptr;
+    for (auto& current : slots) {
+        if (current.used && current.timestamp == timestamp) {
+            slot = &current;
+            break;
+        }
+    }
+
+    if (slot == nullptr) {
+        // take a free slot, or give up on the oldest frame
+        for (auto& current : slots) {
+            if (!current.used) {
+                slot = &current;
+                break;
+            }
+        }
+
+        if (slot == nullptr) {
+            slot = FindOldest();
+            Drop(*slot);
+        }
+
+        slot->used = true;
+        slot->timestamp = timestamp;
+        slot->firstArrival = arrival;
+        slot->hasStart = false;
+        slot->hasEnd = false;
+        slot->packets.clear();
+        slot->data.clear();
+    }
+
+    if (slot->packets.size() == MAX_PACKETS) {
+        return;
+    }
+
+    // insert sorted by sequence, packets mostly arrive in order so
+    // this almost never moves anything
+    auto position = slot->packets.end();
+    while (position != slot->packets.begin() && !SequenceBefore((position - 1)->sequence, sequence)) {
+        if ((position - 1)->sequence == sequence) {
+            // duplicate
+            return;
+        }
+        --position;
+    }
+
+    Packet packet {};
+    packet.sequence = sequence;
+    packet.offset = static_cast<uint32_t>(slot->data.size());
+    packet.size = static_cast<uint32_t>(size);
+    slot->packets.insert(position, packet);
+    slot->data.insert(slot->data.end(), data, data + size);
+
+    // with more than one packet that may start the frame, the first one is the start
+    if (frameStart && (!slot->hasStart || SequenceBefore(sequence, slot->startSequence))) {
+        slot->hasStart = true;
+        slot->startSequence = sequence;
+    }
+
+    if (marker) {
+        slot->hasEnd = true;
+        slot->endSequence = sequence;
+    }
+}
+
+JitterBuffer::Slot* JitterBuffer::FindOldest() {
+    Slot* oldest = nullptr;
+    for (auto& slot : slots) {
+        if (slot.used && (oldest == nullptr || TimestampBefore(slot.timestamp, oldest->timestamp))) {
+            oldest = &slot;
+        }
+    }
+    return oldest;
+}
+
+bool JitterBuffer::IsComplete(const Slot& slot, bool havePreviousEnd, uint16_t previousEnd) const {
+    if (!slot.hasEnd || slot.packets.empty()) {
+        return false;
+    }
+
+    // either the payload told us where the frame starts, or it starts right
+    // after the end of the previous frame
+    uint16_t first = slot.packets.front().sequence;
+    bool startKnown = slot.hasStart
+            ? slot.startSequence == first
+            : havePreviousEnd && static_cast<uint16_t>(previousEnd + 1) == first;
+    if (!startKnown) {
+        return false;
+    }
+
+    // no holes between the first and last packets
+    return static_cast<uint16_t>(slot.endSequence - first) + 1u == slot.packets.size();
+}
+
+void JitterBuffer::Emit(Slot& slot, std::vector<uint8_t>& output, uint32_t& timestamp) {
+    output.clear();
+    for (const auto& packet : slot.packets) {
+        output.insert(output.end(), slot.data.begin() + packet.offset, slot.data.begin() + packet.offset + packet.size);
+    }
+    timestamp = slot.timestamp;
+
+    haveLast = true;
+    lastTimestamp = slot.timestamp;
+    haveLastEnd = true;
+    lastEndSequence = slot.endSequence;
+    slot.used = false;
+}
+
+void JitterBuffer::Drop(Slot& slot) {
+    haveLast = true;
+    lastTimestamp = slot.timestamp;
+    haveLastEnd = slot.hasEnd;
+    lastEndSequence = slot.endSequence;
+    slot.used = false;
+    dropped++;
+}
+
+bool JitterBuffer::Pop(int64_t now, std::vector<uint8_t>& output, uint32_t& timestamp) {
+    // go over the frames from the oldest to the newest
+    Slot* ordered[MAX_FRAMES];
+    int count = 0;
+    for (auto& slot : slots) {
+        if (slot.used) {
+            ordered[count++] = &slot;
+        }
+    }
+    std::sort(ordered, ordered + count, [](const Slot* a, const Slot* b) {
+        return TimestampBefore(a->timestamp, b->timestamp);
+    });
+
+    if (independentFrames) {
+        // skip right to the newest complete frame
+        bool havePreviousEnd = haveLastEnd;
+        uint16_t previousEnd = lastEndSequence;
+        int newest = -1;
+        for (int i = 0; i < count; i++) {
+            if (IsComplete(*ordered[i], havePreviousEnd, previousEnd)) {
+                newest = i;
+            }
+            havePreviousEnd = ordered[i]->hasEnd;
+            previousEnd = ordered[i]->endSequence;
+        }
+
+        if (newest >= 0) {
+            for (int i = 0; i < newest; i++) {
+                Drop(*ordered[i]);
+            }
+            Emit(*ordered[newest], output, timestamp);
+            return true;
+        }
+
+        // nothing is complete, give up on frames we waited too long for
+        for (int i = 0; i < count; i++) {
+            if (now - ordered[i]->firstArrival > GetDelay()) {
+                Drop(*ordered[i]);
+            }
+        }
+        return false;
+    }
+
+    // every frame matters, hand them out in order
+    for (int i = 0; i < count; i++) {
+        Slot& slot = *ordered[i];
+        if (IsComplete(slot, haveLastEnd, lastEndSequence)) {
+            Emit(slot, output, timestamp);
+            return true;
+        }
+
+        if (now - slot.firstArrival <= GetDelay()) {
+            return false;
+        }
+
+        // waited too long, move on to the next frame
+        Drop(slot);
+    }
+
+    return false;
+}
+
+int64_t JitterBuffer::GetDelay() const {
+    return std::clamp(static_cast<int64_t>(jitter * JITTER_FACTOR), MIN_DELAY, MAX_DELAY);
+}
+
+uint64_t JitterBuffer::GetDropped() const {
+    return dropped;
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <array>
+
+/**
+ * Puts the RTP packets of each frame back in order, and hands out frames once
+ * they are complete.
+ *
+ * A frame that is missing packets is waited for up to an adaptive delay, based
+ * on the measured interarrival jitter, after which it is dropped. When frames
+ * don't depend on each other (MJPEG) we always skip to the newest complete frame,
+ * so a slow consumer or a lost packet never delays the frames after it.
+ */
+class JitterBuffer {
+public:
+    /**
+     * The amount of frames we can have in flight at once
+     */
+    static constexpr int MAX_FRAMES = 8;
+
+private:
+    /**
+     * A single packet of a frame, the data is stored in the frame's buffer
+     */
+    struct Packet {
+        uint16_t sequence;
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    /**
+     * A frame being assembled
+     */
+    struct Slot {
+        bool used;
+        uint32_t timestamp;
+        int64_t firstArrival;
+
+        bool hasStart;
+        uint16_t startSequence;
+        bool hasEnd;
+        uint16_t endSequence;
+
+        /**
+         * The packets sorted by sequence number, and their data
+         */
+        std::vector<Packet> packets;
+        std::vector<uint8_t> data;
+    };
+
+    std::array<Slot, MAX_FRAMES> slots;
+
+    /**
+     * Can we skip frames, or must every frame be handed out in order
+     */
+    bool independentFrames;
+
+    /**
+     * The timestamp of the last frame we handed out or dropped, anything
+     * older than that is too late
+     */
+    bool haveLast;
+    uint32_t lastTimestamp;
+
+    /**
+     * The sequence of the last packet of the last frame we handed out or
+     * dropped, the next frame starts right after it
+     */
+    bool haveLastEnd;
+    uint16_t lastEndSequence;
+
+    /**
+     * The interarrival jitter, in microseconds (RFC 3550 section 6.4.1)
+     */
+    double jitter;
+    bool haveTransit;
+    double lastTransit;
+
+    /**
+     * How many frames were dropped
+     */
+    uint64_t dropped;
+
+    Slot* FindOldest();
+    bool IsComplete(const Slot& slot, bool havePreviousEnd, uint16_t previousEnd) const;
+    void Emit(Slot& slot, std::vector<uint8_t>& output, uint32_t& timestamp);
+    void Drop(Slot& slot);
+
+public:
+
+    JitterBuffer();
+
+    /**
+     * Drop everything, and set the kind of stream we are getting
+     *
+     * @param independentFrames     [IN] Can frames be decoded on their own, so older ones can be skipped
+     */
+    void Reset(bool independentFrames);
+
+    /**
+     * Add a packet
+     *
+     * @param sequence      [IN] The RTP sequence number
+     * @param timestamp     [IN] The RTP timestamp
+     * @param marker        [IN] Is this the last packet of the frame
+     * @param frameStart    [IN] Can this packet be the first packet of the frame
+     * @param data          [IN] The depacketized data
+     * @param size          [IN] The size of the data
+     * @param arrival       [IN] When the packet arrived, in microseconds
+     */
+    void Insert(uint16_t sequence, uint32_t timestamp, bool marker, bool frameStart, const uint8_t* data, size_t size, int64_t arrival);
+
+    /**
+     * Get the next frame that is ready
+     *
+     * @param now       [IN]    The current time, in microseconds
+     * @param output    [OUT]   The data of the frame, reused between calls
+     * @param timestamp [OUT]   The RTP timestamp of the frame
+     *
+     * @return True if we got a frame
+     */
+    bool Pop(int64_t now, std::vector<uint8_t>& output, uint32_t& timestamp);
+
+    /**
+     * How long we wait for a missing packet, in microseconds
+     */
+    int64_t GetDelay() const;
+
+    /**
+     * How many frames were dropped because they were incomplete or too late
+     */
+    uint64_t GetDropped() const;
+};
@@ -0,0 +1,168 @@
+#include <PipelineThreads.hpp>
+
+#include "JpegDecodePool.hpp"
+
+JpegDecodePool::JpegDecodePool(FramePool& pool, int threads, int minSize, TaskPool* taskPool)
+    : pool(pool)
+    , minSize(minSize)
+    , jobs(threads + 1)
+    , decoders()
+    , threads()
+    , running(true)
+    , taskPool(taskPool)
+    , freeDecoders()
+    , dropped(0)
+{
+    for (int i = 0; i < threads; i++) {
+        decoders.emplace_back(new JpegDecoder());
+    }
+
+    if (taskPool != nullptr) {
+        for (int i = 0; i < threads; i++) {
+            freeDecoders.push_back(i);
+        }
+        return;
+    }
+
+    for (int i = 0; i < threads; i++) {
+        this->threads.emplace_back(&JpegDecodePool::DecodeThread, this, i);
+    }
+}
+
+JpegDecodePool::~JpegDecodePool() {
+    Stop();
+}
+
+void JpegDecodePool::Stop() {
+    {
+        std::lock_guard<std::mutex> guard{this->mutex};
+        running = false;
+    }
+    condition.notify_all();
+
+    for (auto& thread : threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+void JpegDecodePool::Submit(std::vector<uint8_t>& data, int64_t timestamp, uint64_t index) {
+    {
+        std::lock_guard<std::mutex> guard{this->mutex};
+
+        // take a free job, or replace the oldest one that is still waiting
+        Job* job = nullptr;
+        for (auto& candidate : jobs) {
+            if (candidate.decoding) {
+                continue;
+            }
+
+            if (!candidate.pending) {
+                job = &candidate;
+                break;
+            }
+
+            if (job == nullptr || candidate.index < job->index) {
+                job = &candidate;
+            }
+        }
+
+        if (job->pending) {
+            dropped++;
+        }
+
+        job->data.swap(data);
+        job->timestamp = timestamp;
+        job->index = index;
+        job->pending = true;
+    }
+
+    if (taskPool != nullptr) {
+        taskPool->Submit({ &JpegDecodePool::DecodeTask, this, timestamp });
+    } else {
+        condition.notify_one();
+    }
+}
+
+JpegDecodePool::Job* JpegDecodePool::TakeOldestJob() {
+    Job* job = nullptr;
+    for (auto& candidate : jobs) {
+        if (candidate.pending && (job == nullptr || candidate.index < job->index)) {
+            job = &candidate;
+        }
+    }
+
+    if (job != nullptr) {
+        job->pending = false;
+        job->decoding = running;
+    }
+    return job;
+}
+
+void JpegDecodePool::DecodeJob(Job& job, JpegDecoder& decoder) {
+    Frame* frame = pool.Acquire();
+    if (decoder.Decode(job.data.data(), job.data.size(), minSize, frame->image)) {
+        frame->timestamp = job.timestamp;
+        frame->index = job.index;
+        pool.Publish(frame);
+    } else {
+        pool.Discard(frame);
+    }
+}
+
+void JpegDecodePool::DecodeThread(int id) {
+    SetupPipelineThread("pmfbt-decode");
+    JpegDecoder& decoder = *decoders[id];
+
+    std::unique_lock<std::mutex> lock{this->mutex};
+    while (true) {
+        // take the oldest waiting frame, once stopped they are only dropped
+        Job* job = TakeOldestJob();
+        if (job == nullptr) {
+            if (!running) {
+                break;
+            }
+            condition.wait(lock);
+            continue;
+        }
+
+        if (!job->decoding) {
+            continue;
+        }
+
+        lock.unlock();
+        DecodeJob(*job, decoder);
+        lock.lock();
+        job->decoding = false;
+    }
+}
+
+void JpegDecodePool::DecodeTask(void* context) {
+    auto* self = static_cast<JpegDecodePool*>(context);
+
+    // a task that finds nothing to do is fine, the task that holds
+    // the decoder picks the frame up when it is done
+    std::unique_lock<std::mutex> lock{self->mutex};
+    while (self->running && !self->freeDecoders.empty()) {
+        Job* job = self->TakeOldestJob();
+        if (job == nullptr) {
+            break;
+        }
+
+        int id = self->freeDecoders.back();
+        self->freeDecoders.pop_back();
+
+        lock.unlock();
+        self->DecodeJob(*job, *self->decoders[id]);
+        lock.lock();
+
+        job->decoding = false;
+        self->freeDecoders.push_back(id);
+    }
+}
+
+uint64_t JpegDecodePool::GetDropped() {
+    std::lock_guard<std::mutex> guard{this->mutex};
+    return dropped;
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <mutex>
+
+#include <util/TaskPool.hpp>
+
+#include "FramePool.hpp"
+#include "JpegDecoder.hpp"
+
+/**
+ * Decodes JPEG frames on a few threads into a frame pool. A single frame is
+ * always decoded by a single thread, so with a slow producer only one thread
+ * works, but when frames arrive faster than one core can decode them the
+ * next frames are picked up by the other threads.
+ *
+ * Frames can finish out of order, the frame pool drops the frames that finish
+ * after a newer one was already published.
+ *
+ * With a task pool there are no threads of our own, every frame queues a task
+ * that decodes on whatever worker picks it up, with as many frames decoding at
+ * once as we have decoders.
+ */
+class JpegDecodePool {
+private:
+    /**
+     * An encoded frame waiting for, or being decoded
+     */
+    struct Job {
+        std::vector<uint8_t> data;
+        int64_t timestamp = 0;
+        uint64_t index = 0;
+        bool pending = false;
+        bool decoding = false;
+    };
+
+    FramePool& pool;
+
+    /**
+     * The minimum size of the longer side of the decoded frames
+     */
+    int minSize;
+
+    /**
+     * One job per thread being decoded, plus one waiting
+     */
+    std::vector<Job> jobs;
+
+    /**
+     * Each thread has its own decoder
+     */
+    std::vector<std::unique_ptr<JpegDecoder>> decoders;
+    std::vector<std::thread> threads;
+    bool running;
+
+    /**
+     * Runs the decoding instead of our threads when set, the
+     * decoders that no task is using
+     */
+    TaskPool* taskPool;
+    std::vector<int> freeDecoders;
+
+    /**
+     * How many waiting frames were replaced by a newer one
+     */
+    uint64_t dropped;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+
+    /**
+     * The oldest frame waiting for a decoder, called with the lock held
+     */
+    Job* TakeOldestJob();
+
+    /**
+     * Decode a job into the frame pool, called without the lock
+     */
+    void DecodeJob(Job& job, JpegDecoder& decoder);
+
+    void DecodeThread(int id);
+
+    /**
+     * Decode waiting frames as long as there are free decoders
+     */
+    static void DecodeTask(void* context);
+
+public:
+
+    /**
+     * @param pool      [IN] The pool to decode into, it needs a frame per thread
+     *                       plus two
+     * @param threads   [IN] The amount of decode threads
+     * @param minSize   [IN] The minimum size of the longer side of the decoded frames
+     * @param taskPool  [IN] Decode as tasks instead of on our own threads, the threads
+     *                       are then how many frames are decoded at once
+     */
+    JpegDecodePool(FramePool& pool, int threads, int minSize, TaskPool* taskPool = nullptr);
+    ~JpegDecodePool();
+
+    JpegDecodePool(const JpegDecodePool&) = delete;
+    JpegDecodePool& operator=(const JpegDecodePool&) = delete;
+
+    /**
+     * Queue a frame for decoding, if all the threads are busy the frame
+     * replaces the oldest frame that is still waiting.
+     *
+     * @param data      [IN/OUT]    The encoded frame, swapped with a free buffer so
+     *                              no copy is needed
+     * @param timestamp [IN]        The capture time of the frame
+     * @param index     [IN]        The index of the frame
+     */
+    void Submit(std::vector<uint8_t>& data, int64_t timestamp, uint64_t index);
+
+    /**
+     * Stop the threads, frames that are still waiting are dropped. With a task pool
+     * the pool has to be stopped before we are destroyed.
+     */
+    void Stop();
+
+    /**
+     * How many frames were dropped before decoding
+     */
+    uint64_t GetDropped();
+};
@@ -0,0 +1,157 @@
+#include <algorithm>
+
+#ifdef PMFBT_HAVE_LIBJPEG
+    #include <csetjmp>
+    #include <cstdio>
+    #include <jpeglib.h>
+#endif
+
+#include "JpegDecoder.hpp"
+
+/**
+ * The largest scale down libjpeg can do in the DCT
+ */
+constexpr int MAX_SCALE = 8;
+
+/**
+ * Pick the largest power of two scale down that keeps the longer side at least minSize
+ */
+static int PickScale(int width, int height, int minSize) {
+    int longSide = std::max(width, height);
+    int scale = 1;
+    while (scale < MAX_SCALE && longSide / (scale * 2) >= minSize) {
+        scale *= 2;
+    }
+    return scale;
+}
+
+#ifdef PMFBT_HAVE_LIBJPEG
+
+/**
+ * libjpeg reports errors by calling a function that must not return, so we
+ * jump back into Decode with the error
+ */
+struct ErrorManager {
+    jpeg_error_mgr base;
+    jmp_buf jump;
+};
+
+static void OnError(j_common_ptr info) {
+    longjmp(reinterpret_cast<ErrorManager*>(info->err)->jump, 1);
+}
+
+static void OnMessage(j_common_ptr, int) {
+    // corrupt data warnings are normal for a lossy stream
+}
+
+struct JpegDecoder::State {
+    jpeg_decompress_struct info;
+    ErrorManager error;
+};
+
+JpegDecoder::JpegDecoder()
+    : state(new State())
+{
+    state->info.err = jpeg_std_error(&state->error.base);
+    state->error.base.error_exit = OnError;
+    state->error.base.emit_message = OnMessage;
+    jpeg_create_decompress(&state->info);
+}
+
+JpegDecoder::~JpegDecoder() {
+    jpeg_destroy_decompress(&state->info);
+}
+
+bool JpegDecoder::Decode(const uint8_t* data, size_t size, int minSize, cv::Mat& output) {
+    jpeg_decompress_struct& info = state->info;
+
+    if (setjmp(state->error.jump)) {
+        jpeg_abort_decompress(&info);
+        return false;
+    }
+
+    jpeg_mem_src(&info, data, static_cast<unsigned long>(size));
+    if (jpeg_read_header(&info, TRUE) != JPEG_HEADER_OK) {
+        jpeg_abort_decompress(&info);
+        return false;
+    }
+
+    // let the DCT do the downscale, and trade a bit of quality for
+    // speed, the network won't notice
+    info.scale_num = 1;
+    info.scale_denom = PickScale(info.image_width, info.image_height, minSize);
+    info.dct_method = JDCT_IFAST;
+    info.do_fancy_upsampling = FALSE;
+#ifdef JCS_EXTENSIONS
+    info.out_color_space = JCS_EXT_BGR;
+#else
+    info.out_color_space = JCS_RGB;
+#endif
+
+    jpeg_start_decompress(&info);
+
+    output.create(info.output_height, info.output_width, CV_8UC3);
+    while (info.output_scanline < info.output_height) {
+        JSAMPROW rows[16];
+        int count = std::min<int>(16, info.output_height - info.output_scanline);
+        for (int i = 0; i < count; i++) {
+            rows[i] = output.ptr(info.output_scanline + i);
+        }
+        jpeg_read_scanlines(&info, rows, count);
+    }
+
+    jpeg_finish_decompress(&info);
+
+#ifndef JCS_EXTENSIONS
+    cv::cvtColor(output, output, cv::COLOR_RGB2BGR);
+#endif
+
+    return true;
+}
+
+#else
+
+/**
+ * Without libjpeg we let OpenCV do the scaled decode, which also
+ * uses the DCT scaling but allocates on every frame
+ */
+struct JpegDecoder::State {
+    /**
+     * The full size of the last frame, OpenCV does not tell us the size
+     * before decoding so we keep the scale from the previous frame
+     */
+    int width = 0;
+    int height = 0;
+};
+
+JpegDecoder::JpegDecoder()
+    : state(new State())
+{
+}
+
+JpegDecoder::~JpegDecoder() = default;
+
+bool JpegDecoder::Decode(const uint8_t* data, size_t size, int minSize, cv::Mat& output) {
+    cv::Mat buffer(1, static_cast<int>(size), CV_8UC1, const_cast<uint8_t*>(data));
+
+    int scale = PickScale(state->width, state->height, minSize);
+    int flags = cv::IMREAD_COLOR;
+    if (scale == 2) {
+        flags = cv::IMREAD_REDUCED_COLOR_2;
+    } else if (scale == 4) {
+        flags = cv::IMREAD_REDUCED_COLOR_4;
+    } else if (scale == 8) {
+        flags = cv::IMREAD_REDUCED_COLOR_8;
+    }
+
+    cv::imdecode(buffer, flags, &output);
+    if (output.empty()) {
+        return false;
+    }
+
+    state->width = output.cols * scale;
+    state->height = output.rows * scale;
+    return true;
+}
+
+#endif
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+
+/**
+ * Decodes JPEG frames straight to a reduced resolution, by only doing
+ * the part of the inverse DCT needed for the smaller image. Decoding at
+ * half the size costs about a quarter of a full decode.
+ */
+class JpegDecoder {
+private:
+    /**
+     * The libjpeg state, hidden so users don't need the libjpeg headers
+     */
+    struct State;
+    std::unique_ptr<State> state;
+
+public:
+
+    JpegDecoder();
+    ~JpegDecoder();
+
+    JpegDecoder(const JpegDecoder&) = delete;
+    JpegDecoder& operator=(const JpegDecoder&) = delete;
+
+    /**
+     * Decode a frame, scaled down by 1/2, 1/4 or 1/8 as long as its longer
+     * side stays at least minSize.
+     *
+     * @param data      [IN]    The JPEG data
+     * @param size      [IN]    The size of the data
+     * @param minSize   [IN]    The minimum size of the longer side of the output
+     * @param output    [OUT]   The decoded BGR image, reused between frames
+     *
+     * @return True if the frame was decoded
+     */
+    bool Decode(const uint8_t* data, size_t size, int minSize, cv::Mat& output);
+};
@@ -0,0 +1,171 @@
+#include <algorithm>
+
+#include <util/Time.hpp>
+#include <PipelineThreads.hpp>
+#include <Config.hpp>
+
+#include "NetworkSource.hpp"
+
+/**
+ * Enough kernel buffer for a few full frames, so we don't lose packets
+ * while we are busy decoding
+ */
+constexpr int RECEIVE_BUFFER_SIZE = 4 * 1024 * 1024;
+
+/**
+ * How long to wait for a packet, this also sets how often we check
+ * for incomplete frames that we waited on for too long
+ */
+constexpr int RECEIVE_TIMEOUT_MS = 2;
+
+/**
+ * The largest datagram we can get
+ */
+constexpr size_t MAX_PACKET_SIZE = 65536;
+
+/**
+ * How fast the clock offset can drift upward, in microseconds per second, this
+ * covers the difference between the sender clock and ours
+ */
+constexpr int64_t CLOCK_DRIFT = 200;
+
+NetworkSource::NetworkSource(uint16_t port, TaskPool* taskPool)
+    // a frame per decode thread, one waiting and one in the pipeline
+    : FrameSource(GetConfig().decodeThreads + 2)
+    , socket()
+    , jitterBuffer()
+    , jpegDepacketizer()
+    , h264Decoder()
+    , jpegDecodePool(pool, GetConfig().decodeThreads, GetConfig().decodeMinSize, taskPool)
+    , haveStream(false)
+    , ssrc(0)
+    , payloadType(0)
+    , haveClock(false)
+    , extendedTimestamp(0)
+    , clockOffset(0)
+    , lastClockUpdate(0)
+    , packet(MAX_PACKET_SIZE)
+    , depacketized(MAX_PACKET_SIZE * 2 + 1024)
+    , encoded()
+    , thread()
+    , running(true)
+{
+    if (!socket.Bind(port, RECEIVE_BUFFER_SIZE)) {
+        pool.Close();
+        return;
+    }
+
+    thread = std::thread(&NetworkSource::ReceiveThread, this);
+}
+
+NetworkSource::~NetworkSource() {
+    running = false;
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+void NetworkSource::ReceiveThread() {
+    SetupPipelineThread("pmfbt-receive");
+    uint64_t index = 0;
+
+    while (running) {
+        int size = socket.Receive(packet.data(), packet.size(), RECEIVE_TIMEOUT_MS);
+        int64_t now = GetMicroseconds();
+        if (size < 0) {
+            break;
+        }
+
+        if (size > 0) {
+            HandlePacket(size, now);
+        }
+
+        // decode whatever is ready
+        uint32_t timestamp;
+        while (jitterBuffer.Pop(now, encoded, timestamp)) {
+            Decode(timestamp, index++);
+        }
+    }
+
+    pool.Close();
+}
+
+void NetworkSource::HandlePacket(size_t size, int64_t arrival) {
+    RtpHeader header {};
+    size_t payloadSize = 0;
+    int offset = ParseRtpHeader(packet.data(), size, header, payloadSize);
+    if (offset < 0) {
+        return;
+    }
+
+    // a new stream, the phone app restarted or changed the codec
+    if (!haveStream || header.ssrc != ssrc || header.payloadType != payloadType) {
+        haveStream = true;
+        ssrc = header.ssrc;
+        payloadType = header.payloadType;
+        haveClock = false;
+
+        // jpeg frames don't depend on each other, so we can skip frames freely
+        jitterBuffer.Reset(payloadType == RTP_PAYLOAD_JPEG);
+    }
+
+    bool frameStart = false;
+    int length;
+    if (payloadType == RTP_PAYLOAD_JPEG) {
+        length = jpegDepacketizer.Depacketize(packet.data() + offset, payloadSize, header.marker, depacketized.data(), frameStart);
+    } else {
+        length = DepacketizeH264(packet.data() + offset, payloadSize, depacketized.data(), frameStart);
+    }
+
+    if (length < 0) {
+        return;
+    }
+
+    UpdateClock(header.timestamp, arrival);
+    jitterBuffer.Insert(header.sequence, header.timestamp, header.marker, frameStart, depacketized.data(), length, arrival);
+}
+
+void NetworkSource::UpdateClock(uint32_t timestamp, int64_t arrival) {
+    // extend the timestamp to 64bit so it never wraps
+    if (!haveClock) {
+        extendedTimestamp = timestamp;
+    } else {
+        extendedTimestamp += static_cast<int32_t>(timestamp - static_cast<uint32_t>(extendedTimestamp));
+    }
+
+    int64_t media = extendedTimestamp * 1000000 / RTP_CLOCK_RATE;
+    int64_t offset = arrival - media;
+
+    if (!haveClock) {
+        clockOffset = offset;
+    } else {
+        // allow the offset to slowly move up, otherwise take the smallest one
+        int64_t drifted = clockOffset + (arrival - lastClockUpdate) * CLOCK_DRIFT / 1000000;
+        clockOffset = std::min(offset, drifted);
+    }
+
+    lastClockUpdate = arrival;
+    haveClock = true;
+}
+
+int64_t NetworkSource::RecoverTimestamp(uint32_t timestamp) const {
+    int64_t extended = extendedTimestamp + static_cast<int32_t>(timestamp - static_cast<uint32_t>(extendedTimestamp));
+    return extended * 1000000 / RTP_CLOCK_RATE + clockOffset;
+}
+
+void NetworkSource::Decode(uint32_t timestamp, uint64_t index) {
+    if (payloadType == RTP_PAYLOAD_JPEG) {
+        jpegDecodePool.Submit(encoded, RecoverTimestamp(timestamp), index);
+        return;
+    }
+
+    Frame* frame = pool.Acquire();
+    if (!h264Decoder.Decode(encoded.data(), encoded.size(), frame->image)) {
+        pool.Discard(frame);
+        return;
+    }
+
+    frame->timestamp = RecoverTimestamp(timestamp);
+    frame->index = index;
+    pool.Publish(frame);
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <net/UdpSocket.hpp>
+
+#include "FrameSource.hpp"
+#include "JitterBuffer.hpp"
+#include "RtpPayload.hpp"
+#include "H264Decoder.hpp"
+#include "JpegDecodePool.hpp"
+
+/**
+ * Receives frames streamed from a phone over RTP, either as MJPEG (RFC 2435)
+ * or H.264 (RFC 6184), the payload type is detected from the stream.
+ */
+class NetworkSource final : public FrameSource {
+private:
+    UdpSocket socket;
+
+    /**
+     * Put the packets back into frames
+     */
+    JitterBuffer jitterBuffer;
+    JpegDepacketizer jpegDepacketizer;
+    H264Decoder h264Decoder;
+
+    /**
+     * JPEG frames are decoded on their own threads, H.264 frames depend on
+     * each other so they are decoded on the receive thread
+     */
+    JpegDecodePool jpegDecodePool;
+
+    /**
+     * The stream we are currently receiving, if the phone restarts
+     * the stream we start over
+     */
+    bool haveStream;
+    uint32_t ssrc;
+    uint8_t payloadType;
+
+    /**
+     * Maps the RTP timestamps of the sender to our clock, we track the smallest
+     * offset between the two which is the frame that had the least delay in the
+     * network, and let it drift slowly to follow the clock of the sender.
+     */
+    bool haveClock;
+    int64_t extendedTimestamp;
+    int64_t clockOffset;
+    int64_t lastClockUpdate;
+
+    /**
+     * Buffers for the packet, its depacketized data and a whole
+     * encoded frame, these are reused for every packet
+     */
+    std::vector<uint8_t> packet;
+    std::vector<uint8_t> depacketized;
+    std::vector<uint8_t> encoded;
+
+    /**
+     * The thread receiving the frames
+     */
+    std::thread thread;
+    std::atomic<bool> running;
+
+    void ReceiveThread();
+    void HandlePacket(size_t size, int64_t arrival);
+    void UpdateClock(uint32_t timestamp, int64_t arrival);
+    int64_t RecoverTimestamp(uint32_t timestamp) const;
+    void Decode(uint32_t timestamp, uint64_t index);
+
+public:
+
+    /**
+     * @param port      [IN] The UDP port the phone streams to
+     * @param taskPool  [IN] Decode JPEG on the task pool instead of our own threads, can be null
+     */
+    explicit NetworkSource(uint16_t port, TaskPool* taskPool = nullptr);
+    ~NetworkSource() override;
+};
@@ -0,0 +1,413 @@
+#include <cstring>
+
+#include "RtpPayload.hpp"
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// RTP
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int ParseRtpHeader(const uint8_t* packet, size_t size, RtpHeader& header, size_t& payloadSize) {
+    if (size < RTP_HEADER_SIZE || (packet[0] >> 6) != 2) {
+        return -1;
+    }
+
+    bool padding = (packet[0] & 0x20) != 0;
+    bool extension = (packet[0] & 0x10) != 0;
+    size_t csrcCount = packet[0] & 0x0f;
+
+    header.marker = (packet[1] & 0x80) != 0;
+    header.payloadType = packet[1] & 0x7f;
+    header.sequence = static_cast<uint16_t>((packet[2] << 8) | packet[3]);
+    header.timestamp = (static_cast<uint32_t>(packet[4]) << 24) | (packet[5] << 16) | (packet[6] << 8) | packet[7];
+    header.ssrc = (static_cast<uint32_t>(packet[8]) << 24) | (packet[9] << 16) | (packet[10] << 8) | packet[11];
+
+    size_t offset = RTP_HEADER_SIZE + csrcCount * 4;
+    if (extension) {
+        if (offset + 4 > size) {
+            return -1;
+        }
+        offset += 4 + ((packet[offset + 2] << 8) | packet[offset + 3]) * 4;
+    }
+
+    if (offset > size) {
+        return -1;
+    }
+
+    // the last byte counts itself too, so a count of zero or one that
+    // reaches into the header can only come from a broken packet
+    size_t end = size;
+    if (padding) {
+        size_t count = packet[size - 1];
+        if (count == 0 || count > size - offset) {
+            return -1;
+        }
+        end -= count;
+    }
+
+    payloadSize = end - offset;
+    return static_cast<int>(offset);
+}
+
+size_t WriteRtpHeader(uint8_t* packet, const RtpHeader& header) {
+    packet[0] = 2 << 6;
+    packet[1] = (header.marker ? 0x80 : 0) | (header.payloadType & 0x7f);
+    packet[2] = header.sequence >> 8;
+    packet[3] = header.sequence & 0xff;
+    packet[4] = header.timestamp >> 24;
+    packet[5] = (header.timestamp >> 16) & 0xff;
+    packet[6] = (header.timestamp >> 8) & 0xff;
+    packet[7] = header.timestamp & 0xff;
+    packet[8] = header.ssrc >> 24;
+    packet[9] = (header.ssrc >> 16) & 0xff;
+    packet[10] = (header.ssrc >> 8) & 0xff;
+    packet[11] = header.ssrc & 0xff;
+    return RTP_HEADER_SIZE;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// JPEG (RFC 2435)
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * The size of the main JPEG header, and of the optional ones
+ */
+constexpr size_t JPEG_HEADER_SIZE = 8;
+constexpr size_t RESTART_HEADER_SIZE = 4;
+constexpr size_t QUANT_HEADER_SIZE = 4;
+
+/**
+ * The standard quantization tables from the JPEG spec (in natural order), these are
+ * scaled by the Q value when the tables are not sent in-band
+ */
+static const uint8_t LUMA_QUANTIZER[64] = {
+    16, 11, 10, 16, 24, 40, 51, 61,
+    12, 12, 14, 19, 26, 58, 60, 55,
+    14, 13, 16, 24, 40, 57, 69, 56,
+    14, 17, 22, 29, 51, 87, 80, 62,
+    18, 22, 37, 56, 68, 109, 103, 77,
+    24, 35, 55, 64, 81, 104, 113, 92,
+    49, 64, 78, 87, 103, 121, 120, 101,
+    72, 92, 95, 98, 112, 100, 103, 99,
+};
+
+static const uint8_t CHROMA_QUANTIZER[64] = {
+    17, 18, 24, 47, 99, 99, 99, 99,
+    18, 21, 26, 66, 99, 99, 99, 99,
+    24, 26, 56, 99, 99, 99, 99, 99,
+    47, 66, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+};
+
+/**
+ * The natural index of each coefficient in zigzag order
+ */
+static const uint8_t ZIGZAG[64] = {
+    0, 1, 8, 16, 9, 2, 3, 10,
+    17, 24, 32, 25, 18, 11, 4, 5,
+    12, 19, 26, 33, 40, 48, 41, 34,
+    27, 20, 13, 6, 7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36,
+    29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46,
+    53, 60, 61, 54, 47, 55, 62, 63,
+};
+
+/**
+ * The standard huffman tables, RFC 2435 payloads always use these
+ */
+static const uint8_t LUMA_DC_CODELENS[16] = { 0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0 };
+static const uint8_t LUMA_DC_SYMBOLS[12] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+static const uint8_t LUMA_AC_CODELENS[16] = { 0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d };
+static const uint8_t LUMA_AC_SYMBOLS[162] = {
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12,
+    0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+    0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08,
+    0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+    0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16,
+    0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39,
+    0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+    0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59,
+    0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+    0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79,
+    0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+    0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98,
+    0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+    0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6,
+    0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+    0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4,
+    0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+    0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea,
+    0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa,
+};
+static const uint8_t CHROMA_DC_CODELENS[16] = { 0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0 };
+static const uint8_t CHROMA_DC_SYMBOLS[12] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+static const uint8_t CHROMA_AC_CODELENS[16] = { 0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77 };
+static const uint8_t CHROMA_AC_SYMBOLS[162] = {
+    0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21,
+    0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+    0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91,
+    0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+    0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34,
+    0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+    0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38,
+    0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+    0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58,
+    0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+    0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78,
+    0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96,
+    0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5,
+    0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4,
+    0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+    0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2,
+    0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+    0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9,
+    0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa,
+};
+
+/**
+ * Build the quantization tables (in zigzag order) for a Q value below 128
+ */
+static void MakeTables(int q, uint8_t* tables) {
+    int factor = q < 1 ? 1 : (q > 99 ? 99 : q);
+    int scale = factor < 50 ? 5000 / factor : 200 - factor * 2;
+
+    for (int i = 0; i < 64; i++) {
+        int luma = (LUMA_QUANTIZER[ZIGZAG[i]] * scale + 50) / 100;
+        int chroma = (CHROMA_QUANTIZER[ZIGZAG[i]] * scale + 50) / 100;
+        tables[i] = static_cast<uint8_t>(luma < 1 ? 1 : (luma > 255 ? 255 : luma));
+        tables[i + 64] = static_cast<uint8_t>(chroma < 1 ? 1 : (chroma > 255 ? 255 : chroma));
+    }
+}
+
+static uint8_t* WriteQuantTable(uint8_t* p, const uint8_t* table, int index) {
+    *p++ = 0xff; *p++ = 0xdb;
+    *p++ = 0; *p++ = 67;
+    *p++ = static_cast<uint8_t>(index);
+    std::memcpy(p, table, 64);
+    return p + 64;
+}
+
+static uint8_t* WriteHuffmanTable(uint8_t* p, const uint8_t* codelens, const uint8_t* symbols, size_t symbolCount, int index, int tableClass) {
+    *p++ = 0xff; *p++ = 0xc4;
+    *p++ = 0; *p++ = static_cast<uint8_t>(3 + 16 + symbolCount);
+    *p++ = static_cast<uint8_t>((tableClass << 4) | index);
+    std::memcpy(p, codelens, 16);
+    p += 16;
+    std::memcpy(p, symbols, symbolCount);
+    return p + symbolCount;
+}
+
+/**
+ * Write the JPEG headers, this follows appendix B of the RFC
+ */
+static size_t WriteJpegHeaders(uint8_t* start, int type, int width, int height, const uint8_t* tables, uint16_t restartInterval) {
+    uint8_t* p = start;
+
+    // SOI
+    *p++ = 0xff; *p++ = 0xd8;
+
+    p = WriteQuantTable(p, tables, 0);
+    p = WriteQuantTable(p, tables + 64, 1);
+
+    // DRI
+    if (restartInterval != 0) {
+        *p++ = 0xff; *p++ = 0xdd;
+        *p++ = 0; *p++ = 4;
+        *p++ = restartInterval >> 8;
+        *p++ = restartInterval & 0xff;
+    }
+
+    // SOF0
+    *p++ = 0xff; *p++ = 0xc0;
+    *p++ = 0; *p++ = 17;
+    *p++ = 8;
+    *p++ = height >> 8; *p++ = height & 0xff;
+    *p++ = width >> 8; *p++ = width & 0xff;
+    *p++ = 3;
+    *p++ = 0; *p++ = (type & 0x3f) == 0 ? 0x21 : 0x22; *p++ = 0;
+    *p++ = 1; *p++ = 0x11; *p++ = 1;
+    *p++ = 2; *p++ = 0x11; *p++ = 1;
+
+    p = WriteHuffmanTable(p, LUMA_DC_CODELENS, LUMA_DC_SYMBOLS, sizeof(LUMA_DC_SYMBOLS), 0, 0);
+    p = WriteHuffmanTable(p, LUMA_AC_CODELENS, LUMA_AC_SYMBOLS, sizeof(LUMA_AC_SYMBOLS), 0, 1);
+    p = WriteHuffmanTable(p, CHROMA_DC_CODELENS, CHROMA_DC_SYMBOLS, sizeof(CHROMA_DC_SYMBOLS), 1, 0);
+    p = WriteHuffmanTable(p, CHROMA_AC_CODELENS, CHROMA_AC_SYMBOLS, sizeof(CHROMA_AC_SYMBOLS), 1, 1);
+
+    // SOS
+    *p++ = 0xff; *p++ = 0xda;
+    *p++ = 0; *p++ = 12;
+    *p++ = 3;
+    *p++ = 0; *p++ = 0;
+    *p++ = 1; *p++ = 0x11;
+    *p++ = 2; *p++ = 0x11;
+    *p++ = 0; *p++ = 63; *p++ = 0;
+
+    return p - start;
+}
+
+JpegDepacketizer::JpegDepacketizer()
+    : cachedTables()
+    , cachedQ(-1)
+{
+}
+
+int JpegDepacketizer::Depacketize(const uint8_t* payload, size_t size, bool marker, uint8_t* output, bool& frameStart) {
+    if (size < JPEG_HEADER_SIZE) {
+        return -1;
+    }
+
+    uint32_t fragmentOffset = (payload[1] << 16) | (payload[2] << 8) | payload[3];
+    int type = payload[4];
+    int q = payload[5];
+    int width = payload[6] * 8;
+    int height = payload[7] * 8;
+    size_t offset = JPEG_HEADER_SIZE;
+
+    // we only support the two baseline types, with and without restart markers
+    if ((type & 0x3f) > 1 || type >= 128) {
+        return -1;
+    }
+
+    uint16_t restartInterval = 0;
+    if (type >= 64) {
+        if (size < offset + RESTART_HEADER_SIZE) {
+            return -1;
+        }
+        restartInterval = static_cast<uint16_t>((payload[offset] << 8) | payload[offset + 1]);
+        offset += RESTART_HEADER_SIZE;
+    }
+
+    uint8_t* p = output;
+    frameStart = fragmentOffset == 0;
+    if (frameStart) {
+        uint8_t tables[128];
+
+        if (q >= 128) {
+            // the tables are in-band
+            if (size < offset + QUANT_HEADER_SIZE) {
+                return -1;
+            }
+
+            int precision = payload[offset + 1];
+            size_t length = (payload[offset + 2] << 8) | payload[offset + 3];
+            offset += QUANT_HEADER_SIZE;
+
+            if (length == 0 && cachedQ == q) {
+                // the sender expects us to remember them
+                std::memcpy(tables, cachedTables, sizeof(tables));
+            } else if (length == 128 && precision == 0 && size >= offset + length) {
+                std::memcpy(tables, payload + offset, sizeof(tables));
+                std::memcpy(cachedTables, tables, sizeof(tables));
+                cachedQ = q;
+                offset += length;
+            } else {
+                // 16 bit tables or tables we never got
+                return -1;
+            }
+        } else {
+            MakeTables(q, tables);
+        }
+
+        p += WriteJpegHeaders(p, type, width, height, tables, restartInterval);
+    }
+
+    // the scan data is just copied as is
+    std::memcpy(p, payload + offset, size - offset);
+    p += size - offset;
+
+    // EOI
+    if (marker) {
+        *p++ = 0xff;
+        *p++ = 0xd9;
+    }
+
+    return static_cast<int>(p - output);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// H.264 (RFC 6184)
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+constexpr uint8_t NAL_STAP_A = 24;
+constexpr uint8_t NAL_FU_A = 28;
+
+/**
+ * Does a NAL unit start a new picture, that is any of the non-VCL units that come
+ * before the slices, or the first slice of the picture (first_mb_in_slice is zero,
+ * which is coded as a single set bit)
+ */
+static bool StartsPicture(uint8_t type, const uint8_t* body, size_t size) {
+    if (type >= 6 && type <= 9) {
+        return true;
+    }
+
+    return (type == 1 || type == 5) && size > 0 && (body[0] & 0x80) != 0;
+}
+
+static uint8_t* WriteStartCode(uint8_t* p) {
+    *p++ = 0; *p++ = 0; *p++ = 0; *p++ = 1;
+    return p;
+}
+
+int DepacketizeH264(const uint8_t* payload, size_t size, uint8_t* output, bool& frameStart) {
+    if (size < 1) {
+        return -1;
+    }
+
+    uint8_t* p = output;
+    uint8_t type = payload[0] & 0x1f;
+    frameStart = false;
+
+    if (type >= 1 && type <= 23) {
+        // a single NAL unit
+        frameStart = StartsPicture(type, payload + 1, size - 1);
+        p = WriteStartCode(p);
+        std::memcpy(p, payload, size);
+        p += size;
+    } else if (type == NAL_STAP_A) {
+        // a few NAL units, each prefixed with its size
+        size_t offset = 1;
+        while (offset + 2 <= size) {
+            size_t length = (payload[offset] << 8) | payload[offset + 1];
+            offset += 2;
+            if (length == 0 || offset + length > size) {
+                break;
+            }
+
+            if (offset == 3) {
+                frameStart = StartsPicture(payload[offset] & 0x1f, payload + offset + 1, length - 1);
+            }
+
+            p = WriteStartCode(p);
+            std::memcpy(p, payload + offset, length);
+            p += length;
+            offset += length;
+        }
+    } else if (type == NAL_FU_A) {
+        // a fragment of a NAL unit, the first fragment also has the NAL header
+        if (size < 2) {
+            return -1;
+        }
+
+        bool start = (payload[1] & 0x80) != 0;
+        if (start) {
+            frameStart = StartsPicture(payload[1] & 0x1f, payload + 2, size - 2);
+            p = WriteStartCode(p);
+            *p++ = (payload[0] & 0xe0) | (payload[1] & 0x1f);
+        }
+
+        std::memcpy(p, payload + 2, size - 2);
+        p += size - 2;
+    } else {
+        return -1;
+    }
+
+    return static_cast<int>(p - output);
+}
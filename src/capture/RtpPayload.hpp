@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * The static payload type of JPEG (RFC 2435)
+ */
+constexpr uint8_t RTP_PAYLOAD_JPEG = 26;
+
+/**
+ * The dynamic payload type we use for H.264 (RFC 6184)
+ */
+constexpr uint8_t RTP_PAYLOAD_H264 = 96;
+
+/**
+ * The clock rate of the RTP timestamps of video payloads
+ */
+constexpr uint32_t RTP_CLOCK_RATE = 90000;
+
+/**
+ * The size of the fixed RTP header
+ */
+constexpr size_t RTP_HEADER_SIZE = 12;
+
+/**
+ * The fields of the RTP header that we care about
+ */
+struct RtpHeader {
+    uint8_t payloadType;
+    bool marker;
+    uint16_t sequence;
+    uint32_t timestamp;
+    uint32_t ssrc;
+};
+
+/**
+ * Parse the header of an RTP packet
+ *
+ * @param packet        [IN]    The packet
+ * @param size          [IN]    The size of the packet
+ * @param header        [OUT]   The parsed header
+ * @param payloadSize   [OUT]   The size of the payload, without padding
+ *
+ * @return The offset of the payload in the packet, or -1 if the packet is invalid
+ */
+int ParseRtpHeader(const uint8_t* packet, size_t size, RtpHeader& header, size_t& payloadSize);
+
+/**
+ * Write the fixed RTP header, without any CSRC or extensions
+ *
+ * @return The size of the header
+ */
+size_t WriteRtpHeader(uint8_t* packet, const RtpHeader& header);
+
+/**
+ * Turns JPEG payloads (RFC 2435) back into a plain JPEG file, every packet
+ * is converted on its own so the packets of a frame just need to be put
+ * together in order.
+ */
+class JpegDepacketizer {
+private:
+    /**
+     * The last in-band quantization tables, the sender may only send them
+     * once for a given Q value
+     */
+    uint8_t cachedTables[128];
+    int cachedQ;
+
+public:
+
+    JpegDepacketizer();
+
+    /**
+     * Convert a single packet
+     *
+     * @param payload       [IN]    The RTP payload
+     * @param size          [IN]    The size of the payload
+     * @param marker        [IN]    Is this the last packet of the frame
+     * @param output        [OUT]   Where to write the JPEG data, must have room for the payload + 1024 bytes
+     * @param frameStart    [OUT]   Is this the first packet of the frame
+     *
+     * @return The amount of bytes written, or -1 if the payload is not supported
+     */
+    int Depacketize(const uint8_t* payload, size_t size, bool marker, uint8_t* output, bool& frameStart);
+};
+
+/**
+ * Turn an H.264 payload (RFC 6184) into an Annex B byte stream, supports
+ * single NAL units, STAP-A and FU-A packets.
+ *
+ * @param payload       [IN]    The RTP payload
+ * @param size          [IN]    The size of the payload
+ * @param output        [OUT]   Where to write the stream, must have room for twice the payload
+ * @param frameStart    [OUT]   Does this packet start a new picture
+ *
+ * @return The amount of bytes written, or -1 if the payload is not supported
+ */
+int DepacketizeH264(const uint8_t* payload, size_t size, uint8_t* output, bool& frameStart);
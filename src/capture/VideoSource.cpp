@@ -0,0 +1,59 @@
+#include <util/Time.hpp>
+#include <PipelineThreads.hpp>
+
+#include "VideoSource.hpp"
+
+/**
+ * The rate to play at when the file does not say
+ */
+constexpr double DEFAULT_FRAME_RATE = 30.0;
+
+VideoSource::VideoSource(const std::string& path)
+    // one being read, one waiting and one in the pipeline
+    : FrameSource(3)
+    , capture(path)
+    , frameDuration(0)
+    , thread()
+    , running(true)
+{
+    double frameRate = capture.get(cv::CAP_PROP_FPS);
+    if (frameRate <= 0) {
+        frameRate = DEFAULT_FRAME_RATE;
+    }
+    frameDuration = static_cast<int64_t>(1000000.0 / frameRate);
+
+    thread = std::thread(&VideoSource::PlaybackThread, this);
+}
+
+VideoSource::~VideoSource() {
+    running = false;
+    thread.join();
+}
+
+bool VideoSource::IsOpened() {
+    return capture.isOpened();
+}
+
+void VideoSource::PlaybackThread() {
+    SetupPipelineThread("pmfbt-video");
+    uint64_t index = 0;
+    int64_t start = GetMicroseconds();
+
+    while (running && capture.isOpened()) {
+        // come out at the rate of the file, like a camera would
+        int64_t due = start + static_cast<int64_t>(index) * frameDuration;
+        std::this_thread::sleep_for(std::chrono::microseconds(due - GetMicroseconds()));
+
+        Frame* frame = pool.Acquire();
+        if (!capture.read(frame->image)) {
+            pool.Discard(frame);
+            break;
+        }
+
+        frame->timestamp = GetMicroseconds();
+        frame->index = index++;
+        pool.Publish(frame);
+    }
+
+    pool.Close();
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "FrameSource.hpp"
+
+/**
+ * Plays a recorded video as if it came from a camera, at the frame rate of
+ * the file, so the pipeline can run on the same frames again and again. The
+ * source stops at the end of the file.
+ */
+class VideoSource final : public FrameSource {
+private:
+    cv::VideoCapture capture;
+
+    /**
+     * How long a frame of the file lasts, in microseconds
+     */
+    int64_t frameDuration;
+
+    /**
+     * The thread reading from the file
+     */
+    std::thread thread;
+    std::atomic<bool> running;
+
+    void PlaybackThread();
+
+public:
+
+    /**
+     * @param path  [IN] Any video OpenCV can open
+     */
+    explicit VideoSource(const std::string& path);
+    ~VideoSource() override;
+
+    /**
+     * Could the file be opened, if not the source stops right away
+     */
+    bool IsOpened();
+};
@@ -0,0 +1,146 @@
+#include <cstring>
+
+#include "PoseChannel.hpp"
+
+/**
+ * How many times to retry a read that raced with the writer, the writer
+ * only holds a slot for a copy so this basically never runs out
+ */
+constexpr int MAX_READ_ATTEMPTS = 8;
+
+/**
+ * Copy a frame out of the feed
+ */
+static bool ReadFrame(const PoseFeedLayout* layout, uint64_t index, PoseFeedFrame& frame) {
+    uint64_t sequence;
+    const PoseFeedFrame* source = PoseFeedBeginRead(layout, index, sequence);
+    if (source == nullptr) {
+        return false;
+    }
+
+    std::memcpy(&frame, source, sizeof(frame));
+    return PoseFeedEndRead(layout, index, sequence);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Writer
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+PoseWriter::PoseWriter()
+    : memory()
+    , layout(nullptr)
+{
+}
+
+bool PoseWriter::Open(const char* name) {
+    if (!memory.Open(name, sizeof(PoseFeedLayout))) {
+        return false;
+    }
+
+    layout = static_cast<PoseFeedLayout*>(memory.GetData());
+
+    // a new feed, describe it before the readers can see it
+    if (layout->header.magic.load(std::memory_order_relaxed) != POSE_FEED_MAGIC) {
+        layout->header.version = POSE_FEED_VERSION;
+        layout->header.slotCount = POSE_FEED_SLOTS;
+        layout->header.frameSize = sizeof(PoseFeedFrame);
+        layout->header.magic.store(POSE_FEED_MAGIC, std::memory_order_release);
+    }
+
+    return true;
+}
+
+void PoseWriter::Publish(const PoseFeedFrame& frame) {
+    uint64_t index = layout->header.written.load(std::memory_order_relaxed);
+    PoseFeedSlot& slot = layout->slots[index % POSE_FEED_SLOTS];
+
+    // mark the slot as being written before touching the frame
+    slot.sequence.store(index * 2 + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    std::memcpy(&slot.frame, &frame, sizeof(frame));
+
+    // publish the frame
+    slot.sequence.store(index * 2 + 2, std::memory_order_release);
+    layout->header.written.store(index + 1, std::memory_order_release);
+}
+
+void PoseWriter::SetScheduling(uint32_t scheduling, int32_t priority, uint64_t cpuMask) {
+    layout->header.scheduling.store(scheduling, std::memory_order_relaxed);
+    layout->header.priority.store(priority, std::memory_order_relaxed);
+    layout->header.cpuMask.store(cpuMask, std::memory_order_relaxed);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Reader
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+PoseReader::PoseReader()
+    : memory()
+    , layout(nullptr)
+    , lastWritten(0)
+{
+}
+
+bool PoseReader::Open(const char* name) {
+    if (!memory.Open(name, sizeof(PoseFeedLayout))) {
+        return false;
+    }
+
+    layout = static_cast<const PoseFeedLayout*>(memory.GetData());
+    lastWritten = PoseFeedWritten(layout);
+    return true;
+}
+
+bool PoseReader::IsOpen() const {
+    return layout != nullptr;
+}
+
+bool PoseReader::ReadLatest(PoseFeedFrame& frame) {
+    if (!PoseFeedIsValid(layout)) {
+        return false;
+    }
+
+    for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++) {
+        uint64_t written = PoseFeedWritten(layout);
+        if (written == lastWritten || written == 0) {
+            return false;
+        }
+
+        if (ReadFrame(layout, written - 1, frame)) {
+            lastWritten = written;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool PoseReader::ReadNext(PoseFeedFrame& frame, uint64_t& lost) {
+    lost = 0;
+    if (!PoseFeedIsValid(layout)) {
+        return false;
+    }
+
+    for (int attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++) {
+        uint64_t written = PoseFeedWritten(layout);
+        if (written == lastWritten) {
+            return false;
+        }
+
+        // skip whatever the writer already overwrote, keeping a slot
+        // of margin from the one it writes next
+        uint64_t oldest = written > POSE_FEED_SLOTS - 1 ? written - (POSE_FEED_SLOTS - 1) : 0;
+        if (lastWritten < oldest) {
+            lost += oldest - lastWritten;
+            lastWritten = oldest;
+        }
+
+        if (ReadFrame(layout, lastWritten, frame)) {
+            lastWritten++;
+            return true;
+        }
+    }
+
+    return false;
+}
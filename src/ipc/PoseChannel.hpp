@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+
+#include <Config.hpp>
+
+#include "SharedMemory.hpp"
+#include "PoseFeed.hpp"
+
+static_assert(POSE_FEED_MAX_PERSONS == MAX_PERSONS, "The feed must fit all the people we track");
+
+/**
+ * The tracking service side of the pose feed, there must only
+ * be a single writer at a time
+ */
+class PoseWriter {
+private:
+    SharedMemory memory;
+    PoseFeedLayout* layout;
+
+public:
+
+    PoseWriter();
+
+    /**
+     * Open the feed, a restarted writer continues after the
+     * last frame of the previous one
+     *
+     * @param name  [IN] The name of the feed, other cameras have their own
+     */
+    bool Open(const char* name = POSE_FEED_NAME);
+
+    /**
+     * Publish a new frame, this never waits for the readers
+     */
+    void Publish(const PoseFeedFrame& frame);
+
+    /**
+     * Tell the readers how the capture thread is scheduled
+     *
+     * @param scheduling    [IN] One of the POSE_FEED_SCHEDULING values
+     * @param priority      [IN] The real time priority or the nice value
+     * @param cpuMask       [IN] The CPUs the thread is pinned to, zero if none
+     */
+    void SetScheduling(uint32_t scheduling, int32_t priority, uint64_t cpuMask);
+};
+
+/**
+ * Reads the pose feed, any number of readers can read at the
+ * same time without slowing down the writer
+ */
+class PoseReader {
+private:
+    SharedMemory memory;
+    const PoseFeedLayout* layout;
+
+    /**
+     * The amount of written frames when we last read
+     */
+    uint64_t lastWritten;
+
+public:
+
+    PoseReader();
+
+    /**
+     * Open the feed, this works even if the service is not running yet
+     *
+     * @param name  [IN] The name of the feed, other cameras have their own
+     */
+    bool Open(const char* name = POSE_FEED_NAME);
+
+    bool IsOpen() const;
+
+    /**
+     * Read the newest frame, if there is one we did not read yet
+     *
+     * @param frame [OUT] The frame
+     *
+     * @return True if there was a new frame
+     */
+    bool ReadLatest(PoseFeedFrame& frame);
+
+    /**
+     * Read the frame after the one we read last, for readers that need every frame
+     *
+     * @param frame [OUT] The frame
+     * @param lost  [OUT] How many frames were overwritten before we got to them
+     *
+     * @return True if there was a new frame
+     */
+    bool ReadNext(PoseFeedFrame& frame, uint64_t& lost);
+};
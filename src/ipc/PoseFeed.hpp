@@ -0,0 +1,213 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * The layout of the pose feed, the shared memory the tracking service publishes
+ * every frame in. It is meant to be read by anything that wants the poses, the
+ * driver, overlays, recorders, so this header does not depend on anything else
+ * in the project and can be copied as is.
+ *
+ * The feed is a ring of frames, each guarded by a sequence lock. There is a single
+ * writer, which never waits, and any number of readers, which never write. A reader
+ * reads a frame in place and then checks that the writer did not touch it while it
+ * was reading, if it did the read is thrown away and retried.
+ *
+ * To open the feed map the shared memory named POSE_FEED_NAME (/dev/shm on linux,
+ * Local\ on windows) with the size of PoseFeedLayout, and check PoseFeedIsValid.
+ * With more than one camera every camera has a feed of its own, the first one is
+ * POSE_FEED_NAME and the others have "-1", "-2" and so on appended to it.
+ *
+ * All times are in microseconds of the monotonic clock of the machine
+ * (CLOCK_MONOTONIC on linux, QueryPerformanceCounter on windows).
+ */
+
+/**
+ * The name of the shared memory, it includes the version so different
+ * versions never share the same memory
+ */
+constexpr const char* POSE_FEED_NAME = "pmfbt-poses-v1";
+
+/**
+ * "PMFB", set once the writer initialized the feed
+ */
+constexpr uint32_t POSE_FEED_MAGIC = 0x42464D50;
+
+/**
+ * Changed whenever the layout changes
+ */
+constexpr uint32_t POSE_FEED_VERSION = 1;
+
+/**
+ * How many frames the ring holds, a reader that falls behind
+ * by more than that loses the older frames
+ */
+constexpr uint32_t POSE_FEED_SLOTS = 16;
+
+/**
+ * The most people in a single frame
+ */
+constexpr uint32_t POSE_FEED_MAX_PERSONS = 4;
+
+/**
+ * The joints of a person, in order: head, collarbone, tailbone, right shoulder,
+ * left shoulder, right hip, left hip, right elbow, left elbow, right knee, left knee,
+ * right wrist, left wrist, right ankle, left ankle
+ */
+constexpr uint32_t POSE_FEED_JOINTS = 15;
+
+struct PoseFeedVector {
+    float x, y, z;
+};
+
+/**
+ * A single person in a frame
+ */
+struct PoseFeedPerson {
+    /**
+     * The id of the person, it stays the same for as long as we track them,
+     * zero if there is nobody in this slot
+     */
+    uint32_t id;
+
+    /**
+     * Was the person seen in this frame, if not the joints are not valid
+     */
+    uint32_t active;
+
+    /**
+     * The confidence of the network in the whole pose
+     */
+    float score;
+
+    /**
+     * The confidence of the network in every joint, from 0 to 1,
+     * zero if the joint was not found
+     */
+    float confidences[POSE_FEED_JOINTS];
+
+    /**
+     * The 3d position of every joint
+     */
+    PoseFeedVector joints[POSE_FEED_JOINTS];
+};
+
+/**
+ * Everything found in a single camera frame
+ */
+struct PoseFeedFrame {
+    /**
+     * The index of the camera frame, frames that were dropped
+     * are skipped so this is not always consecutive
+     */
+    uint64_t frameIndex;
+
+    /**
+     * When the camera frame was captured
+     */
+    int64_t captureTime;
+
+    /**
+     * When the frame was published, the difference from the
+     * capture time is the latency of the pipeline
+     */
+    int64_t publishTime;
+
+    PoseFeedPerson persons[POSE_FEED_MAX_PERSONS];
+};
+
+/**
+ * How the capture thread of the writer is scheduled
+ */
+constexpr uint32_t POSE_FEED_SCHEDULING_DEFAULT = 0;
+constexpr uint32_t POSE_FEED_SCHEDULING_NICE = 1;
+constexpr uint32_t POSE_FEED_SCHEDULING_REALTIME = 2;
+
+/**
+ * A frame in the ring, the sequence is odd while the writer writes the frame
+ */
+struct alignas(64) PoseFeedSlot {
+    std::atomic<uint64_t> sequence;
+    PoseFeedFrame frame;
+};
+
+/**
+ * Tells the readers what they are looking at
+ */
+struct alignas(64) PoseFeedHeader {
+    std::atomic<uint32_t> magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t frameSize;
+
+    /**
+     * How many frames were written so far, frame N is in slot N % slotCount
+     */
+    std::atomic<uint64_t> written;
+
+    /**
+     * How the capture thread of the writer is scheduled, for tools looking into
+     * late frames. One of the POSE_FEED_SCHEDULING values, the real time priority
+     * or the nice value, and the CPUs it is pinned to, zero if it can run anywhere.
+     * These were padding before, so older writers leave them zero.
+     */
+    std::atomic<uint32_t> scheduling;
+    std::atomic<int32_t> priority;
+    std::atomic<uint64_t> cpuMask;
+};
+
+static_assert(sizeof(PoseFeedHeader) == 64, "The header must keep its size, the slots come right after it");
+
+struct PoseFeedLayout {
+    PoseFeedHeader header;
+    PoseFeedSlot slots[POSE_FEED_SLOTS];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "The feed needs lock free atomics to work across processes");
+
+/**
+ * Check that the feed was initialized by a writer with the same layout
+ */
+inline bool PoseFeedIsValid(const PoseFeedLayout* layout) {
+    return layout->header.magic.load(std::memory_order_acquire) == POSE_FEED_MAGIC
+        && layout->header.version == POSE_FEED_VERSION
+        && layout->header.slotCount == POSE_FEED_SLOTS
+        && layout->header.frameSize == sizeof(PoseFeedFrame);
+}
+
+/**
+ * How many frames were written so far, the newest frame is this minus one
+ */
+inline uint64_t PoseFeedWritten(const PoseFeedLayout* layout) {
+    return layout->header.written.load(std::memory_order_acquire);
+}
+
+/**
+ * Start reading a frame in place
+ *
+ * @param layout    [IN]    The feed
+ * @param index     [IN]    The frame to read, must be less than PoseFeedWritten
+ * @param sequence  [OUT]   Pass this to PoseFeedEndRead
+ *
+ * @return The frame, or nullptr if it is being written or was already overwritten
+ */
+inline const PoseFeedFrame* PoseFeedBeginRead(const PoseFeedLayout* layout, uint64_t index, uint64_t& sequence) {
+    const PoseFeedSlot& slot = layout->slots[index % POSE_FEED_SLOTS];
+    sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence != index * 2 + 2) {
+        return nullptr;
+    }
+    return &slot.frame;
+}
+
+/**
+ * Finish reading a frame
+ *
+ * @return False if the writer touched the frame while it was read, anything
+ *         read from it must be thrown away
+ */
+inline bool PoseFeedEndRead(const PoseFeedLayout* layout, uint64_t index, uint64_t sequence) {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return layout->slots[index % POSE_FEED_SLOTS].sequence.load(std::memory_order_relaxed) == sequence;
+}
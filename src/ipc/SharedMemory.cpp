@@ -0,0 +1,118 @@
+#include <string>
+
+#ifdef _WIN32
+    #include <windows.h>
+
+    constexpr intptr_t INVALID_HANDLE = 0;
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+
+    constexpr intptr_t INVALID_HANDLE = -1;
+#endif
+
+#include "SharedMemory.hpp"
+
+SharedMemory::SharedMemory()
+    : handle(INVALID_HANDLE)
+    , data(nullptr)
+    , size(0)
+{
+}
+
+SharedMemory::~SharedMemory() {
+    Close();
+}
+
+#ifdef _WIN32
+
+bool SharedMemory::Open(const char* name, size_t size) {
+    Close();
+
+    // the local namespace is per session, which is where both SteamVR and the service run
+    std::string path = std::string("Local\\") + name;
+    HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                        static_cast<DWORD>(static_cast<uint64_t>(size) >> 32),
+                                        static_cast<DWORD>(size),
+                                        path.c_str());
+    if (mapping == nullptr) {
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+    if (view == nullptr) {
+        CloseHandle(mapping);
+        return false;
+    }
+
+    this->handle = reinterpret_cast<intptr_t>(mapping);
+    this->data = view;
+    this->size = size;
+    return true;
+}
+
+void SharedMemory::Close() {
+    if (data != nullptr) {
+        UnmapViewOfFile(data);
+        data = nullptr;
+    }
+
+    if (handle != INVALID_HANDLE) {
+        CloseHandle(reinterpret_cast<HANDLE>(handle));
+        handle = INVALID_HANDLE;
+    }
+}
+
+#else
+
+bool SharedMemory::Open(const char* name, size_t size) {
+    Close();
+
+    std::string path = std::string("/") + name;
+    int fd = shm_open(path.c_str(), O_RDWR | O_CREAT, 0600);
+    if (fd < 0) {
+        return false;
+    }
+
+    // growing a new block zeroes it, growing to the same size does nothing
+    struct stat info {};
+    if (fstat(fd, &info) != 0 || (static_cast<size_t>(info.st_size) < size && ftruncate(fd, static_cast<off_t>(size)) != 0)) {
+        close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (view == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+
+    this->handle = fd;
+    this->data = view;
+    this->size = size;
+    return true;
+}
+
+void SharedMemory::Close() {
+    if (data != nullptr) {
+        munmap(data, size);
+        data = nullptr;
+    }
+
+    if (handle != INVALID_HANDLE) {
+        close(static_cast<int>(handle));
+        handle = INVALID_HANDLE;
+    }
+}
+
+#endif
+
+bool SharedMemory::IsOpen() const {
+    return data != nullptr;
+}
+
+void* SharedMemory::GetData() const {
+    return data;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * A named block of memory shared between processes, both sides open it with
+ * the same name and size, whoever comes first creates it. A new block is
+ * always zeroed.
+ *
+ * The block is never removed, so either side can restart and find the
+ * same memory again.
+ */
+class SharedMemory {
+private:
+    /**
+     * The native handle of the mapping
+     */
+    intptr_t handle;
+
+    void* data;
+    size_t size;
+
+public:
+
+    SharedMemory();
+    ~SharedMemory();
+
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+
+    /**
+     * Open or create the shared memory
+     *
+     * @param name  [IN] The name of the memory, without any prefix
+     * @param size  [IN] The size of the memory
+     */
+    bool Open(const char* name, size_t size);
+
+    /**
+     * Unmap the memory, it stays around for the next user
+     */
+    void Close();
+
+    bool IsOpen() const;
+    void* GetData() const;
+};
@@ -0,0 +1,58 @@
+#include "matrix4.hpp"
+
+matrix4::matrix4()
+        : m() {
+}
+
+matrix4 matrix4::identity() {
+    matrix4 result;
+    for (int i = 0; i < 4; i++) {
+        result.m[i][i] = 1.0f;
+    }
+    return result;
+}
+
+matrix4 matrix4::similarity(float scale, float qw, float qx, float qy, float qz, const vector3& translation) {
+    matrix4 result;
+
+    result.m[0][0] = scale * (1 - 2 * (qy * qy + qz * qz));
+    result.m[0][1] = scale * (2 * (qx * qy - qw * qz));
+    result.m[0][2] = scale * (2 * (qx * qz + qw * qy));
+
+    result.m[1][0] = scale * (2 * (qx * qy + qw * qz));
+    result.m[1][1] = scale * (1 - 2 * (qx * qx + qz * qz));
+    result.m[1][2] = scale * (2 * (qy * qz - qw * qx));
+
+    result.m[2][0] = scale * (2 * (qx * qz - qw * qy));
+    result.m[2][1] = scale * (2 * (qy * qz + qw * qx));
+    result.m[2][2] = scale * (1 - 2 * (qx * qx + qy * qy));
+
+    result.m[0][3] = translation.x;
+    result.m[1][3] = translation.y;
+    result.m[2][3] = translation.z;
+    result.m[3][3] = 1.0f;
+
+    return result;
+}
+
+matrix4 operator*(const matrix4& left, const matrix4& right) {
+    matrix4 result;
+    for (int i = 0; i < 4; i++) {
+        for (int j = 0; j < 4; j++) {
+            float sum = 0.0f;
+            for (int k = 0; k < 4; k++) {
+                sum += left.m[i][k] * right.m[k][j];
+            }
+            result.m[i][j] = sum;
+        }
+    }
+    return result;
+}
+
+vector3 matrix4::transform(const vector3& point) const {
+    return vector3(
+            m[0][0] * point.x + m[0][1] * point.y + m[0][2] * point.z + m[0][3],
+            m[1][0] * point.x + m[1][1] * point.y + m[1][2] * point.z + m[1][3],
+            m[2][0] * point.x + m[2][1] * point.y + m[2][2] * point.z + m[2][3]
+    );
+}
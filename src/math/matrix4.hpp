@@ -0,0 +1,27 @@
+#pragma once
+
+#include "vector3.hpp"
+
+/**
+ * A row major 4x4 affine transform
+ */
+struct matrix4 {
+    float m[4][4];
+
+    matrix4();
+
+    static matrix4 identity();
+
+    /**
+     * Make a transform that scales, then rotates by the given
+     * quaternion and then translates
+     */
+    static matrix4 similarity(float scale, float qw, float qx, float qy, float qz, const vector3& translation);
+
+    friend matrix4 operator*(const matrix4& left, const matrix4& right);
+
+    /**
+     * Transform a point
+     */
+    vector3 transform(const vector3& point) const;
+};
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * The packets a phone strapped to the body sends its IMU samples in, over UDP to
+ * the driver. Like the pose feed this header does not depend on anything else in
+ * the project, so it can be copied into the phone app as is.
+ *
+ * A packet is a header followed by count samples, little endian with no padding.
+ * Samples are sent as soon as the phone has them, a few of them per packet at most,
+ * since every packet moves the tracker.
+ *
+ * The times are in microseconds of any monotonic clock of the phone, the driver maps
+ * them to its own clock. The acceleration includes gravity, the way accelerometers
+ * measure it (about 9.81 up while lying still), and the axes can be those of the
+ * phone, the driver finds how the phone is held.
+ */
+
+/**
+ * "PMIM"
+ */
+constexpr uint32_t IMU_PACKET_MAGIC = 0x4D494D50;
+
+/**
+ * Changed whenever the layout changes
+ */
+constexpr uint16_t IMU_PACKET_VERSION = 1;
+
+/**
+ * The port the driver listens on
+ */
+constexpr uint16_t IMU_DEFAULT_PORT = 5100;
+
+/**
+ * The most samples in a single packet
+ */
+constexpr uint32_t IMU_PACKET_MAX_SAMPLES = 16;
+
+struct ImuPacketHeader {
+    uint32_t magic;
+    uint16_t version;
+
+    /**
+     * The tracker of the user the phone is on, in the order the driver exposes
+     * them: left leg, right leg, hip, left knee, right knee, chest, left elbow,
+     * right elbow
+     */
+    uint8_t tracker;
+
+    /**
+     * The amount of samples after the header
+     */
+    uint8_t count;
+
+    /**
+     * Goes up by one every packet, a phone that starts over from zero
+     * is taken as a new stream
+     */
+    uint32_t sequence;
+
+    uint32_t reserved;
+};
+
+struct ImuPacketSample {
+    /**
+     * When the sample was taken, in microseconds
+     */
+    int64_t time;
+
+    /**
+     * In m/s^2, including gravity
+     */
+    float acceleration[3];
+
+    /**
+     * In rad/s, counterclockwise around every axis
+     */
+    float rotationRate[3];
+};
+
+static_assert(sizeof(ImuPacketHeader) == 16, "The header must not be padded");
+static_assert(sizeof(ImuPacketSample) == 32, "The samples must not be padded");
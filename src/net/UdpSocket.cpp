@@ -0,0 +1,119 @@
+#include <cstring>
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+
+    using socklen_t = int;
+    constexpr intptr_t INVALID_HANDLE = static_cast<intptr_t>(INVALID_SOCKET);
+    #define CLOSE_SOCKET closesocket
+#else
+    #include <sys/socket.h>
+    #include <netinet/in.h>
+    #include <arpa/inet.h>
+    #include <poll.h>
+    #include <unistd.h>
+
+    constexpr intptr_t INVALID_HANDLE = -1;
+    #define CLOSE_SOCKET close
+#endif
+
+#include "UdpSocket.hpp"
+
+#ifdef _WIN32
+/**
+ * Make sure winsock is initialized before the first socket is made
+ */
+static void InitSockets() {
+    static bool initialized = false;
+    if (!initialized) {
+        WSADATA data;
+        WSAStartup(MAKEWORD(2, 2), &data);
+        initialized = true;
+    }
+}
+#else
+static void InitSockets() {}
+#endif
+
+static_assert(sizeof(sockaddr_in) <= 16, "The destination must fit an IPv4 address");
+
+UdpSocket::UdpSocket()
+    : handle(INVALID_HANDLE)
+    , destination()
+{
+}
+
+UdpSocket::~UdpSocket() {
+    Close();
+}
+
+bool UdpSocket::Bind(uint16_t port, int receiveBuffer) {
+    InitSockets();
+
+    handle = static_cast<intptr_t>(socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
+    if (handle == INVALID_HANDLE) {
+        return false;
+    }
+
+    // a big kernel buffer makes sure we don't lose packets while decoding
+    setsockopt(handle, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&receiveBuffer), sizeof(receiveBuffer));
+
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (bind(handle, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+bool UdpSocket::Connect(const char* host, uint16_t port) {
+    InitSockets();
+
+    handle = static_cast<intptr_t>(socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
+    if (handle == INVALID_HANDLE) {
+        return false;
+    }
+
+    sockaddr_in address {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    if (inet_pton(AF_INET, host, &address.sin_addr) != 1) {
+        Close();
+        return false;
+    }
+
+    std::memcpy(destination, &address, sizeof(address));
+    return true;
+}
+
+int UdpSocket::Receive(uint8_t* buffer, size_t size, int timeoutMs) {
+#ifdef _WIN32
+    WSAPOLLFD fd { static_cast<SOCKET>(handle), POLLIN, 0 };
+    int ready = WSAPoll(&fd, 1, timeoutMs);
+#else
+    pollfd fd { static_cast<int>(handle), POLLIN, 0 };
+    int ready = poll(&fd, 1, timeoutMs);
+#endif
+    if (ready <= 0) {
+        return ready;
+    }
+
+    return static_cast<int>(recv(handle, reinterpret_cast<char*>(buffer), static_cast<int>(size), 0));
+}
+
+bool UdpSocket::Send(const uint8_t* buffer, size_t size) {
+    return sendto(handle, reinterpret_cast<const char*>(buffer), static_cast<int>(size), 0,
+                  reinterpret_cast<const sockaddr*>(destination), sizeof(sockaddr_in)) == static_cast<int>(size);
+}
+
+void UdpSocket::Close() {
+    if (handle != INVALID_HANDLE) {
+        CLOSE_SOCKET(handle);
+        handle = INVALID_HANDLE;
+    }
+}
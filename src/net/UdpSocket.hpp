@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * A minimal blocking UDP socket, just enough for streaming
+ * to and from the local network
+ */
+class UdpSocket {
+private:
+    /**
+     * The native socket handle
+     */
+    intptr_t handle;
+
+    /**
+     * The address we send to
+     */
+    uint8_t destination[16];
+
+public:
+
+    UdpSocket();
+    ~UdpSocket();
+
+    UdpSocket(const UdpSocket&) = delete;
+    UdpSocket& operator=(const UdpSocket&) = delete;
+
+    /**
+     * Open the socket for receiving on the given port on all interfaces
+     *
+     * @param port              [IN] The port to listen on
+     * @param receiveBuffer     [IN] The size of the kernel receive buffer, large enough to hold a few frames
+     */
+    bool Bind(uint16_t port, int receiveBuffer);
+
+    /**
+     * Open the socket for sending to the given IPv4 address
+     *
+     * @param host  [IN] The address, in dotted notation
+     * @param port  [IN] The destination port
+     */
+    bool Connect(const char* host, uint16_t port);
+
+    /**
+     * Wait for a single datagram
+     *
+     * @param buffer        [OUT]   Where to put the datagram
+     * @param size          [IN]    The size of the buffer
+     * @param timeoutMs     [IN]    How long to wait for a datagram
+     *
+     * @return The size of the datagram, 0 on timeout and -1 on error
+     */
+    int Receive(uint8_t* buffer, size_t size, int timeoutMs);
+
+    /**
+     * Send a single datagram to the address given in Connect
+     */
+    bool Send(const uint8_t* buffer, size_t size);
+
+    /**
+     * Close the socket
+     */
+    void Close();
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+/**
+ * The indexes of the joints
+ */
+enum JointType {
+    JT_HEAD             = 0,
+    JT_COLLARBONE       = 1,
+    JT_TAILBONE         = 2,
+    JT_RIGHT_SHOULDER   = 3,
+    JT_LEFT_SHOULDER    = 4,
+    JT_RIGHT_HIP        = 5,
+    JT_LEFT_HIP         = 6,
+    JT_RIGHT_ELBOW      = 7,
+    JT_LEFT_ELBOW       = 8,
+    JT_RIGHT_KNEE       = 9,
+    JT_LEFT_KNEE        = 10,
+    JT_RIGHT_WRIST      = 11,
+    JT_LEFT_WRIST       = 12,
+    JT_RIGHT_ANKLE      = 13,
+    JT_LEFT_ANKLE       = 14,
+
+    JT_COUNT            = 15,
+};
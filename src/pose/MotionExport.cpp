@@ -0,0 +1,480 @@
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+
+#include "MotionExport.hpp"
+#include "Skeleton.hpp"
+
+/**
+ * "PMMS", the first 4 bytes of a motion stream
+ */
+constexpr uint32_t STREAM_MAGIC = 0x534D4D50;
+constexpr uint32_t STREAM_VERSION = 1;
+
+/**
+ * The frame time the BVH header starts with, it is replaced by the
+ * real one once the export is done
+ */
+constexpr double DEFAULT_FRAME_TIME = 1.0 / 30.0;
+
+/**
+ * The length of the end sites of the joints without children, the top of
+ * the head, the hands and the feet
+ */
+constexpr float END_SITE_LENGTH = 5.0f;
+
+/**
+ * Below this a direction is too short to turn a joint with
+ */
+constexpr float MIN_DIRECTION = 1e-4f;
+
+constexpr float DEGREES = 180.0f / 3.14159265358979f;
+
+/**
+ * The names of the joints in the BVH hierarchy
+ */
+constexpr const char* JOINT_NAMES[JT_COUNT] = {
+    "Head",
+    "Collarbone",
+    "Tailbone",
+    "RightShoulder",
+    "LeftShoulder",
+    "RightHip",
+    "LeftHip",
+    "RightElbow",
+    "LeftElbow",
+    "RightKnee",
+    "LeftKnee",
+    "RightWrist",
+    "LeftWrist",
+    "RightAnkle",
+    "LeftAnkle",
+};
+
+/**
+ * Where every joint points from its parent in the T-pose, facing +z
+ */
+static const vector3 REST_DIRECTIONS[JT_COUNT] = {
+    {  0,  1,  0 },     // head
+    {  0,  0,  0 },     // collarbone
+    {  0, -1,  0 },     // tailbone
+    { -1,  0,  0 },     // right shoulder
+    {  1,  0,  0 },     // left shoulder
+    { -1,  0,  0 },     // right hip
+    {  1,  0,  0 },     // left hip
+    { -1,  0,  0 },     // right elbow
+    {  1,  0,  0 },     // left elbow
+    {  0, -1,  0 },     // right knee
+    {  0, -1,  0 },     // left knee
+    { -1,  0,  0 },     // right wrist
+    {  1,  0,  0 },     // left wrist
+    {  0, -1,  0 },     // right ankle
+    {  0, -1,  0 },     // left ankle
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A rotation, with the axes it turns x, y and z into as its columns
+ */
+struct Rotation {
+    vector3 x, y, z;
+
+    static Rotation Identity() {
+        return { vector3::xaxis(), vector3::yaxis(), vector3::zaxis() };
+    }
+
+    vector3 Apply(const vector3& v) const {
+        return x * v.x + y * v.y + z * v.z;
+    }
+
+    friend Rotation operator*(const Rotation& left, const Rotation& right) {
+        return { left.Apply(right.x), left.Apply(right.y), left.Apply(right.z) };
+    }
+
+    Rotation Transpose() const {
+        return { { x.x, y.x, z.x }, { x.y, y.y, z.y }, { x.z, y.z, z.z } };
+    }
+};
+
+/**
+ * Get the parent of every joint from the bones
+ */
+static std::array<int, JT_COUNT> GetParents() {
+    std::array<int, JT_COUNT> parents;
+    parents.fill(-1);
+    for (const auto& bone : BONES) {
+        parents[bone.child] = bone.parent;
+    }
+    return parents;
+}
+
+static const std::array<int, JT_COUNT> PARENTS = GetParents();
+
+/**
+ * The offset of every joint from its parent in the T-pose
+ */
+static vector3 GetRestOffset(int joint) {
+    for (const auto& bone : BONES) {
+        if (bone.child == joint) {
+            return REST_DIRECTIONS[joint] * bone.length;
+        }
+    }
+    return vector3::zero();
+}
+
+/**
+ * The rotation that turns one direction into another along the shortest way
+ *
+ * @param from  [IN] The first direction, normalized
+ * @param to    [IN] The second direction, normalized
+ */
+static Rotation Swing(const vector3& from, const vector3& to) {
+    vector3 axis = from.cross(to);
+    float cosine = from.dot(to);
+
+    // turned around, any axis at a right angle will do
+    if (cosine < -0.9999f) {
+        vector3 other = std::fabs(from.x) < 0.9f ? vector3::xaxis() : vector3::yaxis();
+        vector3 half = from.cross(other).normalize();
+        auto flip = [&](const vector3& v) { return half * (2.0f * half.dot(v)) - v; };
+        return { flip(vector3::xaxis()), flip(vector3::yaxis()), flip(vector3::zaxis()) };
+    }
+
+    // Rodrigues, with the sine folded into the axis
+    float k = 1.0f / (1.0f + cosine);
+    auto turn = [&](const vector3& v) { return v * cosine + axis.cross(v) + axis * (axis.dot(v) * k); };
+    return { turn(vector3::xaxis()), turn(vector3::yaxis()), turn(vector3::zaxis()) };
+}
+
+/**
+ * The rotation of a torso joint, y along the spine and x as close to the side to
+ * side direction as it gets at a right angle to it
+ */
+static bool GetFrame(const vector3& side, const vector3& up, Rotation& rotation) {
+    if (side.magnitude() < MIN_DIRECTION || up.magnitude() < MIN_DIRECTION) {
+        return false;
+    }
+
+    vector3 y = up.normalize();
+    vector3 x = side - y * y.dot(side);
+    if (x.magnitude() < MIN_DIRECTION) {
+        return false;
+    }
+    x = x.normalize();
+    rotation = { x, y, x.cross(y) };
+    return true;
+}
+
+/**
+ * Get the rotation of every joint relative to its parent
+ *
+ * @param positions [IN]    The joints, in the space of the export
+ * @param local     [OUT]   The rotation of every joint
+ */
+static void GetRotations(const std::array<vector3, JT_COUNT>& positions, std::array<Rotation, JT_COUNT>& local) {
+    std::array<Rotation, JT_COUNT> global;
+    vector3 spine = positions[JT_COLLARBONE] - positions[JT_TAILBONE];
+
+    if (!GetFrame(positions[JT_LEFT_SHOULDER] - positions[JT_RIGHT_SHOULDER], spine, global[JT_COLLARBONE])) {
+        global[JT_COLLARBONE] = Rotation::Identity();
+    }
+
+    // the bones are ordered parent first, so the parent of a joint is always done
+    for (const auto& bone : BONES) {
+        int joint = bone.child;
+        const Rotation& parent = global[bone.parent];
+        global[joint] = parent;
+
+        if (joint == JT_TAILBONE) {
+            Rotation frame;
+            if (GetFrame(positions[JT_LEFT_HIP] - positions[JT_RIGHT_HIP], spine, frame)) {
+                global[joint] = frame;
+            }
+            continue;
+        }
+
+        // a single bone goes out of the rest, it only swings that one
+        int child = -1;
+        for (const auto& next : BONES) {
+            if (next.parent == joint) {
+                child = next.child;
+            }
+        }
+        if (child < 0) {
+            continue;
+        }
+
+        vector3 direction = positions[child] - positions[joint];
+        if (direction.magnitude() < MIN_DIRECTION) {
+            continue;
+        }
+        global[joint] = Swing(parent.Apply(REST_DIRECTIONS[child]), direction.normalize()) * parent;
+    }
+
+    local[JT_COLLARBONE] = global[JT_COLLARBONE];
+    for (const auto& bone : BONES) {
+        local[bone.child] = global[bone.parent].Transpose() * global[bone.child];
+    }
+}
+
+/**
+ * Split a rotation into the Z, X, Y angles BVH uses, in degrees
+ */
+static vector3 GetEulerZXY(const Rotation& rotation) {
+    // the matrix is Rz * Rx * Ry, m[row][column] is the row of the column
+    float m01 = rotation.y.x, m11 = rotation.y.y, m21 = rotation.y.z;
+    float m20 = rotation.x.z, m22 = rotation.z.z;
+    float m00 = rotation.x.x, m10 = rotation.x.y;
+
+    float x = std::asin(std::fmax(-1.0f, std::fmin(1.0f, m21)));
+    float y, z;
+    if (std::fabs(m21) < 0.9999f) {
+        y = std::atan2(-m20, m22);
+        z = std::atan2(-m01, m11);
+    } else {
+        // straight up or down, y and z turn about the same axis
+        y = 0.0f;
+        z = std::atan2(m10, m00);
+    }
+    return { x * DEGREES, y * DEGREES, z * DEGREES };
+}
+
+/**
+ * Get the w, x, y, z quaternion of a rotation
+ */
+static std::array<float, 4> GetQuaternion(const Rotation& rotation) {
+    float m00 = rotation.x.x, m01 = rotation.y.x, m02 = rotation.z.x;
+    float m10 = rotation.x.y, m11 = rotation.y.y, m12 = rotation.z.y;
+    float m20 = rotation.x.z, m21 = rotation.y.z, m22 = rotation.z.z;
+
+    float trace = m00 + m11 + m22;
+    if (trace > 0.0f) {
+        float s = std::sqrt(trace + 1.0f) * 2.0f;
+        return { s / 4.0f, (m21 - m12) / s, (m02 - m20) / s, (m10 - m01) / s };
+    } else if (m00 > m11 && m00 > m22) {
+        float s = std::sqrt(1.0f + m00 - m11 - m22) * 2.0f;
+        return { (m21 - m12) / s, s / 4.0f, (m01 + m10) / s, (m02 + m20) / s };
+    } else if (m11 > m22) {
+        float s = std::sqrt(1.0f + m11 - m00 - m22) * 2.0f;
+        return { (m02 - m20) / s, (m01 + m10) / s, s / 4.0f, (m12 + m21) / s };
+    } else {
+        float s = std::sqrt(1.0f + m22 - m00 - m11) * 2.0f;
+        return { (m10 - m01) / s, (m02 + m20) / s, (m12 + m21) / s, s / 4.0f };
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+MotionExporter::MotionExporter()
+    : writer()
+    , path()
+    , format(MF_STREAM)
+    , order()
+    , joints()
+    , hasPose(false)
+    , frames(0)
+    , firstTime(0)
+    , lastTime(0)
+    , framesOffset(0)
+{
+}
+
+/**
+ * Write formatted text to the file, the text of a frame is well below the size of the buffer
+ */
+template <typename... Args>
+static void Print(AsyncFileWriter& writer, const char* format, Args... args) {
+    char buffer[256];
+    int length = std::snprintf(buffer, sizeof(buffer), format, args...);
+    if (length > 0) {
+        writer.Write(buffer, std::min(static_cast<size_t>(length), sizeof(buffer) - 1));
+    }
+}
+
+void MotionExporter::WriteHierarchy(JointType joint, int depth, int& index) {
+    static const char TABS[] = "\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t";
+    const char* indent = TABS + sizeof(TABS) - 1 - depth;
+    const char* inner = indent - 1;
+    vector3 offset = GetRestOffset(joint);
+
+    if (joint == SKELETON_ROOT) {
+        Print(this->writer, "ROOT %s\n{\n", JOINT_NAMES[joint]);
+        Print(this->writer, "\tOFFSET 0.0 0.0 0.0\n");
+        Print(this->writer, "\tCHANNELS 6 Xposition Yposition Zposition Zrotation Xrotation Yrotation\n");
+    } else {
+        Print(this->writer, "%sJOINT %s\n%s{\n", indent, JOINT_NAMES[joint], indent);
+        Print(this->writer, "%sOFFSET %.4f %.4f %.4f\n", inner, offset.x, offset.y, offset.z);
+        Print(this->writer, "%sCHANNELS 3 Zrotation Xrotation Yrotation\n", inner);
+    }
+    this->order[index++] = joint;
+
+    bool leaf = true;
+    for (const auto& bone : BONES) {
+        if (bone.parent == joint) {
+            WriteHierarchy(bone.child, depth + 1, index);
+            leaf = false;
+        }
+    }
+
+    if (leaf) {
+        vector3 end = REST_DIRECTIONS[joint] * END_SITE_LENGTH;
+        Print(this->writer, "%sEnd Site\n%s{\n", inner, inner);
+        Print(this->writer, "%s\tOFFSET %.4f %.4f %.4f\n", inner, end.x, end.y, end.z);
+        Print(this->writer, "%s}\n", inner);
+    }
+    Print(this->writer, "%s}\n", indent);
+}
+
+bool MotionExporter::Open(const std::string& path) {
+    Close();
+
+    this->path = path;
+    bool bvh = path.size() >= 4 && path.compare(path.size() - 4, 4, ".bvh") == 0;
+    this->format = bvh ? MF_BVH : MF_STREAM;
+    if (!this->writer.Open(path)) {
+        return false;
+    }
+
+    this->hasPose = false;
+    this->frames = 0;
+    this->firstTime = 0;
+    this->lastTime = 0;
+
+    if (this->format == MF_BVH) {
+        int index = 0;
+        Print(this->writer, "HIERARCHY\n");
+        WriteHierarchy(SKELETON_ROOT, 0, index);
+
+        // room for the real count and frame time, they are written over at the end
+        Print(this->writer, "MOTION\nFrames: ");
+        this->framesOffset = this->writer.GetSize();
+        Print(this->writer, "%20" PRIu64 "\nFrame Time: %20.10f\n", static_cast<uint64_t>(0), DEFAULT_FRAME_TIME);
+    } else {
+        const uint32_t header[] = { STREAM_MAGIC, STREAM_VERSION, JT_COUNT };
+        this->writer.Write(header, sizeof(header));
+        for (int joint = 0; joint < JT_COUNT; joint++) {
+            int32_t parent = PARENTS[joint];
+            this->writer.Write(&parent, sizeof(parent));
+        }
+        for (int joint = 0; joint < JT_COUNT; joint++) {
+            vector3 offset = GetRestOffset(joint);
+            const float values[] = { offset.x, offset.y, offset.z };
+            this->writer.Write(values, sizeof(values));
+        }
+    }
+    return true;
+}
+
+bool MotionExporter::IsOpen() const {
+    return this->writer.IsOpen();
+}
+
+MotionFormat MotionExporter::GetFormat() const {
+    return this->format;
+}
+
+void MotionExporter::WriteBvhFrame(const std::array<vector3, JT_COUNT>& positions) {
+    std::array<Rotation, JT_COUNT> rotations;
+    GetRotations(positions, rotations);
+
+    // a frame is a single line, formatted in one go so the writer only copies it once
+    char line[1024];
+    size_t length = 0;
+    const vector3& root = positions[SKELETON_ROOT];
+    length += std::snprintf(line, sizeof(line), "%.4f %.4f %.4f", root.x, root.y, root.z);
+    for (JointType joint : this->order) {
+        vector3 angles = GetEulerZXY(rotations[joint]);
+        length += std::snprintf(line + length, sizeof(line) - length, " %.3f %.3f %.3f", angles.z, angles.x, angles.y);
+    }
+    line[length++] = '\n';
+    this->writer.Write(line, length);
+}
+
+void MotionExporter::WriteStreamFrame(int64_t time, bool active, const std::array<vector3, JT_COUNT>& positions) {
+    std::array<Rotation, JT_COUNT> rotations;
+    GetRotations(positions, rotations);
+
+    struct {
+        int64_t time;
+        uint32_t active;
+        float positions[JT_COUNT][3];
+        float rotations[JT_COUNT][4];
+    } frame;
+    static_assert(sizeof(frame) == 8 + 4 + JT_COUNT * 7 * 4, "The frame must not be padded");
+
+    frame.time = time;
+    frame.active = active ? 1 : 0;
+    for (int joint = 0; joint < JT_COUNT; joint++) {
+        frame.positions[joint][0] = positions[joint].x;
+        frame.positions[joint][1] = positions[joint].y;
+        frame.positions[joint][2] = positions[joint].z;
+
+        auto quaternion = GetQuaternion(rotations[joint]);
+        std::memcpy(frame.rotations[joint], quaternion.data(), sizeof(frame.rotations[joint]));
+    }
+    this->writer.Write(&frame, sizeof(frame));
+}
+
+void MotionExporter::Write(int64_t time, const std::array<vector3, JT_COUNT>& joints, bool active) {
+    if (!IsOpen()) {
+        return;
+    }
+
+    // from the camera, y down and z forward, to y up facing the camera
+    if (active) {
+        for (int joint = 0; joint < JT_COUNT; joint++) {
+            this->joints[joint] = { joints[joint].x, -joints[joint].y, -joints[joint].z };
+        }
+        this->hasPose = true;
+    }
+    if (!this->hasPose) {
+        return;
+    }
+
+    if (this->frames == 0) {
+        this->firstTime = time;
+    }
+    this->lastTime = time;
+    this->frames++;
+
+    if (this->format == MF_BVH) {
+        WriteBvhFrame(this->joints);
+    } else {
+        WriteStreamFrame(time, active, this->joints);
+    }
+}
+
+uint64_t MotionExporter::GetFrameCount() const {
+    return this->frames;
+}
+
+bool MotionExporter::Close() {
+    if (!IsOpen()) {
+        return true;
+    }
+
+    bool written = this->writer.Close();
+    if (!written || this->format != MF_BVH) {
+        return written;
+    }
+
+    // now that we know them, put the real count and frame time into the header
+    double frameTime = DEFAULT_FRAME_TIME;
+    if (this->frames > 1) {
+        frameTime = static_cast<double>(this->lastTime - this->firstTime) / 1e6 / static_cast<double>(this->frames - 1);
+    }
+
+    char header[64];
+    int length = std::snprintf(header, sizeof(header), "%20" PRIu64 "\nFrame Time: %20.10f", this->frames, frameTime);
+
+    FILE* file = std::fopen(this->path.c_str(), "r+b");
+    if (file == nullptr) {
+        return false;
+    }
+    written = std::fseek(file, static_cast<long>(this->framesOffset), SEEK_SET) == 0
+           && std::fwrite(header, 1, length, file) == static_cast<size_t>(length);
+    return std::fclose(file) == 0 && written;
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <array>
+
+#include <math/vector3.hpp>
+#include <util/AsyncFileWriter.hpp>
+
+#include "Joints.hpp"
+
+/**
+ * The formats a motion can be exported in
+ */
+enum MotionFormat {
+    /**
+     * A BVH file, a skeleton of our joints with a rotation for every one of them,
+     * which most animation tools can import
+     */
+    MF_BVH,
+
+    /**
+     * Our own binary stream, with the positions and the rotations of every joint
+     */
+    MF_STREAM,
+};
+
+/**
+ * Exports the motion of a single person, frame by frame, for as long as the session
+ * goes. The files are written by an AsyncFileWriter, so writing a frame only formats
+ * it into a buffer and never waits for the disk.
+ *
+ * Both formats are in a y up space (x left of the person facing the camera, z towards
+ * the camera), in body proportion units, with the skeleton of BONES. The rotation of
+ * a joint turns the bones going out of it from the T-pose, a joint with a single bone
+ * out of it only swings it and keeps the twist of its parent, the collarbone and the
+ * tailbone are turned by the shoulders and the hips.
+ *
+ * The stream is little endian:
+ *      uint32  magic "PMMS"
+ *      uint32  version
+ *      uint32  joint count
+ *      int32   parent of every joint, -1 for the root
+ *      float   x, y, z offset of every joint from its parent in the T-pose
+ *
+ * And then every frame:
+ *      int64   capture time, in microseconds
+ *      uint32  1 if the person was seen, otherwise the last pose is repeated
+ *      float   x, y, z position of every joint
+ *      float   w, x, y, z rotation of every joint relative to its parent
+ *
+ * All joints are in the order of JointType.
+ */
+class MotionExporter {
+private:
+    AsyncFileWriter writer;
+    std::string path;
+    MotionFormat format;
+
+    /**
+     * The joints in the order the BVH hierarchy lists them
+     */
+    std::array<JointType, JT_COUNT> order;
+
+    /**
+     * The last pose, repeated while the person is not seen
+     */
+    std::array<vector3, JT_COUNT> joints;
+    bool hasPose;
+
+    /**
+     * The frames written so far, and when the first and last were captured,
+     * the BVH header gets the count and the frame time once we are done
+     */
+    uint64_t frames;
+    int64_t firstTime;
+    int64_t lastTime;
+    uint64_t framesOffset;
+
+    /**
+     * Write a joint and everything below it, and put them into the order
+     */
+    void WriteHierarchy(JointType joint, int depth, int& index);
+    void WriteBvhFrame(const std::array<vector3, JT_COUNT>& positions);
+    void WriteStreamFrame(int64_t time, bool active, const std::array<vector3, JT_COUNT>& positions);
+
+public:
+
+    MotionExporter();
+
+    /**
+     * Start a new export, the format comes from the extension, .bvh for
+     * BVH and the stream for anything else
+     *
+     * @param path  [IN] The file to create
+     */
+    bool Open(const std::string& path);
+
+    bool IsOpen() const;
+
+    MotionFormat GetFormat() const;
+
+    /**
+     * Add a frame, frames before the person is first seen are left out
+     *
+     * @param time      [IN] When the frame was captured, in microseconds
+     * @param joints    [IN] The joints, in the space of the camera (x right, y down, z forward)
+     * @param active    [IN] Was the person seen, if not the last pose is repeated
+     */
+    void Write(int64_t time, const std::array<vector3, JT_COUNT>& joints, bool active);
+
+    uint64_t GetFrameCount() const;
+
+    /**
+     * Write out everything and finish the file
+     *
+     * @return False if anything failed to be written
+     */
+    bool Close();
+};
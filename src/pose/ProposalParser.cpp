@@ -0,0 +1,320 @@
+#include <algorithm>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+#endif
+
+#include "ProposalParser.hpp"
+
+/**
+ * The order of the feature maps coming out of the network
+ */
+enum ProposalMap {
+    PM_CONFIDENCE,
+    PM_IOU,
+    PM_X,
+    PM_Y,
+    PM_WIDTH,
+    PM_HEIGHT,
+    PM_EDGES,
+    PM_COUNT,
+};
+
+/**
+ * Every pose starts from a neck
+ */
+constexpr int ROOT_PART = 1;
+
+/**
+ * The limbs the network predicts connections for, in its order, a
+ * parent always comes before its children
+ */
+constexpr int LIMB_COUNT = 17;
+static const int LIMBS[LIMB_COUNT][2] = {
+    { 1, 2 }, { 2, 3 }, { 3, 4 },       // right arm
+    { 1, 5 }, { 5, 6 }, { 6, 7 },       // left arm
+    { 1, 8 }, { 8, 9 }, { 9, 10 },      // right leg
+    { 1, 11 }, { 11, 12 }, { 12, 13 },  // left leg
+    { 1, 0 },                           // nose
+    { 0, 14 }, { 14, 16 },              // right eye and ear
+    { 0, 15 }, { 15, 17 },              // left eye and ear
+};
+
+/**
+ * Cells outside of the grid, never a peak and never bigger than a neighbor
+ */
+constexpr float BORDER = -1.0f;
+
+/**
+ * Get the shape of a feature map without the batch dimensions
+ */
+static bool GetShape(const hyperpose::feature_map_t& map, size_t dimensions, int* shape) {
+    const auto& full = map.shape();
+    if (full.size() < dimensions) {
+        return false;
+    }
+
+    // anything in front has to be a batch of one
+    size_t extra = full.size() - dimensions;
+    for (size_t i = 0; i < extra; i++) {
+        if (full[i] != 1) {
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < dimensions; i++) {
+        shape[i] = full[extra + i];
+    }
+    return true;
+}
+
+/**
+ * Find the cells of a row that pass the threshold and are a local maximum, on ties the
+ * first cell in reading order wins. The rows have a border cell on each side.
+ *
+ * @return A bit for every cell starting at the given column
+ */
+static uint32_t FindRowMaxima(const float* above, const float* row, const float* below, int col, float threshold) {
+#if defined(__SSE2__) || defined(_M_X64)
+    __m128 center = _mm_loadu_ps(row + col);
+    __m128 mask = _mm_cmpgt_ps(center, _mm_set1_ps(threshold));
+
+    // strictly bigger than the cells before it, at least as big as the ones after it
+    mask = _mm_and_ps(mask, _mm_cmpgt_ps(center, _mm_loadu_ps(row + col - 1)));
+    mask = _mm_and_ps(mask, _mm_cmpgt_ps(center, _mm_loadu_ps(above + col - 1)));
+    mask = _mm_and_ps(mask, _mm_cmpgt_ps(center, _mm_loadu_ps(above + col)));
+    mask = _mm_and_ps(mask, _mm_cmpgt_ps(center, _mm_loadu_ps(above + col + 1)));
+    mask = _mm_and_ps(mask, _mm_cmpge_ps(center, _mm_loadu_ps(row + col + 1)));
+    mask = _mm_and_ps(mask, _mm_cmpge_ps(center, _mm_loadu_ps(below + col - 1)));
+    mask = _mm_and_ps(mask, _mm_cmpge_ps(center, _mm_loadu_ps(below + col)));
+    mask = _mm_and_ps(mask, _mm_cmpge_ps(center, _mm_loadu_ps(below + col + 1)));
+
+    return static_cast<uint32_t>(_mm_movemask_ps(mask));
+#elif defined(__ARM_NEON)
+    float32x4_t center = vld1q_f32(row + col);
+    uint32x4_t mask = vcgtq_f32(center, vdupq_n_f32(threshold));
+
+    mask = vandq_u32(mask, vcgtq_f32(center, vld1q_f32(row + col - 1)));
+    mask = vandq_u32(mask, vcgtq_f32(center, vld1q_f32(above + col - 1)));
+    mask = vandq_u32(mask, vcgtq_f32(center, vld1q_f32(above + col)));
+    mask = vandq_u32(mask, vcgtq_f32(center, vld1q_f32(above + col + 1)));
+    mask = vandq_u32(mask, vcgeq_f32(center, vld1q_f32(row + col + 1)));
+    mask = vandq_u32(mask, vcgeq_f32(center, vld1q_f32(below + col - 1)));
+    mask = vandq_u32(mask, vcgeq_f32(center, vld1q_f32(below + col)));
+    mask = vandq_u32(mask, vcgeq_f32(center, vld1q_f32(below + col + 1)));
+
+    // there is no movemask, give every lane its bit and add them up
+    static const uint32_t LANE_BITS[4] = { 1, 2, 4, 8 };
+    uint32x4_t bits = vandq_u32(mask, vld1q_u32(LANE_BITS));
+    uint32x2_t sum = vadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+    return vget_lane_u32(vpadd_u32(sum, sum), 0);
+#else
+    uint32_t mask = 0;
+    for (int i = 0; i < 4; i++) {
+        int c = col + i;
+        float center = row[c];
+        if (center > threshold
+                && center > row[c - 1] && center > above[c - 1] && center > above[c] && center > above[c + 1]
+                && center >= row[c + 1] && center >= below[c - 1] && center >= below[c] && center >= below[c + 1]) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ProposalParser::ProposalParser(float pointThreshold, float limbThreshold)
+    : pointThreshold(pointThreshold)
+    , limbThreshold(limbThreshold)
+    , peaks()
+    , peakCounts()
+    , posePeaks()
+    , connections()
+    , scoreRows()
+{
+}
+
+void ProposalParser::FindPeaks(int part, const float* confidence, const float* iou, const float* x, const float* y, int width, int height) {
+    auto& partPeaks = this->peaks[part];
+    int& count = this->peakCounts[part];
+    count = 0;
+
+    // the rows are scored one ahead of the row we search, so every
+    // input is only read once
+    auto scoreRow = [&](int row, float* out) {
+        std::fill(out, out + MAX_GRID + 8, BORDER);
+        if (row < 0 || row >= height) {
+            return;
+        }
+
+        const float* rowConfidence = confidence + row * width;
+        const float* rowIou = iou + row * width;
+        for (int col = 0; col < width; col++) {
+            out[col + 1] = rowConfidence[col] * rowIou[col];
+        }
+    };
+
+    float* above = this->scoreRows[0];
+    float* current = this->scoreRows[1];
+    float* below = this->scoreRows[2];
+    scoreRow(-1, above);
+    scoreRow(0, current);
+
+    for (int row = 0; row < height; row++) {
+        scoreRow(row + 1, below);
+
+        for (int col = 1; col <= width; col += 4) {
+            uint32_t mask = FindRowMaxima(above, current, below, col, this->pointThreshold);
+            while (mask != 0 && count < MAX_PEAKS) {
+                int lane = 0;
+                while ((mask & (1u << lane)) == 0) {
+                    lane++;
+                }
+                mask &= ~(1u << lane);
+
+                // the offsets are relative to the cell
+                int cell = col + lane - 1;
+                int index = row * width + cell;
+                Peak& peak = partPeaks[count++];
+                peak.x = (cell + x[index]) / width;
+                peak.y = (row + y[index]) / height;
+                peak.score = current[cell + 1];
+                peak.row = row;
+                peak.col = cell;
+                peak.used = false;
+            }
+        }
+
+        std::swap(above, current);
+        std::swap(current, below);
+    }
+}
+
+void ProposalParser::GroupLimb(int limb, const float* edges, int windowHeight, int windowWidth, int width, int height, ParsedPoses& result) {
+    int from = LIMBS[limb][0];
+    int to = LIMBS[limb][1];
+    const auto& fromPeaks = this->peaks[from];
+    auto& toPeaks = this->peaks[to];
+    int gridSize = width * height;
+
+    // every pose with the first part against every keypoint of the second part
+    // that is inside the window of the edge map
+    int connectionCount = 0;
+    for (int pose = 0; pose < result.count; pose++) {
+        int fromPeak = this->posePeaks[pose][from];
+        if (fromPeak < 0) {
+            continue;
+        }
+        const Peak& start = fromPeaks[fromPeak];
+
+        for (int peak = 0; peak < this->peakCounts[to]; peak++) {
+            const Peak& end = toPeaks[peak];
+            int dy = end.row - start.row + windowHeight / 2;
+            int dx = end.col - start.col + windowWidth / 2;
+            if (dy < 0 || dy >= windowHeight || dx < 0 || dx >= windowWidth) {
+                continue;
+            }
+
+            float edge = edges[((limb * windowHeight + dy) * windowWidth + dx) * gridSize + start.row * width + start.col];
+            if (edge > this->limbThreshold) {
+                this->connections[connectionCount++] = { edge * end.score, pose, peak };
+            }
+        }
+    }
+
+    // strongest first, every pose and keypoint is only connected once
+    std::sort(this->connections.begin(), this->connections.begin() + connectionCount,
+            [](const Connection& a, const Connection& b) { return a.score > b.score; });
+
+    for (int i = 0; i < connectionCount; i++) {
+        const Connection& connection = this->connections[i];
+        Peak& peak = toPeaks[connection.peak];
+        if (peak.used || this->posePeaks[connection.pose][to] >= 0) {
+            continue;
+        }
+
+        peak.used = true;
+        this->posePeaks[connection.pose][to] = connection.peak;
+
+        auto& part = result.poses[connection.pose].parts[to];
+        part.has_value = true;
+        part.x = peak.x;
+        part.y = peak.y;
+        part.score = peak.score;
+    }
+}
+
+bool ProposalParser::Parse(const std::vector<hyperpose::feature_map_t>& maps, ParsedPoses& result) {
+    result.count = 0;
+    if (maps.size() < PM_COUNT) {
+        return false;
+    }
+
+    // every part map is parts x height x width
+    int shape[3];
+    if (!GetShape(maps[PM_CONFIDENCE], 3, shape) || shape[0] != static_cast<int>(hyperpose::COCO_N_PARTS)) {
+        return false;
+    }
+    int parts = shape[0];
+    int height = shape[1];
+    int width = shape[2];
+    if (width <= 0 || height <= 0 || width > MAX_GRID || height > MAX_GRID) {
+        return false;
+    }
+    for (int map : { PM_IOU, PM_X, PM_Y }) {
+        int other[3];
+        if (!GetShape(maps[map], 3, other) || !std::equal(shape, shape + 3, other)) {
+            return false;
+        }
+    }
+
+    // the edges are limbs x window height x window width x height x width
+    int edgeShape[5];
+    if (!GetShape(maps[PM_EDGES], 5, edgeShape) || edgeShape[0] != LIMB_COUNT || edgeShape[3] != height || edgeShape[4] != width) {
+        return false;
+    }
+
+    const float* confidence = maps[PM_CONFIDENCE].view<float>();
+    const float* iou = maps[PM_IOU].view<float>();
+    const float* x = maps[PM_X].view<float>();
+    const float* y = maps[PM_Y].view<float>();
+    const float* edges = maps[PM_EDGES].view<float>();
+
+    int gridSize = width * height;
+    for (int part = 0; part < parts; part++) {
+        FindPeaks(part, confidence + part * gridSize, iou + part * gridSize, x + part * gridSize, y + part * gridSize, width, height);
+    }
+
+    // every neck starts a pose
+    for (int peak = 0; peak < this->peakCounts[ROOT_PART] && result.count < ParsedPoses::MAX_POSES; peak++) {
+        int pose = result.count++;
+        this->posePeaks[pose].fill(-1);
+        this->posePeaks[pose][ROOT_PART] = peak;
+
+        auto& human = result.poses[pose];
+        human = hyperpose::human_t();
+        const Peak& root = this->peaks[ROOT_PART][peak];
+        human.parts[ROOT_PART] = { true, root.x, root.y, root.score };
+    }
+
+    for (int limb = 0; limb < LIMB_COUNT; limb++) {
+        GroupLimb(limb, edges, edgeShape[1], edgeShape[2], width, height, result);
+    }
+
+    // complete poses score higher
+    for (int pose = 0; pose < result.count; pose++) {
+        auto& human = result.poses[pose];
+        float score = 0;
+        for (const auto& part : human.parts) {
+            score += part.has_value ? part.score : 0.0f;
+        }
+        human.score = score / parts;
+    }
+
+    return true;
+}
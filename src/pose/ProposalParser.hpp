@@ -0,0 +1,104 @@
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include <hyperpose/hyperpose.hpp>
+
+/**
+ * The poses found in a single frame, in a fixed array so parsing
+ * never allocates
+ */
+struct ParsedPoses {
+    static constexpr int MAX_POSES = 32;
+
+    std::array<hyperpose::human_t, MAX_POSES> poses;
+    int count;
+};
+
+/**
+ * Turns the feature maps of the pose proposal network into poses, a
+ * replacement for the pose_proposal parser of HyperPose.
+ *
+ * The keypoints are found in a single pass over every part: the confidence is
+ * thresholded, and only the cells that are the maximum of their 3x3 neighborhood
+ * are kept, which takes the place of the box NMS, all four cells at a time with
+ * SSE or NEON. The keypoints are then grouped into poses along the limbs, strongest
+ * connections first, starting from the necks.
+ */
+class ProposalParser {
+public:
+    /**
+     * The most keypoints of a single part we keep
+     */
+    static constexpr int MAX_PEAKS = 32;
+
+    /**
+     * The largest grid we can parse
+     */
+    static constexpr int MAX_GRID = 64;
+
+private:
+    struct Peak {
+        float x, y;
+        float score;
+        int row, col;
+        bool used;
+    };
+
+    struct Connection {
+        float score;
+        int pose;
+        int peak;
+    };
+
+    float pointThreshold;
+    float limbThreshold;
+
+    /**
+     * The keypoints of every part
+     */
+    std::array<std::array<Peak, MAX_PEAKS>, hyperpose::COCO_N_PARTS> peaks;
+    std::array<int, hyperpose::COCO_N_PARTS> peakCounts;
+
+    /**
+     * The keypoint of every part of every pose, -1 if it has none
+     */
+    std::array<std::array<int, hyperpose::COCO_N_PARTS>, ParsedPoses::MAX_POSES> posePeaks;
+
+    /**
+     * The candidate connections of the limb we are grouping
+     */
+    std::array<Connection, MAX_PEAKS * ParsedPoses::MAX_POSES> connections;
+
+    /**
+     * The scores of the rows around the one we search, with a border
+     * and room for a whole vector past the end
+     */
+    float scoreRows[3][MAX_GRID + 8];
+
+    /**
+     * Find the keypoints of a single part
+     */
+    void FindPeaks(int part, const float* confidence, const float* iou, const float* x, const float* y, int width, int height);
+
+    /**
+     * Connect the keypoints of a limb to the poses that have its first part
+     */
+    void GroupLimb(int limb, const float* edges, int windowHeight, int windowWidth, int width, int height, ParsedPoses& result);
+
+public:
+
+    explicit ProposalParser(float pointThreshold = 0.10f, float limbThreshold = 0.05f);
+
+    /**
+     * Parse the output of the network
+     *
+     * @param maps      [IN]    The feature maps, as HyperPose gives them
+     * @param result    [OUT]   The poses, in normalized image coordinates
+     *
+     * @return False if the maps are not laid out the way we expect, use the
+     *         HyperPose parser instead
+     */
+    bool Parse(const std::vector<hyperpose::feature_map_t>& maps, ParsedPoses& result);
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Joints.hpp"
+
+/**
+ * Relative body proportion value
+ */
+constexpr float FOREARM = 14.0;
+constexpr float UPPER_ARM = 15.0;
+constexpr float SHOULDER = 18.0;
+constexpr float FORELEG = 20.0;
+constexpr float THIGH = 19.0;
+constexpr float PELVIC = 14.0;
+constexpr float SPINE = 24.0;
+constexpr float NECK = 7.0;
+constexpr float HEIGHT = 70.0;
+
+/**
+ * The focal length of the camera in normalized image units, about a 53 degree
+ * field of view, this is what a typical webcam has
+ */
+constexpr float FOCAL_LENGTH = 1.0;
+
+/**
+ * A bone of the skeleton, going from the parent joint to the child joint
+ */
+struct Bone {
+    JointType parent;
+    JointType child;
+
+    /**
+     * The length of the bone for an average person
+     */
+    float length;
+};
+
+/**
+ * The root of the skeleton, every other joint hangs from it
+ */
+constexpr JointType SKELETON_ROOT = JT_COLLARBONE;
+
+/**
+ * The skeleton as a tree, a parent always comes before its children
+ */
+constexpr int BONE_COUNT = 14;
+constexpr Bone BONES[BONE_COUNT] = {
+    { JT_COLLARBONE,        JT_HEAD,            NECK },
+    { JT_COLLARBONE,        JT_RIGHT_SHOULDER,  SHOULDER / 2 },
+    { JT_COLLARBONE,        JT_LEFT_SHOULDER,   SHOULDER / 2 },
+    { JT_COLLARBONE,        JT_TAILBONE,        SPINE },
+    { JT_RIGHT_SHOULDER,    JT_RIGHT_ELBOW,     UPPER_ARM },
+    { JT_RIGHT_ELBOW,       JT_RIGHT_WRIST,     FOREARM },
+    { JT_LEFT_SHOULDER,     JT_LEFT_ELBOW,      UPPER_ARM },
+    { JT_LEFT_ELBOW,        JT_LEFT_WRIST,      FOREARM },
+    { JT_TAILBONE,          JT_RIGHT_HIP,       PELVIC / 2 },
+    { JT_TAILBONE,          JT_LEFT_HIP,        PELVIC / 2 },
+    { JT_RIGHT_HIP,         JT_RIGHT_KNEE,      THIGH },
+    { JT_RIGHT_KNEE,        JT_RIGHT_ANKLE,     FORELEG },
+    { JT_LEFT_HIP,          JT_LEFT_KNEE,       THIGH },
+    { JT_LEFT_KNEE,         JT_LEFT_ANKLE,      FORELEG },
+};
@@ -0,0 +1,456 @@
+#include <algorithm>
+#include <cmath>
+
+#include "SkeletonFitter.hpp"
+
+/**
+ * Keypoints less confident than this are not fitted at all
+ */
+constexpr float MIN_CONFIDENCE = 0.1f;
+
+/**
+ * Keypoints need to be at least this confident to measure the bones of the user
+ */
+constexpr float CALIBRATION_CONFIDENCE = 0.5f;
+
+/**
+ * How much a keypoint off by the whole image weighs against a bone off by a
+ * single proportion unit, and against the pose moving a single proportion
+ * unit since the last frame
+ */
+constexpr double W_IMAGE = 100.0;
+constexpr double W_LENGTH = 1.0;
+constexpr double W_SMOOTH = 0.2;
+
+/**
+ * The iterations of a single fit, warm started from the previous frame
+ * it usually converges in two or three
+ */
+constexpr int MAX_ITERATIONS = 10;
+
+/**
+ * The damping at the start of a fit, and how many times it is raised
+ * within a single iteration before giving up
+ */
+constexpr double INITIAL_DAMPING = 1e-3;
+constexpr int MAX_DAMPING_STEPS = 6;
+
+/**
+ * Stop once the largest change of a parameter is smaller than this
+ */
+constexpr double MIN_STEP = 1e-3;
+
+/**
+ * The joints can't get closer to the camera than this, so the projection never
+ * divides by zero
+ */
+constexpr float MIN_DEPTH = 10.0f;
+
+/**
+ * The bones are measured as the longest of most of the frames, their projection
+ * is only shorter than the real length, and the very longest can be outliers
+ */
+constexpr float CALIBRATION_PERCENTILE = 0.9f;
+
+/**
+ * The other side of every bone, the user is measured as symmetric
+ */
+static const int MIRROR_BONE[BONE_COUNT] = {
+    0, 2, 1, 3, 6, 7, 4, 5, 9, 8, 12, 13, 10, 11
+};
+
+/**
+ * The direction of every bone for a user standing in front of the camera with
+ * the arms down, used for bones we don't see when we start
+ */
+static const vector3 REST_DIRECTION[BONE_COUNT] = {
+    { 0, -1, 0 },   // neck
+    { -1, 0, 0 },   // right shoulder
+    { 1, 0, 0 },    // left shoulder
+    { 0, 1, 0 },    // spine
+    { 0, 1, 0 },    // right upper arm
+    { 0, 1, 0 },    // right forearm
+    { 0, 1, 0 },    // left upper arm
+    { 0, 1, 0 },    // left forearm
+    { -1, 0, 0 },   // right pelvis
+    { 1, 0, 0 },    // left pelvis
+    { 0, 1, 0 },    // right thigh
+    { 0, 1, 0 },    // right foreleg
+    { 0, 1, 0 },    // left thigh
+    { 0, 1, 0 },    // left foreleg
+};
+
+/**
+ * Project a point in the camera space to normalized image coordinates
+ */
+static vector2 Project(const vector3& point) {
+    return vector2(0.5f + FOCAL_LENGTH * point.x / point.z, 0.5f + FOCAL_LENGTH * point.y / point.z);
+}
+
+/**
+ * Solve A x = b for a symmetric positive definite A with Cholesky, A is replaced by
+ * its factor. Fails if A is not positive definite.
+ */
+template <int N>
+static bool CholeskySolve(double (&a)[N][N], const double (&b)[N], double (&x)[N]) {
+    for (int j = 0; j < N; j++) {
+        double diagonal = a[j][j];
+        for (int k = 0; k < j; k++) {
+            diagonal -= a[j][k] * a[j][k];
+        }
+        if (diagonal <= 0.0) {
+            return false;
+        }
+        a[j][j] = std::sqrt(diagonal);
+
+        for (int i = j + 1; i < N; i++) {
+            double value = a[i][j];
+            for (int k = 0; k < j; k++) {
+                value -= a[i][k] * a[j][k];
+            }
+            a[i][j] = value / a[j][j];
+        }
+    }
+
+    // forward and back substitution
+    for (int i = 0; i < N; i++) {
+        double value = b[i];
+        for (int k = 0; k < i; k++) {
+            value -= a[i][k] * x[k];
+        }
+        x[i] = value / a[i][i];
+    }
+    for (int i = N - 1; i >= 0; i--) {
+        double value = x[i];
+        for (int k = i + 1; k < N; k++) {
+            value -= a[k][i] * x[k];
+        }
+        x[i] = value / a[i][i];
+    }
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+SkeletonFitter::SkeletonFitter()
+    : paths()
+    , pathLengths()
+{
+    // the root has no bones on its path, every child has the path of its parent and its own
+    for (int bone = 0; bone < BONE_COUNT; bone++) {
+        int parent = BONES[bone].parent;
+        int child = BONES[bone].child;
+        this->paths[child] = this->paths[parent];
+        this->pathLengths[child] = this->pathLengths[parent];
+        this->paths[child][this->pathLengths[child]++] = bone;
+    }
+
+    Reset();
+}
+
+void SkeletonFitter::Reset() {
+    for (int bone = 0; bone < BONE_COUNT; bone++) {
+        this->lengths[bone] = BONES[bone].length;
+    }
+    this->havePrevious = false;
+    this->sampleCounts.fill(0);
+    this->calibrationFrames = 0;
+    this->calibrated = false;
+}
+
+bool SkeletonFitter::IsCalibrated() const {
+    return this->calibrated;
+}
+
+const std::array<float, BONE_COUNT>& SkeletonFitter::GetBoneLengths() const {
+    return this->lengths;
+}
+
+void SkeletonFitter::GetJoints(const std::array<vector3, PARAMETER_BLOCKS>& pose, std::array<vector3, JT_COUNT>& joints) const {
+    joints[SKELETON_ROOT] = pose[0];
+    for (int bone = 0; bone < BONE_COUNT; bone++) {
+        joints[BONES[bone].child] = joints[BONES[bone].parent] + pose[bone + 1];
+    }
+}
+
+double SkeletonFitter::GetCost(const std::array<vector3, PARAMETER_BLOCKS>& pose, const SkeletonObservation& observation) const {
+    std::array<vector3, JT_COUNT> joints;
+    GetJoints(pose, joints);
+
+    double cost = 0.0;
+    for (int joint = 0; joint < JT_COUNT; joint++) {
+        float confidence = observation.confidences[joint];
+        if (confidence < MIN_CONFIDENCE) {
+            continue;
+        }
+        vector2 error = Project(joints[joint]) - observation.points[joint];
+        cost += W_IMAGE * W_IMAGE * confidence * error.dot(error);
+    }
+
+    for (int bone = 0; bone < BONE_COUNT; bone++) {
+        double error = pose[bone + 1].magnitude() - this->lengths[bone];
+        cost += W_LENGTH * W_LENGTH * error * error;
+    }
+
+    // the previous pose is still in the parameters
+    for (int block = 0; block < PARAMETER_BLOCKS; block++) {
+        vector3 change = pose[block] - this->parameters[block];
+        cost += W_SMOOTH * W_SMOOTH * change.dot(change);
+    }
+
+    return cost;
+}
+
+bool SkeletonFitter::Initialize(const SkeletonObservation& observation) {
+    const auto& points = observation.points;
+    const auto& confidences = observation.confidences;
+    if (confidences[SKELETON_ROOT] < MIN_CONFIDENCE) {
+        return false;
+    }
+
+    // the depth is how much smaller the seen bones are than they should be
+    float modelLength = 0;
+    float imageLength = 0;
+    int seenBones = 0;
+    for (int bone = 0; bone < BONE_COUNT; bone++) {
+        int parent = BONES[bone].parent;
+        int child = BONES[bone].child;
+        if (confidences[parent] >= MIN_CONFIDENCE && confidences[child] >= MIN_CONFIDENCE) {
+            modelLength += this->lengths[bone];
+            imageLength += points[parent].distance(points[child]);
+            seenBones++;
+        }
+    }
+    if (seenBones < 3 || imageLength <= 0) {
+        return false;
+    }
+    float depth = std::max(FOCAL_LENGTH * modelLength / imageLength, MIN_DEPTH);
+
+    // put the seen bones flat at that depth, and the rest in the rest pose
+    const vector2& root = points[SKELETON_ROOT];
+    this->parameters[0] = vector3((root.x - 0.5f) * depth / FOCAL_LENGTH, (root.y - 0.5f) * depth / FOCAL_LENGTH, depth);
+    for (int bone = 0; bone < BONE_COUNT; bone++) {
+        int parent = BONES[bone].parent;
+        int child = BONES[bone].child;
+
+        vector3 direction = REST_DIRECTION[bone] * this->lengths[bone];
+        if (confidences[parent] >= MIN_CONFIDENCE && confidences[child] >= MIN_CONFIDENCE) {
+            vector2 delta = (points[child] - points[parent]) * (depth / FOCAL_LENGTH);
+            if (delta.magnitude() > this->lengths[bone] * 0.01f) {
+                direction = vector3(delta.x, delta.y, 0);
+            }
+        }
+        this->parameters[bone + 1] = direction;
+    }
+
+    this->havePrevious = true;
+    return true;
+}
+
+bool SkeletonFitter::Fit(const SkeletonObservation& observation, std::array<vector3, JT_COUNT>& joints) {
+    if (!this->havePrevious && !Initialize(observation)) {
+        return false;
+    }
+
+    constexpr int N = PARAMETER_COUNT;
+    std::array<vector3, PARAMETER_BLOCKS> pose = this->parameters;
+    double cost = GetCost(pose, observation);
+    double damping = INITIAL_DAMPING;
+
+    for (int iteration = 0; iteration < MAX_ITERATIONS; iteration++) {
+        GetJoints(pose, joints);
+
+        // build the normal equations, every 3x3 block belongs to the root or a bone
+        double hessian[N][N] = {};
+        double gradient[N] = {};
+
+        for (int joint = 0; joint < JT_COUNT; joint++) {
+            float confidence = observation.confidences[joint];
+            if (confidence < MIN_CONFIDENCE) {
+                continue;
+            }
+
+            // the projection moves the same with the root and any bone on the path to the joint
+            const vector3& point = joints[joint];
+            double weight = W_IMAGE * std::sqrt(confidence);
+            double scale = weight * FOCAL_LENGTH / point.z;
+            double jacobian[2][3] = {
+                { scale, 0, -scale * point.x / point.z },
+                { 0, scale, -scale * point.y / point.z },
+            };
+            vector2 projected = Project(point);
+            double error[2] = {
+                weight * (projected.x - observation.points[joint].x),
+                weight * (projected.y - observation.points[joint].y),
+            };
+
+            double block[3][3];
+            double blockGradient[3];
+            for (int i = 0; i < 3; i++) {
+                for (int j = 0; j < 3; j++) {
+                    block[i][j] = jacobian[0][i] * jacobian[0][j] + jacobian[1][i] * jacobian[1][j];
+                }
+                blockGradient[i] = jacobian[0][i] * error[0] + jacobian[1][i] * error[1];
+            }
+
+            int blocks[BONE_COUNT + 1];
+            int blockCount = 0;
+            blocks[blockCount++] = 0;
+            for (int i = 0; i < this->pathLengths[joint]; i++) {
+                blocks[blockCount++] = (this->paths[joint][i] + 1) * 3;
+            }
+
+            for (int a = 0; a < blockCount; a++) {
+                for (int i = 0; i < 3; i++) {
+                    gradient[blocks[a] + i] += blockGradient[i];
+                    for (int b = 0; b < blockCount; b++) {
+                        for (int j = 0; j < 3; j++) {
+                            hessian[blocks[a] + i][blocks[b] + j] += block[i][j];
+                        }
+                    }
+                }
+            }
+        }
+
+        for (int bone = 0; bone < BONE_COUNT; bone++) {
+            const vector3& vector = pose[bone + 1];
+            double length = std::max(vector.magnitude(), 1e-6f);
+            double jacobian[3] = { W_LENGTH * vector.x / length, W_LENGTH * vector.y / length, W_LENGTH * vector.z / length };
+            double error = W_LENGTH * (length - this->lengths[bone]);
+
+            int offset = (bone + 1) * 3;
+            for (int i = 0; i < 3; i++) {
+                gradient[offset + i] += jacobian[i] * error;
+                for (int j = 0; j < 3; j++) {
+                    hessian[offset + i][offset + j] += jacobian[i] * jacobian[j];
+                }
+            }
+        }
+
+        for (int block = 0; block < PARAMETER_BLOCKS; block++) {
+            vector3 change = pose[block] - this->parameters[block];
+            double values[3] = { change.x, change.y, change.z };
+            for (int i = 0; i < 3; i++) {
+                gradient[block * 3 + i] += W_SMOOTH * W_SMOOTH * values[i];
+                hessian[block * 3 + i][block * 3 + i] += W_SMOOTH * W_SMOOTH;
+            }
+        }
+
+        double negativeGradient[N];
+        for (int i = 0; i < N; i++) {
+            negativeGradient[i] = -gradient[i];
+        }
+
+        // raise the damping until the step makes things better
+        bool accepted = false;
+        double largestStep = 0.0;
+        for (int attempt = 0; attempt < MAX_DAMPING_STEPS && !accepted; attempt++) {
+            double damped[N][N];
+            std::copy(&hessian[0][0], &hessian[0][0] + N * N, &damped[0][0]);
+            for (int i = 0; i < N; i++) {
+                damped[i][i] += damping * hessian[i][i];
+            }
+
+            double step[N];
+            if (!CholeskySolve<N>(damped, negativeGradient, step)) {
+                damping *= 10.0;
+                continue;
+            }
+
+            std::array<vector3, PARAMETER_BLOCKS> candidate = pose;
+            largestStep = 0.0;
+            for (int block = 0; block < PARAMETER_BLOCKS; block++) {
+                candidate[block] += vector3(step[block * 3], step[block * 3 + 1], step[block * 3 + 2]);
+                for (int i = 0; i < 3; i++) {
+                    largestStep = std::max(largestStep, std::abs(step[block * 3 + i]));
+                }
+            }
+
+            // nothing may end up behind the camera
+            std::array<vector3, JT_COUNT> candidateJoints;
+            GetJoints(candidate, candidateJoints);
+            bool inFront = std::all_of(candidateJoints.begin(), candidateJoints.end(), [](const vector3& joint) {
+                return joint.z >= MIN_DEPTH;
+            });
+
+            double candidateCost = inFront ? GetCost(candidate, observation) : cost;
+            if (inFront && candidateCost < cost) {
+                pose = candidate;
+                cost = candidateCost;
+                damping = std::max(damping / 10.0, 1e-7);
+                accepted = true;
+            } else {
+                damping *= 10.0;
+            }
+        }
+
+        if (!accepted || largestStep < MIN_STEP) {
+            break;
+        }
+    }
+
+    this->parameters = pose;
+    GetJoints(pose, joints);
+
+    if (!this->calibrated) {
+        Calibrate(joints, observation);
+    }
+    return true;
+}
+
+void SkeletonFitter::Calibrate(const std::array<vector3, JT_COUNT>& joints, const SkeletonObservation& observation) {
+    const auto& confidences = observation.confidences;
+    if (confidences[SKELETON_ROOT] < CALIBRATION_CONFIDENCE) {
+        return;
+    }
+
+    // the projection of the bone at its fitted depth is never longer than the bone,
+    // so the bone is about the longest of them
+    for (int bone = 0; bone < BONE_COUNT; bone++) {
+        int parent = BONES[bone].parent;
+        int child = BONES[bone].child;
+        if (confidences[parent] < CALIBRATION_CONFIDENCE || confidences[child] < CALIBRATION_CONFIDENCE) {
+            continue;
+        }
+
+        float depth = (joints[parent].z + joints[child].z) / 2;
+        float length = observation.points[parent].distance(observation.points[child]) * depth / FOCAL_LENGTH;
+        if (this->sampleCounts[bone] < CALIBRATION_FRAMES) {
+            this->samples[bone][this->sampleCounts[bone]++] = length;
+        }
+    }
+
+    if (++this->calibrationFrames < CALIBRATION_FRAMES) {
+        return;
+    }
+
+    // bones we barely saw keep the average proportions
+    std::array<float, BONE_COUNT> measured;
+    for (int bone = 0; bone < BONE_COUNT; bone++) {
+        int count = this->sampleCounts[bone];
+        measured[bone] = BONES[bone].length;
+        if (count >= CALIBRATION_FRAMES / 4) {
+            auto& boneSamples = this->samples[bone];
+            int index = std::min(static_cast<int>(count * CALIBRATION_PERCENTILE), count - 1);
+            std::nth_element(boneSamples.begin(), boneSamples.begin() + index, boneSamples.begin() + count);
+            measured[bone] = boneSamples[index];
+        }
+    }
+
+    // a single camera can't tell how big the user is, only the proportions, so
+    // keep the total size of the average person
+    float modelTotal = 0;
+    float measuredTotal = 0;
+    for (int bone = 0; bone < BONE_COUNT; bone++) {
+        this->lengths[bone] = (measured[bone] + measured[MIRROR_BONE[bone]]) / 2;
+        modelTotal += BONES[bone].length;
+        measuredTotal += this->lengths[bone];
+    }
+    for (int bone = 0; bone < BONE_COUNT; bone++) {
+        this->lengths[bone] *= modelTotal / measuredTotal;
+    }
+
+    // start over with the new lengths, the old pose was bent to fit the old ones
+    this->havePrevious = false;
+    this->calibrated = true;
+}
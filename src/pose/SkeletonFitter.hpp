@@ -0,0 +1,113 @@
+#pragma once
+
+#include <array>
+
+#include <math/vector2.hpp>
+#include <math/vector3.hpp>
+
+#include "Joints.hpp"
+#include "Skeleton.hpp"
+
+/**
+ * The 2d keypoints of a single person, in normalized image coordinates
+ */
+struct SkeletonObservation {
+    std::array<vector2, JT_COUNT> points;
+    std::array<float, JT_COUNT> confidences;
+};
+
+/**
+ * Fits the skeleton of a single user to the 2d keypoints of every frame.
+ *
+ * The pose is the position of the root joint and a vector for every bone, in
+ * the space of the camera (x right, y down, z forward) in body proportion units.
+ * Every frame it is refined with Levenberg-Marquardt, starting from the pose of
+ * the previous frame, so the projected joints match the keypoints, the bones
+ * keep their lengths, and the pose does not jump around between frames.
+ *
+ * During the first frames the bone lengths of the user are estimated from the
+ * fitted poses, after that they are fixed.
+ */
+class SkeletonFitter {
+public:
+    /**
+     * The root position and a vector for every bone
+     */
+    static constexpr int PARAMETER_BLOCKS = BONE_COUNT + 1;
+    static constexpr int PARAMETER_COUNT = PARAMETER_BLOCKS * 3;
+
+    /**
+     * How many frames the bone lengths are estimated from
+     */
+    static constexpr int CALIBRATION_FRAMES = 60;
+
+private:
+    /**
+     * The bones between the root and every joint
+     */
+    std::array<std::array<int, BONE_COUNT>, JT_COUNT> paths;
+    std::array<int, JT_COUNT> pathLengths;
+
+    /**
+     * The length of every bone, the average proportions until calibrated
+     */
+    std::array<float, BONE_COUNT> lengths;
+
+    /**
+     * The pose of the previous frame, the fit starts from it
+     */
+    std::array<vector3, PARAMETER_BLOCKS> parameters;
+    bool havePrevious;
+
+    /**
+     * The bone lengths seen on the frames of the calibration window
+     */
+    std::array<std::array<float, CALIBRATION_FRAMES>, BONE_COUNT> samples;
+    std::array<int, BONE_COUNT> sampleCounts;
+    int calibrationFrames;
+    bool calibrated;
+
+    /**
+     * Start from the keypoints alone, when there is no previous pose
+     */
+    bool Initialize(const SkeletonObservation& observation);
+
+    /**
+     * Get the joint positions from the parameters
+     */
+    void GetJoints(const std::array<vector3, PARAMETER_BLOCKS>& pose, std::array<vector3, JT_COUNT>& joints) const;
+
+    /**
+     * The weighted sum of squared residuals of a pose
+     */
+    double GetCost(const std::array<vector3, PARAMETER_BLOCKS>& pose, const SkeletonObservation& observation) const;
+
+    /**
+     * Take the bone lengths of a fitted frame, and once we have enough of
+     * them fix the lengths of the user
+     */
+    void Calibrate(const std::array<vector3, JT_COUNT>& joints, const SkeletonObservation& observation);
+
+public:
+
+    SkeletonFitter();
+
+    /**
+     * Forget the previous pose and the bone lengths, for when a different
+     * person is tracked
+     */
+    void Reset();
+
+    /**
+     * Fit the skeleton to the keypoints of this frame
+     *
+     * @param observation   [IN]    The keypoints
+     * @param joints        [OUT]   The fitted joint positions
+     *
+     * @return False if there is not enough to go on, the joints are not set
+     */
+    bool Fit(const SkeletonObservation& observation, std::array<vector3, JT_COUNT>& joints);
+
+    bool IsCalibrated() const;
+    const std::array<float, BONE_COUNT>& GetBoneLengths() const;
+};
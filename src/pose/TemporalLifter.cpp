@@ -0,0 +1,447 @@
+#include <algorithm>
+#include <fstream>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+#endif
+
+#include "TemporalLifter.hpp"
+#include "Skeleton.hpp"
+
+/**
+ * The first bytes of a model, "PMLF"
+ */
+constexpr uint32_t LIFTER_MAGIC = 0x464C4D50;
+constexpr uint32_t LIFTER_VERSION = 1;
+
+/**
+ * The most channels we accept, anything bigger is not going to run in time anyways
+ */
+constexpr uint32_t MAX_CHANNELS = 4096;
+
+/**
+ * A person not seen for this long, in microseconds, starts from a fresh history
+ */
+constexpr int64_t MAX_GAP = 200000;
+
+/**
+ * How many of the joints must have been found to lift a frame
+ */
+constexpr int MIN_JOINTS = JT_COUNT / 2;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Kernels
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * output[o] += weights[i][o] * input[i] over all the inputs, the outputs must be
+ * a multiple of 4. The outputs are kept in registers 16 at a time while going
+ * over the inputs, so every weight is loaded exactly once.
+ */
+static void MultiplyAccumulate(const float* weights, const float* input, int inputs, int outputs, float* output) {
+    int o = 0;
+
+#if defined(__SSE2__) || defined(_M_X64)
+    for (; o + 16 <= outputs; o += 16) {
+        __m128 a0 = _mm_loadu_ps(output + o);
+        __m128 a1 = _mm_loadu_ps(output + o + 4);
+        __m128 a2 = _mm_loadu_ps(output + o + 8);
+        __m128 a3 = _mm_loadu_ps(output + o + 12);
+        const float* row = weights + o;
+        for (int i = 0; i < inputs; i++, row += outputs) {
+            __m128 x = _mm_set1_ps(input[i]);
+            a0 = _mm_add_ps(a0, _mm_mul_ps(_mm_loadu_ps(row), x));
+            a1 = _mm_add_ps(a1, _mm_mul_ps(_mm_loadu_ps(row + 4), x));
+            a2 = _mm_add_ps(a2, _mm_mul_ps(_mm_loadu_ps(row + 8), x));
+            a3 = _mm_add_ps(a3, _mm_mul_ps(_mm_loadu_ps(row + 12), x));
+        }
+        _mm_storeu_ps(output + o, a0);
+        _mm_storeu_ps(output + o + 4, a1);
+        _mm_storeu_ps(output + o + 8, a2);
+        _mm_storeu_ps(output + o + 12, a3);
+    }
+    for (; o + 4 <= outputs; o += 4) {
+        __m128 a0 = _mm_loadu_ps(output + o);
+        const float* row = weights + o;
+        for (int i = 0; i < inputs; i++, row += outputs) {
+            a0 = _mm_add_ps(a0, _mm_mul_ps(_mm_loadu_ps(row), _mm_set1_ps(input[i])));
+        }
+        _mm_storeu_ps(output + o, a0);
+    }
+#elif defined(__ARM_NEON)
+    for (; o + 16 <= outputs; o += 16) {
+        float32x4_t a0 = vld1q_f32(output + o);
+        float32x4_t a1 = vld1q_f32(output + o + 4);
+        float32x4_t a2 = vld1q_f32(output + o + 8);
+        float32x4_t a3 = vld1q_f32(output + o + 12);
+        const float* row = weights + o;
+        for (int i = 0; i < inputs; i++, row += outputs) {
+            float32x4_t x = vdupq_n_f32(input[i]);
+            a0 = vmlaq_f32(a0, vld1q_f32(row), x);
+            a1 = vmlaq_f32(a1, vld1q_f32(row + 4), x);
+            a2 = vmlaq_f32(a2, vld1q_f32(row + 8), x);
+            a3 = vmlaq_f32(a3, vld1q_f32(row + 12), x);
+        }
+        vst1q_f32(output + o, a0);
+        vst1q_f32(output + o + 4, a1);
+        vst1q_f32(output + o + 8, a2);
+        vst1q_f32(output + o + 12, a3);
+    }
+    for (; o + 4 <= outputs; o += 4) {
+        float32x4_t a0 = vld1q_f32(output + o);
+        const float* row = weights + o;
+        for (int i = 0; i < inputs; i++, row += outputs) {
+            a0 = vmlaq_f32(a0, vld1q_f32(row), vdupq_n_f32(input[i]));
+        }
+        vst1q_f32(output + o, a0);
+    }
+#endif
+
+    for (; o < outputs; o++) {
+        float sum = output[o];
+        for (int i = 0; i < inputs; i++) {
+            sum += weights[i * outputs + o] * input[i];
+        }
+        output[o] = sum;
+    }
+}
+
+/**
+ * Run a convolution for the newest frame
+ *
+ * @param layer     [IN]    The layer
+ * @param taps      [IN]    The input of every tap, the oldest frame first
+ * @param output    [OUT]   The outputs, layer.stride of them
+ */
+static void RunLayer(const LifterLayer& layer, const float* const* taps, float* output) {
+    std::copy(layer.bias.begin(), layer.bias.end(), output);
+    for (int tap = 0; tap < layer.taps; tap++) {
+        const float* weights = layer.weights.data() + static_cast<size_t>(tap) * layer.inputs * layer.stride;
+        MultiplyAccumulate(weights, taps[tap], layer.inputs, layer.stride, output);
+    }
+}
+
+static void Relu(float* values, int count) {
+    for (int i = 0; i < count; i++) {
+        values[i] = std::max(values[i], 0.0f);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Model
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+static bool ReadValue(std::ifstream& file, T& value) {
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+/**
+ * Read a convolution and lay it out the way we run it
+ */
+static bool ReadLayer(std::ifstream& file, LifterLayer& layer, int inputs, int outputs, int taps, int dilation) {
+    layer.inputs = inputs;
+    layer.outputs = outputs;
+    layer.stride = (outputs + 3) & ~3;
+    layer.taps = taps;
+    layer.dilation = dilation;
+
+    std::vector<float> weights(static_cast<size_t>(outputs) * inputs * taps);
+    if (!file.read(reinterpret_cast<char*>(weights.data()), static_cast<std::streamsize>(weights.size() * sizeof(float)))) {
+        return false;
+    }
+
+    layer.weights.assign(static_cast<size_t>(taps) * inputs * layer.stride, 0.0f);
+    for (int o = 0; o < outputs; o++) {
+        for (int i = 0; i < inputs; i++) {
+            for (int tap = 0; tap < taps; tap++) {
+                float weight = weights[(static_cast<size_t>(o) * inputs + i) * taps + tap];
+                layer.weights[(static_cast<size_t>(tap) * inputs + i) * layer.stride + o] = weight;
+            }
+        }
+    }
+
+    layer.bias.assign(layer.stride, 0.0f);
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(layer.bias.data()), static_cast<std::streamsize>(outputs * sizeof(float))));
+}
+
+LifterModel::LifterModel()
+    : channels(0)
+    , blocks(0)
+    , width(0)
+    , scale(1.0f)
+    , expand()
+    , dilated()
+    , pointwise()
+    , shrink()
+    , loaded(false)
+{
+}
+
+bool LifterModel::Load(const std::string& path) {
+    this->loaded = false;
+
+    std::ifstream file(path, std::ios::binary);
+    uint32_t magic, version, channelCount, blockCount, filterWidth;
+    if (!file || !ReadValue(file, magic) || magic != LIFTER_MAGIC
+            || !ReadValue(file, version) || version != LIFTER_VERSION
+            || !ReadValue(file, channelCount) || !ReadValue(file, blockCount)
+            || !ReadValue(file, filterWidth) || !ReadValue(file, this->scale)) {
+        return false;
+    }
+
+    if (channelCount == 0 || channelCount % 4 != 0 || channelCount > MAX_CHANNELS
+            || blockCount == 0 || blockCount > MAX_BLOCKS || filterWidth < 2 || filterWidth > MAX_WIDTH) {
+        return false;
+    }
+    this->channels = static_cast<int>(channelCount);
+    this->blocks = static_cast<int>(blockCount);
+    this->width = static_cast<int>(filterWidth);
+
+    if (!ReadLayer(file, this->expand, INPUTS, this->channels, this->width, 1)) {
+        return false;
+    }
+
+    int dilation = this->width;
+    for (int block = 0; block < this->blocks; block++) {
+        if (!ReadLayer(file, this->dilated[block], this->channels, this->channels, this->width, dilation)
+                || !ReadLayer(file, this->pointwise[block], this->channels, this->channels, 1, 1)) {
+            return false;
+        }
+        dilation *= this->width;
+    }
+
+    if (!ReadLayer(file, this->shrink, this->channels, OUTPUTS, 1, 1)) {
+        return false;
+    }
+
+    // anything left over means the file was made for a different layout
+    this->loaded = file.peek() == std::ifstream::traits_type::eof();
+    return this->loaded;
+}
+
+bool LifterModel::IsLoaded() const {
+    return this->loaded;
+}
+
+int LifterModel::GetChannels() const {
+    return this->channels;
+}
+
+int LifterModel::GetBlocks() const {
+    return this->blocks;
+}
+
+int LifterModel::GetWidth() const {
+    return this->width;
+}
+
+float LifterModel::GetScale() const {
+    return this->scale;
+}
+
+int LifterModel::GetReceptiveField() const {
+    int field = this->width;
+    for (int block = 0; block < this->blocks; block++) {
+        field *= this->width;
+    }
+    return field;
+}
+
+const LifterLayer& LifterModel::GetExpand() const {
+    return this->expand;
+}
+
+const LifterLayer& LifterModel::GetDilated(int block) const {
+    return this->dilated[block];
+}
+
+const LifterLayer& LifterModel::GetPointwise(int block) const {
+    return this->pointwise[block];
+}
+
+const LifterLayer& LifterModel::GetShrink() const {
+    return this->shrink;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Lifter
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+TemporalLifter::TemporalLifter()
+    : model(nullptr)
+    , history()
+    , ringOffsets()
+    , ringSizes()
+    , ringWidths()
+    , hidden()
+    , top()
+    , output()
+    , frames(0)
+    , primed(false)
+    , lastTime(0)
+    , lastPoints()
+    , seen()
+{
+}
+
+void TemporalLifter::SetModel(const LifterModel* lifterModel) {
+    this->model = lifterModel != nullptr && lifterModel->IsLoaded() ? lifterModel : nullptr;
+    if (this->model == nullptr) {
+        return;
+    }
+
+    // the inputs, then the input of every block, each as long as the layer reading it looks back
+    int channels = this->model->GetChannels();
+    size_t total = 0;
+    for (int ring = 0; ring <= this->model->GetBlocks(); ring++) {
+        const LifterLayer& reader = ring == 0 ? this->model->GetExpand() : this->model->GetDilated(ring - 1);
+        this->ringSizes[ring] = (reader.taps - 1) * reader.dilation + 1;
+        this->ringWidths[ring] = ring == 0 ? LifterModel::INPUTS : channels;
+        this->ringOffsets[ring] = total;
+        total += static_cast<size_t>(this->ringSizes[ring]) * this->ringWidths[ring];
+    }
+
+    this->history.assign(total, 0.0f);
+    this->hidden.assign(channels, 0.0f);
+    this->top.assign(channels, 0.0f);
+    this->output.assign(this->model->GetShrink().stride, 0.0f);
+    Reset();
+}
+
+bool TemporalLifter::IsReady() const {
+    return this->model != nullptr;
+}
+
+void TemporalLifter::Reset() {
+    this->frames = 0;
+    this->primed = false;
+    this->seen.fill(false);
+}
+
+float* TemporalLifter::GetRow(int ring, int64_t frame) {
+    int64_t size = this->ringSizes[ring];
+    int64_t slot = ((frame % size) + size) % size;
+    return this->history.data() + this->ringOffsets[ring] + static_cast<size_t>(slot) * this->ringWidths[ring];
+}
+
+void TemporalLifter::StoreRow(int ring, const float* row) {
+    int width = this->ringWidths[ring];
+    if (this->primed) {
+        std::copy(row, row + width, GetRow(ring, this->frames));
+        return;
+    }
+
+    for (int slot = 0; slot < this->ringSizes[ring]; slot++) {
+        std::copy(row, row + width, GetRow(ring, slot));
+    }
+}
+
+bool TemporalLifter::Lift(int64_t time, const SkeletonObservation& observation, std::array<vector3, JT_COUNT>& joints) {
+    if (this->model == nullptr) {
+        return false;
+    }
+
+    int found = 0;
+    for (float confidence : observation.confidences) {
+        found += confidence > 0.0f ? 1 : 0;
+    }
+    if (found < MIN_JOINTS) {
+        return false;
+    }
+
+    if (time - this->lastTime > MAX_GAP) {
+        Reset();
+    }
+    this->lastTime = time;
+
+    // the joints the network missed stay where they were last seen
+    float input[LifterModel::INPUTS];
+    for (int i = 0; i < JT_COUNT; i++) {
+        if (observation.confidences[i] > 0.0f) {
+            this->lastPoints[i] = observation.points[i];
+            this->seen[i] = true;
+        }
+        const vector2& point = this->seen[i] ? this->lastPoints[i] : observation.points[i];
+        input[i * 2] = point.x;
+        input[i * 2 + 1] = point.y;
+    }
+    StoreRow(0, input);
+
+    // every layer only runs for the newest frame, the older ones are in the rings
+    const float* taps[LifterModel::MAX_WIDTH];
+    int blocks = this->model->GetBlocks();
+    int channels = this->model->GetChannels();
+    for (int layer = 0; layer <= blocks; layer++) {
+        const LifterLayer& conv = layer == 0 ? this->model->GetExpand() : this->model->GetDilated(layer - 1);
+        for (int tap = 0; tap < conv.taps; tap++) {
+            taps[tap] = GetRow(layer, this->frames - static_cast<int64_t>(conv.taps - 1 - tap) * conv.dilation);
+        }
+
+        // the expansion goes right into the ring of the first block
+        if (layer == 0) {
+            RunLayer(conv, taps, this->hidden.data());
+            Relu(this->hidden.data(), channels);
+            StoreRow(1, this->hidden.data());
+            continue;
+        }
+
+        // a residual block adds to its input of the newest frame
+        RunLayer(conv, taps, this->hidden.data());
+        Relu(this->hidden.data(), channels);
+        const float* hiddenRow = this->hidden.data();
+        RunLayer(this->model->GetPointwise(layer - 1), &hiddenRow, this->top.data());
+        Relu(this->top.data(), channels);
+
+        const float* residual = taps[conv.taps - 1];
+        for (int i = 0; i < channels; i++) {
+            this->top[i] += residual[i];
+        }
+        if (layer < blocks) {
+            StoreRow(layer + 1, this->top.data());
+        }
+    }
+
+    const float* topRow = this->top.data();
+    RunLayer(this->model->GetShrink(), &topRow, this->output.data());
+    this->frames++;
+    this->primed = true;
+
+    // the network gives the joints relative to the collarbone
+    std::array<vector3, JT_COUNT> relative;
+    float scale = this->model->GetScale();
+    for (int i = 0; i < JT_COUNT; i++) {
+        relative[i] = vector3(this->output[i * 3], this->output[i * 3 + 1], this->output[i * 3 + 2]) * scale;
+    }
+    vector3 root = relative[SKELETON_ROOT];
+    for (auto& joint : relative) {
+        joint -= root;
+    }
+
+    // the depth is where the bones project to the length the keypoints have
+    float length3d = 0.0f;
+    float length2d = 0.0f;
+    for (const auto& bone : BONES) {
+        if (observation.confidences[bone.parent] <= 0.0f || observation.confidences[bone.child] <= 0.0f) {
+            continue;
+        }
+        vector3 bone3d = relative[bone.child] - relative[bone.parent];
+        vector2 bone2d = observation.points[bone.child] - observation.points[bone.parent];
+        length3d += std::sqrt(bone3d.x * bone3d.x + bone3d.y * bone3d.y);
+        length2d += bone2d.magnitude();
+    }
+    if (length2d < 1e-6f || length3d < 1e-6f) {
+        return false;
+    }
+
+    float depth = FOCAL_LENGTH * length3d / length2d;
+    const vector2& rootPoint = this->seen[SKELETON_ROOT] ? this->lastPoints[SKELETON_ROOT] : observation.points[SKELETON_ROOT];
+    vector3 position((rootPoint.x - 0.5f) * depth / FOCAL_LENGTH, (rootPoint.y - 0.5f) * depth / FOCAL_LENGTH, depth);
+    for (int i = 0; i < JT_COUNT; i++) {
+        joints[i] = position + relative[i];
+    }
+    return true;
+}
@@ -0,0 +1,191 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <array>
+
+#include <math/vector3.hpp>
+
+#include "SkeletonFitter.hpp"
+#include "Joints.hpp"
+
+/**
+ * A convolution of the lifting network, for the newest frame only
+ */
+struct LifterLayer {
+    /**
+     * Kept as [tap][in][out], so the outputs of a single input are next to each
+     * other, with the outputs padded with zeroes to a multiple of 4
+     */
+    std::vector<float> weights;
+    std::vector<float> bias;
+
+    int inputs = 0;
+    int outputs = 0;
+    int stride = 0;
+
+    /**
+     * How many frames it looks at, and how far apart they are
+     */
+    int taps = 0;
+    int dilation = 1;
+};
+
+/**
+ * The weights of a temporal lifting network like VideoPose3D, a small stack of 1D
+ * convolutions over the 2d keypoints of the last frames, with the batch norms folded
+ * into the convolutions. It is loaded once and shared by everyone it lifts.
+ *
+ * The file is little endian:
+ *      uint32  magic "PMLF"
+ *      uint32  version
+ *      uint32  channels, a multiple of 4
+ *      uint32  blocks
+ *      uint32  width of the filters
+ *      float   scale from the outputs to body proportion units
+ *
+ * And then every convolution as weights[out][in][tap] followed by bias[out], the
+ * first tap is the oldest frame:
+ *      expand      x, y of our joints to channels
+ *      per block   a dilated convolution and a 1x1 convolution, channels to channels
+ *      shrink      1x1, channels to x, y, z of our joints relative to the collarbone
+ *
+ * Block b is dilated by width^(b+1), so the network sees width^(blocks+1) frames,
+ * 27 with 3 wide filters and 2 blocks. tools/lifter-export/export.py makes one from
+ * a causal VideoPose3D checkpoint.
+ */
+class LifterModel {
+public:
+    static constexpr int INPUTS = JT_COUNT * 2;
+    static constexpr int OUTPUTS = JT_COUNT * 3;
+    static constexpr int MAX_BLOCKS = 4;
+    static constexpr int MAX_WIDTH = 9;
+
+private:
+    int channels;
+    int blocks;
+    int width;
+    float scale;
+
+    LifterLayer expand;
+    std::array<LifterLayer, MAX_BLOCKS> dilated;
+    std::array<LifterLayer, MAX_BLOCKS> pointwise;
+    LifterLayer shrink;
+
+    bool loaded;
+
+public:
+
+    LifterModel();
+
+    /**
+     * Load the weights, the model is left unloaded if the file is not valid
+     */
+    bool Load(const std::string& path);
+
+    bool IsLoaded() const;
+
+    int GetChannels() const;
+    int GetBlocks() const;
+    int GetWidth() const;
+    float GetScale() const;
+
+    /**
+     * How many frames the output depends on
+     */
+    int GetReceptiveField() const;
+
+    const LifterLayer& GetExpand() const;
+    const LifterLayer& GetDilated(int block) const;
+    const LifterLayer& GetPointwise(int block) const;
+    const LifterLayer& GetShrink() const;
+};
+
+/**
+ * Lifts the 2d keypoints of a single person to 3d with a LifterModel, from the
+ * keypoints of their last frames.
+ *
+ * The network is causal, the newest frame is the last one it sees, so it adds no
+ * delay. Every layer keeps a ring of its outputs for as far back as the next layer
+ * looks, so a new frame only runs every layer once, for the newest frame, instead
+ * of running the whole window again. Until the history fills up the first frame
+ * stands in for the frames before it.
+ *
+ * The joints come out like the ones of the skeleton fitting, in the space of the
+ * camera (x right, y down, z forward) in body proportion units.
+ */
+class TemporalLifter {
+private:
+    const LifterModel* model;
+
+    /**
+     * The rings of the inputs and of the input of every block, in one allocation,
+     * and the output of the last block, which is only needed for the newest frame
+     */
+    std::vector<float> history;
+    std::array<size_t, LifterModel::MAX_BLOCKS + 1> ringOffsets;
+    std::array<int, LifterModel::MAX_BLOCKS + 1> ringSizes;
+    std::array<int, LifterModel::MAX_BLOCKS + 1> ringWidths;
+    std::vector<float> hidden;
+    std::vector<float> top;
+    std::vector<float> output;
+
+    /**
+     * How many frames went in since the history was reset, and was
+     * the history filled with the first of them yet
+     */
+    int64_t frames;
+    bool primed;
+
+    /**
+     * When the last frame went in, a person that was gone
+     * for a while starts from a fresh history
+     */
+    int64_t lastTime;
+
+    /**
+     * Where every joint was last seen, a joint the network missed stays there
+     */
+    std::array<vector2, JT_COUNT> lastPoints;
+    std::array<bool, JT_COUNT> seen;
+
+    /**
+     * Get the row of a ring for a frame
+     */
+    float* GetRow(int ring, int64_t frame);
+
+    /**
+     * Store the row of the newest frame, and the same row for all the frames
+     * before it while the history is filling up for the first time
+     */
+    void StoreRow(int ring, const float* row);
+
+public:
+
+    TemporalLifter();
+
+    /**
+     * Use the given model, this allocates the history and
+     * must be done before the pipeline starts
+     */
+    void SetModel(const LifterModel* lifterModel);
+
+    bool IsReady() const;
+
+    /**
+     * Forget the history, for when a slot gets a different person
+     */
+    void Reset();
+
+    /**
+     * Lift the newest frame of the person
+     *
+     * @param time          [IN]    When the frame was captured, in microseconds
+     * @param observation   [IN]    The keypoints of the frame
+     * @param joints        [OUT]   The joints
+     *
+     * @return False if there were not enough keypoints, the frame is not added to the history
+     */
+    bool Lift(int64_t time, const SkeletonObservation& observation, std::array<vector3, JT_COUNT>& joints);
+};
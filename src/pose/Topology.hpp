@@ -0,0 +1,162 @@
+#pragma once
+
+#include <type_traits>
+#include <algorithm>
+#include <utility>
+#include <array>
+
+#include <math/vector2.hpp>
+
+#include "Joints.hpp"
+
+/**
+ * Where one of our joints comes from in the keypoints of a network, the middle
+ * of two keypoints, or the same keypoint twice when the network has the joint
+ */
+struct KeypointSource {
+    int first;
+    int second;
+};
+
+/**
+ * The keypoint formats of the networks we can use. A topology has the amount of
+ * keypoints, and for every one of our joints, in order, the keypoints it comes from.
+ *
+ * The topology is a template parameter of everything that maps keypoints, so
+ * the mapping is unrolled at compile time and checked with a static_assert.
+ */
+
+/**
+ * The 18 keypoints of COCO the way HyperPose and OpenPose order them, with a neck
+ */
+struct CocoTopology {
+    static constexpr int KEYPOINT_COUNT = 18;
+    static constexpr KeypointSource JOINTS[] = {
+        { 0, 0 },       // head - nose
+        { 1, 1 },       // collarbone - neck
+        { 8, 11 },      // tailbone - both hips
+        { 2, 2 },       // right shoulder
+        { 5, 5 },       // left shoulder
+        { 8, 8 },       // right hip
+        { 11, 11 },     // left hip
+        { 3, 3 },       // right elbow
+        { 6, 6 },       // left elbow
+        { 9, 9 },       // right knee
+        { 12, 12 },     // left knee
+        { 4, 4 },       // right wrist
+        { 7, 7 },       // left wrist
+        { 10, 10 },     // right ankle
+        { 13, 13 },     // left ankle
+    };
+};
+
+/**
+ * The 17 keypoints of the COCO dataset, which most of the lighter models use,
+ * without a neck
+ */
+struct Coco17Topology {
+    static constexpr int KEYPOINT_COUNT = 17;
+    static constexpr KeypointSource JOINTS[] = {
+        { 0, 0 },       // head - nose
+        { 5, 6 },       // collarbone - both shoulders
+        { 11, 12 },     // tailbone - both hips
+        { 6, 6 },       // right shoulder
+        { 5, 5 },       // left shoulder
+        { 12, 12 },     // right hip
+        { 11, 11 },     // left hip
+        { 8, 8 },       // right elbow
+        { 7, 7 },       // left elbow
+        { 14, 14 },     // right knee
+        { 13, 13 },     // left knee
+        { 10, 10 },     // right wrist
+        { 9, 9 },       // left wrist
+        { 16, 16 },     // right ankle
+        { 15, 15 },     // left ankle
+    };
+};
+
+/**
+ * The 25 keypoints of OpenPose BODY_25, which adds the middle of the hips and the feet
+ */
+struct Body25Topology {
+    static constexpr int KEYPOINT_COUNT = 25;
+    static constexpr KeypointSource JOINTS[] = {
+        { 0, 0 },       // head - nose
+        { 1, 1 },       // collarbone - neck
+        { 8, 8 },       // tailbone - middle of the hips
+        { 2, 2 },       // right shoulder
+        { 5, 5 },       // left shoulder
+        { 9, 9 },       // right hip
+        { 12, 12 },     // left hip
+        { 3, 3 },       // right elbow
+        { 6, 6 },       // left elbow
+        { 10, 10 },     // right knee
+        { 13, 13 },     // left knee
+        { 4, 4 },       // right wrist
+        { 7, 7 },       // left wrist
+        { 11, 11 },     // right ankle
+        { 14, 14 },     // left ankle
+    };
+};
+
+/**
+ * Check that a topology has a source for every joint, and only
+ * uses keypoints it has
+ */
+template <typename Topology>
+constexpr bool IsValidTopology() {
+    if (std::extent<decltype(Topology::JOINTS)>::value != JT_COUNT) {
+        return false;
+    }
+
+    for (const auto& source : Topology::JOINTS) {
+        if (source.first < 0 || source.first >= Topology::KEYPOINT_COUNT
+                || source.second < 0 || source.second >= Topology::KEYPOINT_COUNT) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(IsValidTopology<CocoTopology>(), "COCO must map all of our joints");
+static_assert(IsValidTopology<Coco17Topology>(), "COCO 17 must map all of our joints");
+static_assert(IsValidTopology<Body25Topology>(), "BODY_25 must map all of our joints");
+
+/**
+ * Get a single joint from the keypoints, a keypoint is anything with x, y,
+ * score and has_value, like the parts of HyperPose
+ */
+template <typename Topology, int Joint, typename Keypoint>
+inline void GetJointKeypoint(const Keypoint* keypoints, std::array<vector2, JT_COUNT>& points, std::array<float, JT_COUNT>& confidences) {
+    constexpr KeypointSource source = Topology::JOINTS[Joint];
+    const Keypoint& first = keypoints[source.first];
+
+    if constexpr (source.first == source.second) {
+        points[Joint] = vector2(first.x, first.y);
+        confidences[Joint] = first.has_value ? first.score : 0.0f;
+    } else {
+        // a joint between two keypoints takes the least confident of the two
+        const Keypoint& second = keypoints[source.second];
+        points[Joint] = middle(vector2(first.x, first.y), vector2(second.x, second.y));
+        confidences[Joint] = first.has_value && second.has_value ? std::min(first.score, second.score) : 0.0f;
+    }
+}
+
+template <typename Topology, typename Keypoint, int... Joints>
+inline void GetJointKeypoints(const Keypoint* keypoints, std::array<vector2, JT_COUNT>& points, std::array<float, JT_COUNT>& confidences,
+                              std::integer_sequence<int, Joints...>) {
+    (GetJointKeypoint<Topology, Joints>(keypoints, points, confidences), ...);
+}
+
+/**
+ * Map the keypoints of a network to our joints
+ *
+ * @param keypoints     [IN]    The keypoints, Topology::KEYPOINT_COUNT of them
+ * @param points        [OUT]   The position of every joint
+ * @param confidences   [OUT]   The confidence of every joint, zero if the network did not find it
+ */
+template <typename Topology, typename Keypoint>
+inline void GetJointKeypoints(const Keypoint* keypoints, std::array<vector2, JT_COUNT>& points, std::array<float, JT_COUNT>& confidences) {
+    static_assert(IsValidTopology<Topology>(), "The topology must map all of our joints");
+    GetJointKeypoints<Topology>(keypoints, points, confidences, std::make_integer_sequence<int, JT_COUNT>());
+}
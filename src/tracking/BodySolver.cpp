@@ -0,0 +1,243 @@
+#include <algorithm>
+#include <cmath>
+
+#include <pose/Skeleton.hpp>
+
+#include "BodySolver.hpp"
+
+/**
+ * Joints the network is less sure about than this are filled in by the solver
+ */
+constexpr float MIN_JOINT_CONFIDENCE = 0.3f;
+
+/**
+ * How much of the new head offset is taken with every frame
+ */
+constexpr float HEAD_OFFSET_SMOOTHING = 0.1f;
+
+/**
+ * How much of the new bone lengths is taken with every frame
+ */
+constexpr float LENGTH_SMOOTHING = 0.05f;
+
+/**
+ * How long a foot that is not seen stays planted, in microseconds,
+ * after that the leg hangs straight down from the hip
+ */
+constexpr int64_t FOOT_HOLD_TIME = 1000000;
+
+/**
+ * How much of the full length of a limb the IK stretches it to, a
+ * fully straight limb has no way to tell where it bends
+ */
+constexpr float MAX_REACH = 0.999f;
+
+/**
+ * The kinds of limbs, every one has its own bone lengths
+ */
+enum LimbKind {
+    LK_LEG = 0,
+    LK_ARM = 1,
+};
+
+/**
+ * A limb solved with two-bone IK, the side is 0 for right and 1 for left
+ */
+struct Limb {
+    JointType root;
+    JointType middle;
+    JointType end;
+    LimbKind kind;
+    int side;
+};
+
+constexpr Limb LIMBS[] = {
+    { JT_RIGHT_HIP,         JT_RIGHT_KNEE,  JT_RIGHT_ANKLE, LK_LEG, 0 },
+    { JT_LEFT_HIP,          JT_LEFT_KNEE,   JT_LEFT_ANKLE,  LK_LEG, 1 },
+    { JT_RIGHT_SHOULDER,    JT_RIGHT_ELBOW, JT_RIGHT_WRIST, LK_ARM, 0 },
+    { JT_LEFT_SHOULDER,     JT_LEFT_ELBOW,  JT_LEFT_WRIST,  LK_ARM, 1 },
+};
+
+/**
+ * The bones of every kind of limb for an average person, used until we
+ * measured the user
+ */
+constexpr float UPPER_PROPORTIONS[] = { THIGH, UPPER_ARM };
+constexpr float LOWER_PROPORTIONS[] = { FORELEG, FOREARM };
+
+static bool IsConfident(const std::array<float, JT_COUNT>& confidences, const Limb& limb) {
+    return confidences[limb.root] >= MIN_JOINT_CONFIDENCE
+        && confidences[limb.middle] >= MIN_JOINT_CONFIDENCE
+        && confidences[limb.end] >= MIN_JOINT_CONFIDENCE;
+}
+
+/**
+ * Place the middle joint of a limb so its two bones go from the root to the target,
+ * bending toward the pole. The end is pulled in if the target is out of reach.
+ */
+static void SolveTwoBone(const vector3& root, const vector3& target, float upper, float lower, const vector3& pole,
+                         vector3& middleJoint, vector3& endJoint) {
+    vector3 toTarget = target - root;
+    float distance = toTarget.magnitude();
+    vector3 direction = distance > 1e-5f ? toTarget / distance : vector3::down();
+    float reach = std::clamp(distance, std::abs(upper - lower) + 1e-4f, (upper + lower) * MAX_REACH);
+
+    // the angle at the root, from the law of cosines
+    float cosine = std::clamp((upper * upper + reach * reach - lower * lower) / (2.0f * upper * reach), -1.0f, 1.0f);
+    float sine = std::sqrt(1.0f - cosine * cosine);
+
+    // only the part of the pole across the limb matters, any direction
+    // will do if the pole is along the limb
+    vector3 bend = pole - direction * pole.dot(direction);
+    if (bend.magnitude() < 1e-5f) {
+        bend = direction.cross(std::abs(direction.x) < 0.9f ? vector3::xaxis() : vector3::zaxis());
+    }
+    bend = bend.normalize();
+
+    middleJoint = root + direction * (upper * cosine) + bend * (upper * sine);
+    endJoint = root + direction * reach;
+}
+
+BodySolver::BodySolver()
+    : observed()
+    , confidences()
+    , observedAnchors()
+    , haveObservation(false)
+    , headOffset()
+    , haveHeadOffset(false)
+    , feet()
+    , footTime()
+    , footPlanted()
+    , upperLength()
+    , lowerLength()
+    , haveLength()
+{
+}
+
+void BodySolver::Reset() {
+    // the bone lengths are of the same user, so they are kept
+    this->haveObservation = false;
+    this->footPlanted[0] = false;
+    this->footPlanted[1] = false;
+}
+
+void BodySolver::SetObservation(int64_t time, const std::array<vector3, JT_COUNT>& joints,
+                                const std::array<float, JT_COUNT>& jointConfidences, const BodyAnchors& anchors) {
+    // the offset is only as good as the head keypoint
+    if (anchors.hmdValid && jointConfidences[JT_HEAD] >= MIN_JOINT_CONFIDENCE) {
+        vector3 offset = anchors.hmd - joints[JT_HEAD];
+        if (this->haveHeadOffset) {
+            this->headOffset += (offset - this->headOffset) * HEAD_OFFSET_SMOOTHING;
+        } else {
+            this->headOffset = offset;
+            this->haveHeadOffset = true;
+        }
+    }
+
+    // measure the bones of both sides together
+    for (int kind = 0; kind < 2; kind++) {
+        float upper = 0.0f;
+        float lower = 0.0f;
+        int count = 0;
+        for (const auto& limb : LIMBS) {
+            if (limb.kind != kind || !IsConfident(jointConfidences, limb)) {
+                continue;
+            }
+            upper += joints[limb.root].distance(joints[limb.middle]);
+            lower += joints[limb.middle].distance(joints[limb.end]);
+            count++;
+        }
+        if (count == 0) {
+            continue;
+        }
+
+        upper /= static_cast<float>(count);
+        lower /= static_cast<float>(count);
+        if (this->haveLength[kind]) {
+            this->upperLength[kind] += (upper - this->upperLength[kind]) * LENGTH_SMOOTHING;
+            this->lowerLength[kind] += (lower - this->lowerLength[kind]) * LENGTH_SMOOTHING;
+        } else {
+            this->upperLength[kind] = upper;
+            this->lowerLength[kind] = lower;
+            this->haveLength[kind] = true;
+        }
+    }
+
+    // plant the feet where they were seen, and let go of the ones we did not see for a while
+    for (int side = 0; side < 2; side++) {
+        JointType ankle = side == 0 ? JT_RIGHT_ANKLE : JT_LEFT_ANKLE;
+        if (jointConfidences[ankle] >= MIN_JOINT_CONFIDENCE) {
+            this->feet[side] = joints[ankle] + this->headOffset;
+            this->footTime[side] = time;
+            this->footPlanted[side] = true;
+        } else if (time - this->footTime[side] > FOOT_HOLD_TIME) {
+            this->footPlanted[side] = false;
+        }
+    }
+
+    this->observed = joints;
+    this->confidences = jointConfidences;
+    this->observedAnchors = anchors;
+    this->haveObservation = true;
+}
+
+bool BodySolver::HasObservation() const {
+    return this->haveObservation;
+}
+
+bool BodySolver::Solve(const BodyAnchors& anchors, std::array<vector3, JT_COUNT>& joints) const {
+    if (!this->haveObservation) {
+        return false;
+    }
+
+    // the body moves with the HMD since the frame was captured, and the head is where the HMD is
+    vector3 shift = this->headOffset;
+    if (anchors.hmdValid && this->observedAnchors.hmdValid) {
+        shift += anchors.hmd - this->observedAnchors.hmd;
+    }
+    for (int i = 0; i < JT_COUNT; i++) {
+        joints[i] = this->observed[i] + shift;
+    }
+    if (anchors.hmdValid) {
+        joints[JT_HEAD] = anchors.hmd;
+    }
+
+    // until the limbs were measured their length comes from the spine
+    float scale = 0.0f;
+    if (this->confidences[JT_COLLARBONE] >= MIN_JOINT_CONFIDENCE && this->confidences[JT_TAILBONE] >= MIN_JOINT_CONFIDENCE) {
+        scale = this->observed[JT_COLLARBONE].distance(this->observed[JT_TAILBONE]) / SPINE;
+    }
+
+    // the knees bend forward, and the elbows back and down
+    vector3 right = (joints[JT_RIGHT_HIP] - joints[JT_LEFT_HIP]) + (joints[JT_RIGHT_SHOULDER] - joints[JT_LEFT_SHOULDER]);
+    vector3 forward = vector3::up().cross(right);
+
+    for (const auto& limb : LIMBS) {
+        float upper = this->haveLength[limb.kind] ? this->upperLength[limb.kind] : UPPER_PROPORTIONS[limb.kind] * scale;
+        float lower = this->haveLength[limb.kind] ? this->lowerLength[limb.kind] : LOWER_PROPORTIONS[limb.kind] * scale;
+        if (upper <= 0.0f || lower <= 0.0f) {
+            continue;
+        }
+
+        vector3 target;
+        if (limb.kind == LK_LEG) {
+            target = this->footPlanted[limb.side]
+                     ? this->feet[limb.side]
+                     : joints[limb.root] + vector3::down() * (upper + lower);
+        } else if (anchors.handValid[limb.side]) {
+            target = anchors.hands[limb.side];
+        } else {
+            continue;
+        }
+
+        // bend the way the limb was seen bending, if it was
+        vector3 pole = limb.kind == LK_LEG ? forward : vector3::down() - forward * 0.5f;
+        if (IsConfident(this->confidences, limb)) {
+            pole = this->observed[limb.middle] - middle(this->observed[limb.root], this->observed[limb.end]);
+        }
+
+        SolveTwoBone(joints[limb.root], target, upper, lower, pole, joints[limb.middle], joints[limb.end]);
+    }
+
+    return true;
+}
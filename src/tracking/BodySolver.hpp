@@ -0,0 +1,102 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+#include <math/vector3.hpp>
+#include <pose/Joints.hpp>
+
+/**
+ * Where the devices SteamVR tracks were at some point in time, in the play space
+ */
+struct BodyAnchors {
+    bool hmdValid = false;
+    vector3 hmd;
+
+    /**
+     * The controllers, right then left
+     */
+    bool handValid[2] = { false, false };
+    vector3 hands[2];
+};
+
+/**
+ * Keeps the body of the user in place between camera frames, using the devices
+ * SteamVR tracks at the rate of the HMD as hard constraints.
+ *
+ * The last camera pose follows the HMD, and the head is put exactly where the HMD
+ * is. The feet stay planted where they were last seen, and the knees are placed
+ * with analytic two-bone IK between the hips and the feet, bending the way they were
+ * last seen or forward. The elbows are placed the same way between the shoulders and
+ * the controllers. Joints the network is not sure about come from the IK as well,
+ * so a leg that is hidden for a moment keeps a sensible pose.
+ *
+ * Solving is a handful of vector operations, so it is done on every frame of the
+ * server while the camera can run at a much lower rate.
+ */
+class BodySolver {
+private:
+    /**
+     * The last camera pose, in the play space, and where the devices were
+     * when it was captured
+     */
+    std::array<vector3, JT_COUNT> observed;
+    std::array<float, JT_COUNT> confidences;
+    BodyAnchors observedAnchors;
+    bool haveObservation;
+
+    /**
+     * How far the reconstructed head is from the HMD, smoothed over the frames,
+     * the whole body is moved by it so the head lands on the HMD
+     */
+    vector3 headOffset;
+    bool haveHeadOffset;
+
+    /**
+     * Where the feet were last seen, they stay there until they are seen
+     * again or were not seen for too long
+     */
+    vector3 feet[2];
+    int64_t footTime[2];
+    bool footPlanted[2];
+
+    /**
+     * The bone lengths of the user in meters, measured from the confident frames,
+     * for the upper and lower bone of the legs and of the arms
+     */
+    float upperLength[2];
+    float lowerLength[2];
+    bool haveLength[2];
+
+public:
+
+    BodySolver();
+
+    /**
+     * Forget the user, until the next camera pose
+     */
+    void Reset();
+
+    /**
+     * Take a new camera pose
+     *
+     * @param time          [IN] When the frame was captured, in microseconds
+     * @param joints        [IN] The joints, in the play space
+     * @param confidences   [IN] The confidence of every joint
+     * @param anchors       [IN] Where the devices were when the frame was captured
+     */
+    void SetObservation(int64_t time, const std::array<vector3, JT_COUNT>& joints,
+                        const std::array<float, JT_COUNT>& confidences, const BodyAnchors& anchors);
+
+    bool HasObservation() const;
+
+    /**
+     * Solve the body for where the devices are now
+     *
+     * @param anchors   [IN]    Where the devices are now
+     * @param joints    [OUT]   The joints, in the play space
+     *
+     * @return False if there is no camera pose yet
+     */
+    bool Solve(const BodyAnchors& anchors, std::array<vector3, JT_COUNT>& joints) const;
+};
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <limits>
+
+#include "FrameSynchronizer.hpp"
+
+FrameSynchronizer::FrameSynchronizer(int cameraCount, int64_t maxWait)
+    : cameraCount(std::min(cameraCount, MAX_CAMERAS))
+    , maxWait(maxWait)
+    , histories()
+    , lastTimestamp(std::numeric_limits<int64_t>::min())
+    , statistics()
+    , mutex()
+{
+}
+
+void FrameSynchronizer::Push(int camera, const CameraKeypoints& keypoints) {
+    std::lock_guard<std::mutex> guard{this->mutex};
+    if (camera < 0 || camera >= cameraCount) {
+        return;
+    }
+
+    History& history = this->histories[camera];
+    history.newest = (history.newest + 1) % HISTORY;
+    history.frames[history.newest] = keypoints;
+    history.count = std::min(history.count + 1, HISTORY);
+}
+
+int64_t FrameSynchronizer::Interpolate(const History& history, int64_t timestamp, CameraKeypoints& out) const {
+    // the frames right before and right after the instant, going back from the newest
+    const CameraKeypoints* before = nullptr;
+    const CameraKeypoints* after = nullptr;
+    for (int i = 0; i < history.count; i++) {
+        const CameraKeypoints& frame = history.frames[(history.newest - i + HISTORY) % HISTORY];
+        if (frame.timestamp >= timestamp) {
+            after = &frame;
+        } else {
+            before = &frame;
+            break;
+        }
+    }
+
+    // the instant is older than everything we kept, or it is exactly on a frame
+    if (before == nullptr || after->timestamp == timestamp) {
+        out = *after;
+        out.timestamp = timestamp;
+        return after->timestamp - timestamp;
+    }
+
+    float t = static_cast<float>(timestamp - before->timestamp) / static_cast<float>(after->timestamp - before->timestamp);
+    const CameraKeypoints& nearest = t < 0.5f ? *before : *after;
+
+    out.timestamp = timestamp;
+    for (int slot = 0; slot < MAX_PERSONS; slot++) {
+        out.ids[slot] = nearest.ids[slot];
+        auto& person = out.persons[slot];
+
+        // someone that is only in one of the frames can't be interpolated, and
+        // a keypoint that only one of them has is taken as it is, with less confidence
+        if (before->ids[slot] == 0 || before->ids[slot] != after->ids[slot]) {
+            person = nearest.persons[slot];
+            continue;
+        }
+
+        const auto& a = before->persons[slot];
+        const auto& b = after->persons[slot];
+        for (int joint = 0; joint < JT_COUNT; joint++) {
+            float confidenceA = a.confidences[joint];
+            float confidenceB = b.confidences[joint];
+            if (confidenceA > 0 && confidenceB > 0) {
+                person.points[joint] = a.points[joint] + (b.points[joint] - a.points[joint]) * t;
+                person.confidences[joint] = std::min(confidenceA, confidenceB);
+            } else if (confidenceA > 0) {
+                person.points[joint] = a.points[joint];
+                person.confidences[joint] = confidenceA * (1.0f - t);
+            } else {
+                person.points[joint] = b.points[joint];
+                person.confidences[joint] = confidenceB * t;
+            }
+        }
+    }
+
+    return std::min(timestamp - before->timestamp, after->timestamp - timestamp);
+}
+
+bool FrameSynchronizer::Assemble(FrameSet& set) {
+    std::lock_guard<std::mutex> guard{this->mutex};
+
+    // the newest frame of any camera, everyone behind it by
+    // more than the wait is not waited for
+    int64_t newest = std::numeric_limits<int64_t>::min();
+    for (int camera = 0; camera < cameraCount; camera++) {
+        const History& history = this->histories[camera];
+        if (history.count > 0) {
+            newest = std::max(newest, history.frames[history.newest].timestamp);
+        }
+    }
+
+    // the newest instant all the cameras we wait for got to, if one
+    // of them did not get past the last set we keep waiting for it
+    int64_t timestamp = std::numeric_limits<int64_t>::max();
+    for (int camera = 0; camera < cameraCount; camera++) {
+        const History& history = this->histories[camera];
+        set.valid[camera] = history.count > 0 && history.frames[history.newest].timestamp >= newest - maxWait;
+        if (set.valid[camera]) {
+            timestamp = std::min(timestamp, history.frames[history.newest].timestamp);
+        }
+    }
+
+    if (timestamp == std::numeric_limits<int64_t>::max() || timestamp <= lastTimestamp) {
+        return false;
+    }
+
+    set.timestamp = timestamp;
+    lastTimestamp = timestamp;
+    statistics.sets++;
+    for (int camera = 0; camera < MAX_CAMERAS; camera++) {
+        if (camera >= cameraCount) {
+            set.valid[camera] = false;
+        } else if (!set.valid[camera]) {
+            statistics.stragglers++;
+        } else {
+            statistics.interpolated += Interpolate(this->histories[camera], timestamp, set.cameras[camera]);
+        }
+    }
+
+    return true;
+}
+
+FrameSynchronizer::Statistics FrameSynchronizer::GetStatistics() {
+    std::lock_guard<std::mutex> guard{this->mutex};
+    return statistics;
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <cstdint>
+#include <array>
+#include <mutex>
+
+#include <pose/SkeletonFitter.hpp>
+
+#include "Config.hpp"
+
+/**
+ * The keypoints of everyone a camera saw in a single frame
+ */
+struct CameraKeypoints {
+    /**
+     * The capture time of the frame
+     */
+    int64_t timestamp;
+
+    /**
+     * The id of the person in every slot, zero if the slot is empty
+     */
+    std::array<uint32_t, MAX_PERSONS> ids;
+    std::array<SkeletonObservation, MAX_PERSONS> persons;
+};
+
+/**
+ * The keypoints of every camera at the same instant
+ */
+struct FrameSet {
+    int64_t timestamp;
+
+    /**
+     * The cameras that had nothing to give in time are not valid
+     */
+    std::array<bool, MAX_CAMERAS> valid;
+    std::array<CameraKeypoints, MAX_CAMERAS> cameras;
+};
+
+/**
+ * Lines up the keypoints of cameras that are not synchronized with each other.
+ *
+ * Every camera pushes the keypoints of its frames, and the sets are built at the
+ * newest instant all the cameras got past, with the keypoints of every camera
+ * interpolated between the frames right before and right after it. A camera that
+ * falls behind the others by more than the wait is left out of the sets until it
+ * catches up, so one slow camera never holds back the rest.
+ *
+ * Only the keypoints are kept, a few frames per camera in fixed arrays, so
+ * building a set is a couple of microseconds and never allocates.
+ */
+class FrameSynchronizer {
+public:
+    /**
+     * How many frames of every camera are kept
+     */
+    static constexpr int HISTORY = 8;
+
+    /**
+     * How the sets came out so far
+     */
+    struct Statistics {
+        uint64_t sets;
+
+        /**
+         * How many times a camera was left out of a set
+         */
+        uint64_t stragglers;
+
+        /**
+         * The sum of how far the instant of a set was from the
+         * nearest frame of every camera, in microseconds
+         */
+        int64_t interpolated;
+    };
+
+private:
+    struct History {
+        std::array<CameraKeypoints, HISTORY> frames;
+        int count;
+        int newest;
+    };
+
+    int cameraCount;
+
+    /**
+     * How far behind the newest frame a camera can be and still
+     * be waited for, in microseconds
+     */
+    int64_t maxWait;
+
+    std::array<History, MAX_CAMERAS> histories;
+
+    /**
+     * The instant of the last set, the next one must be newer
+     */
+    int64_t lastTimestamp;
+
+    Statistics statistics;
+    std::mutex mutex;
+
+    /**
+     * Get the keypoints of a camera at the given instant
+     *
+     * @return How far the instant is from the nearest frame
+     */
+    int64_t Interpolate(const History& history, int64_t timestamp, CameraKeypoints& out) const;
+
+public:
+
+    /**
+     * @param cameraCount   [IN] The amount of cameras, up to MAX_CAMERAS
+     * @param maxWait       [IN] How long to wait for a slow camera, in microseconds
+     */
+    FrameSynchronizer(int cameraCount, int64_t maxWait);
+
+    /**
+     * Add the keypoints of a new frame of a camera, the frames of every
+     * camera must be pushed in the order they were captured
+     */
+    void Push(int camera, const CameraKeypoints& keypoints);
+
+    /**
+     * Build the next set, if every camera that is not too far behind got past
+     * the last one
+     *
+     * @param set   [OUT] The set
+     *
+     * @return False if there is no new set yet
+     */
+    bool Assemble(FrameSet& set);
+
+    Statistics GetStatistics();
+};
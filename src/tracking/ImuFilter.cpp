@@ -0,0 +1,409 @@
+#include <algorithm>
+#include <cmath>
+
+#include "ImuFilter.hpp"
+
+/**
+ * Gravity in the play space, y is up
+ */
+constexpr float GRAVITY = 9.81f;
+
+/**
+ * The noise of the accelerometer and the gyroscope of a phone strapped to the body,
+ * in m/s^2 and rad/s, the strap wobbles so this is more than the sensor itself
+ */
+constexpr float ACCELERATION_NOISE = 0.5f;
+constexpr float ROTATION_RATE_NOISE = 0.02f;
+
+/**
+ * How fast the biases wander, per square root of a second
+ */
+constexpr float ACCELERATION_BIAS_WALK = 0.02f;
+constexpr float ROTATION_RATE_BIAS_WALK = 0.001f;
+
+/**
+ * How far the camera is off in where it puts a joint, in meters
+ */
+constexpr float CAMERA_NOISE = 0.05f;
+
+/**
+ * How sure we are of everything when we start over at a camera position. Tilt comes
+ * from gravity, but which way the phone faces around the vertical is a guess
+ */
+constexpr float INITIAL_POSITION_NOISE = CAMERA_NOISE;
+constexpr float INITIAL_VELOCITY_NOISE = 0.5f;
+constexpr float INITIAL_TILT_NOISE = 0.1f;
+constexpr float INITIAL_HEADING_NOISE = 1.0f;
+constexpr float INITIAL_ACCELERATION_BIAS_NOISE = 0.3f;
+constexpr float INITIAL_ROTATION_RATE_BIAS_NOISE = 0.05f;
+
+/**
+ * How much of every sample goes into the smoothed acceleration we find down from
+ */
+constexpr float GRAVITY_SMOOTHING = 0.05f;
+
+/**
+ * The longest step between two samples, in seconds, a longer gap is
+ * the phone that stopped sending for a while
+ */
+constexpr float MAX_STEP = 0.05f;
+
+/**
+ * Camera positions further away than this, in standard deviations squared, are
+ * ignored, 99.9% of the right ones are closer (chi squared with 3 degrees of freedom)
+ */
+constexpr float GATE = 16.27f;
+
+/**
+ * After this many camera positions in a row are ignored the filter is lost,
+ * and starts over at the camera position
+ */
+constexpr int MAX_REJECTED = 5;
+
+/**
+ * How long the IMU alone moves the tracker without the camera, in microseconds,
+ * the position drifts away quickly after that
+ */
+constexpr int64_t MAX_COAST = 500000;
+
+/**
+ * Where every part of the error state starts
+ */
+constexpr int SP = 0;
+constexpr int SV = 3;
+constexpr int SR = 6;
+constexpr int SBA = 9;
+constexpr int SBG = 12;
+
+constexpr int N = ImuFilter::STATE_SIZE;
+
+using Matrix = std::array<float, N * N>;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+using Quaternion = std::array<float, 4>;
+
+static Quaternion Multiply(const Quaternion& a, const Quaternion& b) {
+    return {
+        a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3],
+        a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2],
+        a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1],
+        a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0],
+    };
+}
+
+static Quaternion Normalize(const Quaternion& q) {
+    float length = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    return { q[0] / length, q[1] / length, q[2] / length, q[3] / length };
+}
+
+/**
+ * The rotation of a rotation vector, angle times axis
+ */
+static Quaternion Exp(const vector3& v) {
+    float angle = v.magnitude();
+    if (angle < 1e-6f) {
+        return Normalize({ 1.0f, v.x / 2, v.y / 2, v.z / 2 });
+    }
+    float scale = std::sin(angle / 2) / angle;
+    return { std::cos(angle / 2), v.x * scale, v.y * scale, v.z * scale };
+}
+
+/**
+ * The rotation of a quaternion as a row major matrix
+ */
+static void GetMatrix(const Quaternion& q, float m[3][3]) {
+    float w = q[0], x = q[1], y = q[2], z = q[3];
+    m[0][0] = 1 - 2 * (y * y + z * z);  m[0][1] = 2 * (x * y - w * z);      m[0][2] = 2 * (x * z + w * y);
+    m[1][0] = 2 * (x * y + w * z);      m[1][1] = 1 - 2 * (x * x + z * z);  m[1][2] = 2 * (y * z - w * x);
+    m[2][0] = 2 * (x * z - w * y);      m[2][1] = 2 * (y * z + w * x);      m[2][2] = 1 - 2 * (x * x + y * y);
+}
+
+static vector3 Apply(const float m[3][3], const vector3& v) {
+    return {
+        m[0][0] * v.x + m[0][1] * v.y + m[0][2] * v.z,
+        m[1][0] * v.x + m[1][1] * v.y + m[1][2] * v.z,
+        m[2][0] * v.x + m[2][1] * v.y + m[2][2] * v.z,
+    };
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+ImuFilter::ImuFilter()
+    : position()
+    , velocity()
+    , rotation{ 1, 0, 0, 0 }
+    , accelerationBias()
+    , rotationRateBias()
+    , covariance()
+    , lastSample()
+    , haveSample(false)
+    , gravity()
+    , initialized(false)
+    , lastCorrection(0)
+    , rejected(0)
+    , history()
+    , historyCount(0)
+    , historyHead(0)
+{
+}
+
+void ImuFilter::Reset() {
+    haveSample = false;
+    initialized = false;
+    rejected = 0;
+    historyCount = 0;
+}
+
+void ImuFilter::Initialize(const vector3& camera) {
+    position = camera;
+    velocity = vector3::zero();
+    accelerationBias = vector3::zero();
+    rotationRateBias = vector3::zero();
+
+    // lying still the accelerometer points up, turn it to the up of the play space
+    // the shortest way, which leaves the heading to the filter
+    vector3 up = gravity.normalize();
+    vector3 axis = up.cross(vector3(0, 1, 0));
+    float cosine = up.y;
+    if (cosine < -0.999f) {
+        rotation = { 0, 1, 0, 0 };
+    } else {
+        rotation = Normalize({ 1 + cosine, axis.x, axis.y, axis.z });
+    }
+
+    covariance.fill(0.0f);
+    auto variance = [&](int index, float deviation) { covariance[index * N + index] = deviation * deviation; };
+    for (int i = 0; i < 3; i++) {
+        variance(SP + i, INITIAL_POSITION_NOISE);
+        variance(SV + i, INITIAL_VELOCITY_NOISE);
+        variance(SBA + i, INITIAL_ACCELERATION_BIAS_NOISE);
+        variance(SBG + i, INITIAL_ROTATION_RATE_BIAS_NOISE);
+    }
+    variance(SR + 0, INITIAL_TILT_NOISE);
+    variance(SR + 1, INITIAL_HEADING_NOISE);
+    variance(SR + 2, INITIAL_TILT_NOISE);
+
+    historyCount = 0;
+    rejected = 0;
+    initialized = true;
+}
+
+void ImuFilter::Predict(const ImuSample& sample) {
+    if (!haveSample) {
+        lastSample = sample;
+        gravity = sample.acceleration;
+        haveSample = true;
+        return;
+    }
+
+    float dt = std::clamp(static_cast<float>(sample.time - lastSample.time) / 1000000.0f, 0.0f, MAX_STEP);
+    gravity += (sample.acceleration - gravity) * GRAVITY_SMOOTHING;
+    lastSample = sample;
+    if (!initialized || dt <= 0.0f) {
+        return;
+    }
+
+    // move the nominal state
+    float r[3][3];
+    GetMatrix(rotation, r);
+    vector3 acceleration = sample.acceleration - accelerationBias;
+    vector3 rotationRate = sample.rotationRate - rotationRateBias;
+    vector3 worldAcceleration = Apply(r, acceleration) - vector3(0, GRAVITY, 0);
+
+    position += velocity * dt + worldAcceleration * (0.5f * dt * dt);
+    velocity += worldAcceleration * dt;
+    rotation = Normalize(Multiply(rotation, Exp(rotationRate * dt)));
+
+    // the error moves with the transition F = I + A, with A made of:
+    //      position from velocity              I dt
+    //      velocity from rotation              -[R a]x dt
+    //      velocity from accelerometer bias    -R dt
+    //      rotation from gyroscope bias        -R dt
+    Matrix a {};
+    vector3 f = Apply(r, acceleration) * dt;
+    const float skew[3][3] = {
+        { 0.0f, -f.z, f.y },
+        { f.z, 0.0f, -f.x },
+        { -f.y, f.x, 0.0f },
+    };
+    for (int i = 0; i < 3; i++) {
+        a[(SP + i) * N + SV + i] = dt;
+        for (int j = 0; j < 3; j++) {
+            a[(SV + i) * N + SR + j] = -skew[i][j];
+            a[(SV + i) * N + SBA + j] = -r[i][j] * dt;
+            a[(SR + i) * N + SBG + j] = -r[i][j] * dt;
+        }
+    }
+
+    // P = F P F^T = P + A P + (A P)^T + A P A^T, A only has a few rows worth of values
+    Matrix ap {};
+    for (int i = 0; i < SBA; i++) {
+        for (int k = 0; k < N; k++) {
+            float value = a[i * N + k];
+            if (value == 0.0f) {
+                continue;
+            }
+            for (int j = 0; j < N; j++) {
+                ap[i * N + j] += value * covariance[k * N + j];
+            }
+        }
+    }
+    Matrix next = covariance;
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j < N; j++) {
+            next[i * N + j] += ap[i * N + j] + ap[j * N + i];
+        }
+    }
+    for (int i = 0; i < SBA; i++) {
+        for (int j = 0; j < SBA; j++) {
+            float sum = 0.0f;
+            for (int k = 0; k < N; k++) {
+                sum += ap[i * N + k] * a[j * N + k];
+            }
+            next[i * N + j] += sum;
+        }
+    }
+    covariance = next;
+
+    // and the noise of the sensors
+    for (int i = 0; i < 3; i++) {
+        covariance[(SV + i) * N + SV + i] += ACCELERATION_NOISE * ACCELERATION_NOISE * dt * dt;
+        covariance[(SR + i) * N + SR + i] += ROTATION_RATE_NOISE * ROTATION_RATE_NOISE * dt * dt;
+        covariance[(SBA + i) * N + SBA + i] += ACCELERATION_BIAS_WALK * ACCELERATION_BIAS_WALK * dt;
+        covariance[(SBG + i) * N + SBG + i] += ROTATION_RATE_BIAS_WALK * ROTATION_RATE_BIAS_WALK * dt;
+    }
+
+    history[historyHead] = { sample.time, position };
+    historyHead = (historyHead + 1) % history.size();
+    historyCount = std::min(historyCount + 1, history.size());
+}
+
+vector3 ImuFilter::GetPastPosition(int64_t time) const {
+    if (historyCount == 0) {
+        return position;
+    }
+
+    // walk back from the newest, and interpolate between the two around the time
+    size_t newest = (historyHead + history.size() - 1) % history.size();
+    const HistoryEntry* after = &history[newest];
+    if (time >= after->time) {
+        return position;
+    }
+    for (size_t i = 1; i < historyCount; i++) {
+        const HistoryEntry* before = &history[(newest + history.size() - i) % history.size()];
+        if (before->time <= time) {
+            float t = static_cast<float>(time - before->time) / static_cast<float>(std::max<int64_t>(after->time - before->time, 1));
+            return before->position + (after->position - before->position) * t;
+        }
+        after = before;
+    }
+    return after->position;
+}
+
+bool ImuFilter::Correct(int64_t time, const vector3& camera) {
+    if (!initialized) {
+        if (!haveSample) {
+            return false;
+        }
+        Initialize(camera);
+        lastCorrection = time;
+        return true;
+    }
+
+    vector3 innovation = camera - GetPastPosition(time);
+
+    // S = H P H^T + R, H picks the position
+    float s[3][3];
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            s[i][j] = covariance[(SP + i) * N + SP + j] + (i == j ? CAMERA_NOISE * CAMERA_NOISE : 0.0f);
+        }
+    }
+    float determinant = s[0][0] * (s[1][1] * s[2][2] - s[1][2] * s[2][1])
+                      - s[0][1] * (s[1][0] * s[2][2] - s[1][2] * s[2][0])
+                      + s[0][2] * (s[1][0] * s[2][1] - s[1][1] * s[2][0]);
+    if (std::fabs(determinant) < 1e-12f) {
+        Initialize(camera);
+        lastCorrection = time;
+        return true;
+    }
+    float inverse[3][3] = {
+        { (s[1][1] * s[2][2] - s[1][2] * s[2][1]) / determinant, (s[0][2] * s[2][1] - s[0][1] * s[2][2]) / determinant, (s[0][1] * s[1][2] - s[0][2] * s[1][1]) / determinant },
+        { (s[1][2] * s[2][0] - s[1][0] * s[2][2]) / determinant, (s[0][0] * s[2][2] - s[0][2] * s[2][0]) / determinant, (s[0][2] * s[1][0] - s[0][0] * s[1][2]) / determinant },
+        { (s[1][0] * s[2][1] - s[1][1] * s[2][0]) / determinant, (s[0][1] * s[2][0] - s[0][0] * s[2][1]) / determinant, (s[0][0] * s[1][1] - s[0][1] * s[1][0]) / determinant },
+    };
+
+    // too far from where we thought, the camera mixed up the joints or we are lost
+    vector3 weighted = Apply(inverse, innovation);
+    if (innovation.dot(weighted) > GATE) {
+        if (++rejected < MAX_REJECTED) {
+            return false;
+        }
+        Initialize(camera);
+        lastCorrection = time;
+        return true;
+    }
+    rejected = 0;
+
+    // K = P H^T S^-1, and the error it gives
+    std::array<float, N * 3> gain;
+    std::array<float, N> error;
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j < 3; j++) {
+            gain[i * 3 + j] = covariance[i * N + SP + 0] * inverse[0][j]
+                            + covariance[i * N + SP + 1] * inverse[1][j]
+                            + covariance[i * N + SP + 2] * inverse[2][j];
+        }
+        error[i] = gain[i * 3 + 0] * innovation.x + gain[i * 3 + 1] * innovation.y + gain[i * 3 + 2] * innovation.z;
+    }
+
+    // P = (I - K H) P, kept symmetric
+    Matrix next = covariance;
+    for (int i = 0; i < N; i++) {
+        for (int j = 0; j < N; j++) {
+            next[i * N + j] -= gain[i * 3 + 0] * covariance[(SP + 0) * N + j]
+                             + gain[i * 3 + 1] * covariance[(SP + 1) * N + j]
+                             + gain[i * 3 + 2] * covariance[(SP + 2) * N + j];
+        }
+    }
+    for (int i = 0; i < N; i++) {
+        for (int j = i + 1; j < N; j++) {
+            float average = (next[i * N + j] + next[j * N + i]) / 2;
+            next[i * N + j] = average;
+            next[j * N + i] = average;
+        }
+    }
+    covariance = next;
+
+    // put the error into the nominal state, the rotation error is in the play space
+    vector3 positionError(error[SP], error[SP + 1], error[SP + 2]);
+    position += positionError;
+    velocity += vector3(error[SV], error[SV + 1], error[SV + 2]);
+    rotation = Normalize(Multiply(Exp(vector3(error[SR], error[SR + 1], error[SR + 2])), rotation));
+    accelerationBias += vector3(error[SBA], error[SBA + 1], error[SBA + 2]);
+    rotationRateBias += vector3(error[SBG], error[SBG + 1], error[SBG + 2]);
+
+    // the path we took moves along, for the next late frame
+    for (size_t i = 0; i < historyCount; i++) {
+        history[(historyHead + history.size() - 1 - i) % history.size()].position += positionError;
+    }
+
+    lastCorrection = std::max(lastCorrection, time);
+    return true;
+}
+
+bool ImuFilter::IsTracking(int64_t now) const {
+    return initialized && now - lastCorrection < MAX_COAST;
+}
+
+void ImuFilter::GetState(ImuState& state) const {
+    float r[3][3];
+    GetMatrix(rotation, r);
+
+    state.time = lastSample.time;
+    state.position = position;
+    state.velocity = velocity;
+    state.rotation = rotation;
+    state.angularVelocity = Apply(r, lastSample.rotationRate - rotationRateBias);
+}
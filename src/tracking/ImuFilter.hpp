@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstdint>
+#include <array>
+
+#include <capture/ImuSource.hpp>
+#include <math/vector3.hpp>
+
+/**
+ * The state of a tracker with an IMU on it, in the play space
+ */
+struct ImuState {
+    /**
+     * The time of the last IMU sample, on our clock
+     */
+    int64_t time;
+
+    vector3 position;
+    vector3 velocity;
+
+    /**
+     * The rotation of the IMU in the play space, w, x, y, z
+     */
+    std::array<float, 4> rotation;
+
+    /**
+     * In rad/s, in the play space
+     */
+    vector3 angularVelocity;
+};
+
+/**
+ * Fuses the samples of an IMU with the positions the camera sees the tracker at,
+ * with an error-state Kalman filter.
+ *
+ * The IMU moves the tracker at its own rate, a few hundred times a second, and every
+ * camera frame pulls it back to where the camera saw it. The filter keeps the position,
+ * velocity and rotation of the IMU, and the biases of its accelerometer and gyroscope,
+ * and a covariance of the error of all of them. Which way the phone is turned around
+ * the vertical is unknown at first, it is found from how it moves compared to what the
+ * camera sees.
+ *
+ * The camera frames arrive a few tens of milliseconds after they were captured, so the
+ * filter keeps where it put the tracker over the last samples and compares the camera
+ * position with where the tracker was when the frame was captured.
+ */
+class ImuFilter {
+public:
+    /**
+     * The error state: position, velocity, rotation, accelerometer bias, gyroscope bias
+     */
+    static constexpr int STATE_SIZE = 15;
+
+private:
+    /**
+     * The nominal state, the rotation is w, x, y, z
+     */
+    vector3 position;
+    vector3 velocity;
+    std::array<float, 4> rotation;
+    vector3 accelerationBias;
+    vector3 rotationRateBias;
+
+    /**
+     * The covariance of the error state, the rotation error is in the play space
+     */
+    std::array<float, STATE_SIZE * STATE_SIZE> covariance;
+
+    /**
+     * The last sample, and a smoothed acceleration to find down from before we start
+     */
+    ImuSample lastSample;
+    bool haveSample;
+    vector3 gravity;
+
+    bool initialized;
+    int64_t lastCorrection;
+    int rejected;
+
+    /**
+     * Where the tracker was after every sample, to compare late camera frames with
+     */
+    struct HistoryEntry {
+        int64_t time;
+        vector3 position;
+    };
+    std::array<HistoryEntry, 64> history;
+    size_t historyCount;
+    size_t historyHead;
+
+    /**
+     * Start over at a camera position, with the rotation from gravity
+     */
+    void Initialize(const vector3& position);
+
+    /**
+     * Where the tracker was at a point in time, from the history
+     */
+    vector3 GetPastPosition(int64_t time) const;
+
+public:
+
+    ImuFilter();
+
+    void Reset();
+
+    /**
+     * Move the tracker with a new IMU sample
+     */
+    void Predict(const ImuSample& sample);
+
+    /**
+     * Pull the tracker towards where the camera saw it
+     *
+     * @param time      [IN] When the camera frame was captured
+     * @param position  [IN] Where the camera saw the tracker, in the play space
+     *
+     * @return False if the position was too far from what we expected and was ignored
+     */
+    bool Correct(int64_t time, const vector3& position);
+
+    /**
+     * Is the filter running, and was it corrected by the camera recently enough
+     * to trust it
+     */
+    bool IsTracking(int64_t now) const;
+
+    void GetState(ImuState& state) const;
+};
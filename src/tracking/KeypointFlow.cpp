@@ -0,0 +1,132 @@
+#include <util/AllocationAudit.hpp>
+
+#include "KeypointFlow.hpp"
+
+/**
+ * The size of the patch around each keypoint that we track
+ */
+constexpr int WINDOW_SIZE = 15;
+
+/**
+ * How many pyramid levels to use, this sets how much a keypoint
+ * can move between frames
+ */
+constexpr int PYRAMID_LEVELS = 3;
+
+/**
+ * The flow stops iterating once it reaches either of these
+ */
+constexpr int MAX_ITERATIONS = 10;
+constexpr double EPSILON = 0.03;
+
+/**
+ * The maximum average per-pixel difference of a patch before we consider
+ * the keypoint as lost
+ */
+constexpr float MAX_ERROR = 20.0f;
+
+/**
+ * The fraction of keypoints that must be tracked successfully, if
+ * less than that we want a new keyframe
+ */
+constexpr float MIN_TRACKED = 0.75f;
+
+KeypointFlow::KeypointFlow()
+    : previousPyramid()
+    , currentPyramid()
+    , gray()
+    , previousPoints()
+    , currentPoints()
+    , status()
+    , error()
+    , parts()
+    , valid(false)
+{
+    // reserve everything up front so the hot path doesn't allocate
+    previousPoints.reserve(hyperpose::COCO_N_PARTS);
+    currentPoints.reserve(hyperpose::COCO_N_PARTS);
+    status.reserve(hyperpose::COCO_N_PARTS);
+    error.reserve(hyperpose::COCO_N_PARTS);
+}
+
+void KeypointFlow::BuildPyramid(const cv::Mat& frame, std::vector<cv::Mat>& pyramid) {
+    LibraryAllocations libraryAllocations;
+    cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+    cv::buildOpticalFlowPyramid(gray, pyramid, cv::Size(WINDOW_SIZE, WINDOW_SIZE), PYRAMID_LEVELS);
+}
+
+void KeypointFlow::SetKeyframe(const cv::Mat& frame, const hyperpose::human_t& pose) {
+    BuildPyramid(frame, previousPyramid);
+
+    // take all the keypoints the network found
+    previousPoints.clear();
+    for (int i = 0; i < static_cast<int>(hyperpose::COCO_N_PARTS); i++) {
+        const auto& part = pose.parts[i];
+        if (part.has_value) {
+            parts[previousPoints.size()] = i;
+            previousPoints.emplace_back(part.x * frame.cols, part.y * frame.rows);
+        }
+    }
+
+    valid = !previousPoints.empty();
+}
+
+bool KeypointFlow::Propagate(const cv::Mat& frame, hyperpose::human_t& pose) {
+    if (!valid) {
+        return false;
+    }
+
+    BuildPyramid(frame, currentPyramid);
+
+    // the outputs are reserved, the scratch buffers of every level are OpenCV's own
+    {
+        LibraryAllocations libraryAllocations;
+        cv::calcOpticalFlowPyrLK(
+                previousPyramid, currentPyramid,
+                previousPoints, currentPoints,
+                status, error,
+                cv::Size(WINDOW_SIZE, WINDOW_SIZE), PYRAMID_LEVELS,
+                cv::TermCriteria(cv::TermCriteria::COUNT | cv::TermCriteria::EPS, MAX_ITERATIONS, EPSILON));
+    }
+
+    // check how many of the points we actually managed to track
+    size_t tracked = 0;
+    for (size_t i = 0; i < currentPoints.size(); i++) {
+        if (status[i] && error[i] < MAX_ERROR) {
+            tracked++;
+        }
+    }
+
+    if (tracked < previousPoints.size() * MIN_TRACKED) {
+        // the flow degraded, don't touch the pose and ask for a keyframe
+        valid = false;
+        return false;
+    }
+
+    // update the pose, and only keep the points we tracked for the next frame
+    size_t kept = 0;
+    for (size_t i = 0; i < currentPoints.size(); i++) {
+        auto& part = pose.parts[parts[i]];
+        if (status[i] && error[i] < MAX_ERROR) {
+            part.x = currentPoints[i].x / frame.cols;
+            part.y = currentPoints[i].y / frame.rows;
+
+            parts[kept] = parts[i];
+            currentPoints[kept] = currentPoints[i];
+            kept++;
+        } else {
+            part.has_value = false;
+        }
+    }
+    currentPoints.resize(kept);
+
+    // the current frame is the base for the next one
+    std::swap(previousPyramid, currentPyramid);
+    std::swap(previousPoints, currentPoints);
+
+    return true;
+}
+
+void KeypointFlow::Reset() {
+    valid = false;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <hyperpose/hyperpose.hpp>
+#include <opencv2/opencv.hpp>
+
+#include <cstdint>
+#include <vector>
+#include <array>
+
+/**
+ * Propagates the keypoints of the last keyframe to the following frames using
+ * sparse pyramidal Lucas-Kanade optical flow, which only looks at small patches
+ * around each keypoint and is way cheaper than running the network.
+ */
+class KeypointFlow {
+private:
+    /**
+     * The image pyramid of the last frame we tracked, and the one
+     * we build for the new frame, they are swapped every frame
+     */
+    std::vector<cv::Mat> previousPyramid;
+    std::vector<cv::Mat> currentPyramid;
+
+    /**
+     * The grayscale version of the frame
+     */
+    cv::Mat gray;
+
+    /**
+     * The keypoints in pixels, before and after the flow
+     */
+    std::vector<cv::Point2f> previousPoints;
+    std::vector<cv::Point2f> currentPoints;
+
+    /**
+     * The output of the flow for each point
+     */
+    std::vector<uint8_t> status;
+    std::vector<float> error;
+
+    /**
+     * The part in the pose that each of the points belongs to
+     */
+    std::array<int, hyperpose::COCO_N_PARTS> parts;
+
+    /**
+     * Do we have a keyframe to propagate from
+     */
+    bool valid;
+
+    /**
+     * Convert the frame to grayscale and build its pyramid
+     */
+    void BuildPyramid(const cv::Mat& frame, std::vector<cv::Mat>& pyramid);
+
+public:
+
+    KeypointFlow();
+
+    /**
+     * Set a new keyframe, the pose is the output of the network on this frame
+     * in normalized frame coordinates.
+     *
+     * @param frame     [IN] The full camera frame
+     * @param pose      [IN] The pose found on the frame
+     */
+    void SetKeyframe(const cv::Mat& frame, const hyperpose::human_t& pose);
+
+    /**
+     * Move the keypoints of the pose to where they are in the new frame, this
+     * will fail if too many of the keypoints were lost, in which case we need a
+     * new keyframe.
+     *
+     * @param frame     [IN]        The full camera frame
+     * @param pose      [IN/OUT]    The pose of the previous frame
+     *
+     * @return True if the keypoints were propagated, false if the flow is not good enough
+     */
+    bool Propagate(const cv::Mat& frame, hyperpose::human_t& pose);
+
+    /**
+     * Drop the current keyframe
+     */
+    void Reset();
+};
@@ -0,0 +1,109 @@
+#include <cstdint>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON)
+    #include <arm_neon.h>
+#endif
+
+#include <util/AllocationAudit.hpp>
+
+#include "MotionGate.hpp"
+
+/**
+ * The size of each tile we compare, a tile row is exactly one 16 byte
+ * vector so the whole tile is just 16 loads per image
+ */
+constexpr int TILE_SIZE = 16;
+
+/**
+ * The size of the downsampled image we compare, must be
+ * a multiple of the tile size
+ */
+constexpr int GATE_WIDTH = 160;
+constexpr int GATE_HEIGHT = 128;
+
+static_assert(GATE_WIDTH % TILE_SIZE == 0 && GATE_HEIGHT % TILE_SIZE == 0, "The gate must be made of whole tiles");
+
+/**
+ * Sum of absolute differences of a single tile
+ */
+static uint32_t TileSad(const uint8_t* a, const uint8_t* b, size_t stride) {
+#if defined(__SSE2__) || defined(_M_X64)
+    __m128i sum = _mm_setzero_si128();
+    for (int row = 0; row < TILE_SIZE; row++) {
+        __m128i rowA = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + row * stride));
+        __m128i rowB = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + row * stride));
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(rowA, rowB));
+    }
+
+    // the sad leaves a partial sum in each of the 64bit halves
+    return _mm_cvtsi128_si32(sum) + _mm_cvtsi128_si32(_mm_srli_si128(sum, 8));
+#elif defined(__ARM_NEON)
+    uint16x8_t sum = vdupq_n_u16(0);
+    for (int row = 0; row < TILE_SIZE; row++) {
+        uint8x16_t rowA = vld1q_u8(a + row * stride);
+        uint8x16_t rowB = vld1q_u8(b + row * stride);
+        sum = vpadalq_u8(sum, vabdq_u8(rowA, rowB));
+    }
+
+    uint64x2_t total = vpaddlq_u32(vpaddlq_u16(sum));
+    return static_cast<uint32_t>(vgetq_lane_u64(total, 0) + vgetq_lane_u64(total, 1));
+#else
+    uint32_t sum = 0;
+    for (int row = 0; row < TILE_SIZE; row++) {
+        for (int col = 0; col < TILE_SIZE; col++) {
+            int diff = a[row * stride + col] - b[row * stride + col];
+            sum += diff < 0 ? -diff : diff;
+        }
+    }
+    return sum;
+#endif
+}
+
+MotionGate::MotionGate()
+    : current(GATE_HEIGHT, GATE_WIDTH, CV_8UC1)
+    , reference(GATE_HEIGHT, GATE_WIDTH, CV_8UC1)
+    , gray()
+    , valid(false)
+{
+}
+
+bool MotionGate::HasMotion(const cv::Mat& frame, int threshold) {
+    // get a tiny luma image, area interpolation averages out the sensor noise,
+    // OpenCV keeps its own scratch buffers for it
+    {
+        LibraryAllocations libraryAllocations;
+        cv::cvtColor(frame, gray, cv::COLOR_BGR2GRAY);
+        cv::resize(gray, current, cv::Size(GATE_WIDTH, GATE_HEIGHT), 0, 0, cv::INTER_AREA);
+    }
+
+    if (!valid) {
+        return true;
+    }
+
+    // any tile that moved more than the threshold is enough
+    const uint32_t maxSad = threshold * TILE_SIZE * TILE_SIZE;
+    for (int y = 0; y < GATE_HEIGHT; y += TILE_SIZE) {
+        const uint8_t* currentRow = current.ptr<uint8_t>(y);
+        const uint8_t* referenceRow = reference.ptr<uint8_t>(y);
+
+        for (int x = 0; x < GATE_WIDTH; x += TILE_SIZE) {
+            if (TileSad(currentRow + x, referenceRow + x, current.step) > maxSad) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void MotionGate::SetReference() {
+    std::swap(current, reference);
+    valid = true;
+}
+
+void MotionGate::Reset() {
+    valid = false;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * A cheap motion detector used to skip the network when the user is
+ * standing still.
+ *
+ * The frame is downsampled to a small luma image which is compared to the
+ * frame the current keypoints came from, using the sum of absolute differences
+ * per tile. Any tile that changed more than the threshold counts as motion.
+ */
+class MotionGate {
+private:
+    /**
+     * The downsampled luma of the current frame and of the
+     * frame the keypoints came from
+     */
+    cv::Mat current;
+    cv::Mat reference;
+
+    /**
+     * Temporary for the grayscale conversion
+     */
+    cv::Mat gray;
+
+    /**
+     * Do we have a reference frame to compare against
+     */
+    bool valid;
+
+public:
+
+    MotionGate();
+
+    /**
+     * Check if the frame moved compared to the reference frame, this
+     * will always return true if there is no reference yet.
+     *
+     * @param frame     [IN] The full camera frame
+     * @param threshold [IN] The mean absolute difference per pixel for a tile to count as motion
+     */
+    bool HasMotion(const cv::Mat& frame, int threshold);
+
+    /**
+     * Make the last frame given to HasMotion the reference frame, call this
+     * whenever the keypoints are updated from a frame.
+     */
+    void SetReference();
+
+    /**
+     * Drop the reference frame
+     */
+    void Reset();
+};
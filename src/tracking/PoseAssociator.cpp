@@ -0,0 +1,244 @@
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+#include "PoseAssociator.hpp"
+
+/**
+ * The maximum mean keypoint distance (in normalized frame coordinates)
+ * for a pose to still be considered the same person
+ */
+constexpr float MAX_DISTANCE = 0.1f;
+
+/**
+ * How many frames a person can be missing before we free
+ * the slot for someone else
+ */
+constexpr int MAX_MISSED_FRAMES = 15;
+
+/**
+ * The size of the assignment problem, we always solve a square
+ * problem and pad it with impossible matches
+ */
+constexpr int SIZE = std::max(PoseAssociator::MAX_CANDIDATES, MAX_PERSONS);
+
+/**
+ * The cost of an impossible match, bigger than any real cost
+ */
+constexpr float NO_MATCH = 1e6f;
+
+/**
+ * The mean distance between the keypoints both poses have
+ */
+static float PoseDistance(const hyperpose::human_t& a, const hyperpose::human_t& b) {
+    float total = 0;
+    int count = 0;
+    for (size_t i = 0; i < hyperpose::COCO_N_PARTS; i++) {
+        if (a.parts[i].has_value && b.parts[i].has_value) {
+            float dx = a.parts[i].x - b.parts[i].x;
+            float dy = a.parts[i].y - b.parts[i].y;
+            total += std::sqrt(dx * dx + dy * dy);
+            count++;
+        }
+    }
+    return count == 0 ? NO_MATCH : total / count;
+}
+
+/**
+ * Solve the assignment problem with the Hungarian method, O(n^3) using
+ * the row and column potentials.
+ *
+ * @param cost          [IN]    The cost of assigning row i to column j
+ * @param n             [IN]    The size of the problem
+ * @param assignment    [OUT]   The column assigned to each row
+ */
+static void Hungarian(const float (&cost)[SIZE][SIZE], int n, int (&assignment)[SIZE]) {
+    // everything is 1-based, index 0 is the virtual starting column
+    float u[SIZE + 1] = {};
+    float v[SIZE + 1] = {};
+    int p[SIZE + 1] = {};
+    int way[SIZE + 1] = {};
+
+    for (int i = 1; i <= n; i++) {
+        float minv[SIZE + 1];
+        bool used[SIZE + 1];
+        std::fill(minv, minv + n + 1, std::numeric_limits<float>::infinity());
+        std::fill(used, used + n + 1, false);
+
+        p[0] = i;
+        int j0 = 0;
+        do {
+            used[j0] = true;
+            int i0 = p[j0];
+            int j1 = 0;
+            float delta = std::numeric_limits<float>::infinity();
+
+            for (int j = 1; j <= n; j++) {
+                if (used[j]) {
+                    continue;
+                }
+
+                float current = cost[i0 - 1][j - 1] - u[i0] - v[j];
+                if (current < minv[j]) {
+                    minv[j] = current;
+                    way[j] = j0;
+                }
+                if (minv[j] < delta) {
+                    delta = minv[j];
+                    j1 = j;
+                }
+            }
+
+            for (int j = 0; j <= n; j++) {
+                if (used[j]) {
+                    u[p[j]] += delta;
+                    v[j] -= delta;
+                } else {
+                    minv[j] -= delta;
+                }
+            }
+
+            j0 = j1;
+        } while (p[j0] != 0);
+
+        // walk back along the augmenting path
+        do {
+            int j1 = way[j0];
+            p[j0] = p[j1];
+            j0 = j1;
+        } while (j0 != 0);
+    }
+
+    for (int j = 1; j <= n; j++) {
+        assignment[p[j] - 1] = j - 1;
+    }
+}
+
+PoseAssociator::PoseAssociator()
+    : persons()
+    , nextId(0)
+{
+    Reset();
+}
+
+void PoseAssociator::Update(const hyperpose::human_t* poses, size_t count, int maxPersons) {
+    maxPersons = std::clamp(maxPersons, 1, MAX_PERSONS);
+
+    // only look at the best candidates
+    const hyperpose::human_t* candidates[MAX_CANDIDATES];
+    int candidateCount = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (candidateCount < MAX_CANDIDATES) {
+            candidates[candidateCount++] = &poses[i];
+        } else {
+            // replace the worst candidate if this one is better
+            auto worst = std::min_element(candidates, candidates + candidateCount,
+                    [](const hyperpose::human_t* a, const hyperpose::human_t* b) { return a->score < b->score; });
+            if ((*worst)->score < poses[i].score) {
+                *worst = &poses[i];
+            }
+        }
+    }
+
+    // sort them by score, so new tracks go to the best poses first
+    std::sort(candidates, candidates + candidateCount,
+            [](const hyperpose::human_t* a, const hyperpose::human_t* b) { return a->score > b->score; });
+
+    // build the cost of matching every slot with every candidate, rows are
+    // the slots and columns are the candidates
+    int n = std::max(candidateCount, maxPersons);
+    float cost[SIZE][SIZE];
+    for (int slot = 0; slot < n; slot++) {
+        for (int candidate = 0; candidate < n; candidate++) {
+            if (slot < maxPersons && candidate < candidateCount && persons[slot].active) {
+                cost[slot][candidate] = PoseDistance(persons[slot].pose, *candidates[candidate]);
+            } else {
+                cost[slot][candidate] = NO_MATCH;
+            }
+        }
+    }
+
+    int assignment[SIZE];
+    Hungarian(cost, n, assignment);
+
+    // update the matched tracks
+    bool used[MAX_CANDIDATES] = {};
+    for (int slot = 0; slot < maxPersons; slot++) {
+        auto& person = persons[slot];
+        if (!person.active) {
+            continue;
+        }
+
+        int candidate = assignment[slot];
+        if (candidate < candidateCount && cost[slot][candidate] < MAX_DISTANCE) {
+            person.pose = *candidates[candidate];
+            person.missedFrames = 0;
+            used[candidate] = true;
+        } else if (++person.missedFrames > MAX_MISSED_FRAMES) {
+            person.active = false;
+        }
+    }
+
+    // give the free slots to new persons, best score first
+    for (int candidate = 0; candidate < candidateCount; candidate++) {
+        if (used[candidate]) {
+            continue;
+        }
+
+        int slot = FindSlot(maxPersons);
+        if (slot < 0) {
+            break;
+        }
+
+        auto& person = persons[slot];
+        person.id = nextId++;
+        person.pose = *candidates[candidate];
+        person.missedFrames = 0;
+        person.active = true;
+    }
+
+    // anything above the limit is no longer tracked
+    for (int i = maxPersons; i < MAX_PERSONS; i++) {
+        persons[i].active = false;
+    }
+}
+
+int PoseAssociator::FindSlot(int maxPersons) const {
+    for (int slot = 0; slot < maxPersons; slot++) {
+        if (!persons[slot].active) {
+            return slot;
+        }
+    }
+
+    // all taken, someone who is here takes the place of whoever is missing the
+    // longest, otherwise a single slot would ignore everyone else until it times out
+    int best = -1;
+    for (int slot = 0; slot < maxPersons; slot++) {
+        if (persons[slot].missedFrames > 0 && (best < 0 || persons[slot].missedFrames > persons[best].missedFrames)) {
+            best = slot;
+        }
+    }
+    return best;
+}
+
+bool PoseAssociator::IsTracking() const {
+    for (const auto& person : persons) {
+        if (person.active && person.missedFrames == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+TrackedPerson& PoseAssociator::GetPerson(int slot) {
+    return persons[slot];
+}
+
+void PoseAssociator::Reset() {
+    for (auto& person : persons) {
+        person.id = 0;
+        person.pose = {};
+        person.missedFrames = 0;
+        person.active = false;
+    }
+}
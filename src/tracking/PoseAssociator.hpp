@@ -0,0 +1,101 @@
+#pragma once
+
+#include <hyperpose/hyperpose.hpp>
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+
+#include "Config.hpp"
+
+/**
+ * A single person that we are tracking across frames
+ */
+struct TrackedPerson {
+    /**
+     * Unique id of this track, a new person always gets a new id
+     */
+    uint32_t id;
+
+    /**
+     * The last pose of this person, in normalized frame coordinates
+     */
+    hyperpose::human_t pose;
+
+    /**
+     * For how many frames in a row we did not find this person
+     */
+    int missedFrames;
+
+    /**
+     * Is this slot tracking anyone
+     */
+    bool active;
+};
+
+/**
+ * Associates the poses found in each frame with the people we already track,
+ * so every person keeps the same slot (and the same trackers) across frames.
+ *
+ * The association solves an assignment problem between the tracks and the new
+ * poses using the Hungarian method, where the cost is the mean distance between
+ * their keypoints. Everything is in fixed size arrays so nothing is allocated
+ * per frame.
+ */
+class PoseAssociator {
+public:
+    /**
+     * The maximum amount of poses we look at per frame, the
+     * ones with the lowest score are ignored
+     */
+    static constexpr int MAX_CANDIDATES = 8;
+
+private:
+    /**
+     * The person in each slot, the slot is the index of the
+     * tracker set used for that person
+     */
+    std::array<TrackedPerson, MAX_PERSONS> persons;
+
+    /**
+     * The id we will give to the next new person
+     */
+    uint32_t nextId;
+
+    /**
+     * Find a slot for a new person, a free one or else the one of a person we
+     * did not find in this frame
+     *
+     * @return The slot, or -1 if everyone is here
+     */
+    int FindSlot(int maxPersons) const;
+
+public:
+
+    PoseAssociator();
+
+    /**
+     * Match the poses of a new frame to the tracked persons, updating their poses,
+     * starting new tracks and dropping tracks that were gone for too long.
+     *
+     * @param poses         [IN] The poses of the frame, in normalized frame coordinates
+     * @param count         [IN] The amount of poses
+     * @param maxPersons    [IN] How many of the slots we can use
+     */
+    void Update(const hyperpose::human_t* poses, size_t count, int maxPersons);
+
+    /**
+     * Did we see any of the persons in the last frame
+     */
+    bool IsTracking() const;
+
+    /**
+     * Get the person in the given slot
+     */
+    TrackedPerson& GetPerson(int slot);
+
+    /**
+     * Drop all the tracks
+     */
+    void Reset();
+};
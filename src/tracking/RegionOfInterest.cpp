@@ -0,0 +1,144 @@
+#include <algorithm>
+
+#include <util/AllocationAudit.hpp>
+
+#include "RegionOfInterest.hpp"
+
+/**
+ * How much to pad the bounding box of the keypoints, relative to its size,
+ * this gives room for the user to move between frames
+ */
+constexpr float PADDING = 0.25f;
+
+/**
+ * Below this pose score we don't trust the keypoints enough to crop
+ * around them, and go back to the full frame
+ */
+constexpr float MIN_SCORE = 0.3f;
+
+/**
+ * The minimum amount of keypoints we need to have in order to
+ * compute a region from them
+ */
+constexpr int MIN_PARTS = 6;
+
+/**
+ * The minimum size of the region, relative to the full frame, so a few
+ * bad keypoints will not zoom us into nothing
+ */
+constexpr float MIN_SIZE = 0.2f;
+
+RegionOfInterest::RegionOfInterest(cv::Size network_input)
+    : inputSize(network_input)
+    , aspectRatio(static_cast<float>(network_input.width) / static_cast<float>(network_input.height))
+    , minX(0), minY(0), maxX(1), maxY(1)
+    , valid(false)
+    , current()
+    , frameSize()
+    , cropped()
+{
+}
+
+const cv::Mat& RegionOfInterest::Crop(const cv::Mat& frame) {
+    frameSize = frame.size();
+
+    if (!valid) {
+        // no region, just use the full frame
+        current = cv::Rect(0, 0, frameSize.width, frameSize.height);
+        return frame;
+    }
+
+    // get the region in pixels
+    float x = minX * frameSize.width;
+    float y = minY * frameSize.height;
+    float width = (maxX - minX) * frameSize.width;
+    float height = (maxY - minY) * frameSize.height;
+
+    // pad it
+    x -= width * PADDING;
+    y -= height * PADDING;
+    width *= 1.0f + PADDING * 2;
+    height *= 1.0f + PADDING * 2;
+
+    // make sure it is not too small
+    width = std::max(width, frameSize.width * MIN_SIZE);
+    height = std::max(height, frameSize.height * MIN_SIZE);
+
+    // expand to the aspect ratio of the network so we don't distort the person
+    if (width / height < aspectRatio) {
+        float newWidth = height * aspectRatio;
+        x -= (newWidth - width) / 2;
+        width = newWidth;
+    } else {
+        float newHeight = width / aspectRatio;
+        y -= (newHeight - height) / 2;
+        height = newHeight;
+    }
+
+    // if we got bigger than the frame there is nothing to gain from cropping
+    if (width >= frameSize.width && height >= frameSize.height) {
+        current = cv::Rect(0, 0, frameSize.width, frameSize.height);
+        return frame;
+    }
+
+    // shift the region back into the frame, keeping its size where possible
+    width = std::min(width, static_cast<float>(frameSize.width));
+    height = std::min(height, static_cast<float>(frameSize.height));
+    x = std::clamp(x, 0.0f, frameSize.width - width);
+    y = std::clamp(y, 0.0f, frameSize.height - height);
+
+    current = cv::Rect(static_cast<int>(x), static_cast<int>(y), static_cast<int>(width), static_cast<int>(height));
+
+    // crop is only a view, the resize is the only pass over the pixels we do,
+    // it takes a scratch buffer for the interpolation table every time
+    LibraryAllocations libraryAllocations;
+    cv::resize(frame(current), cropped, inputSize, 0, 0, cv::INTER_LINEAR);
+    return cropped;
+}
+
+void RegionOfInterest::MapToFrame(hyperpose::human_t& pose) {
+    // from normalized region coordinates to normalized frame coordinates
+    for (auto& part : pose.parts) {
+        if (part.has_value) {
+            part.x = (current.x + part.x * current.width) / frameSize.width;
+            part.y = (current.y + part.y * current.height) / frameSize.height;
+        }
+    }
+}
+
+void RegionOfInterest::Update(const hyperpose::human_t& pose) {
+    float newMinX = 1, newMinY = 1, newMaxX = 0, newMaxY = 0;
+    int count = 0;
+
+    for (const auto& part : pose.parts) {
+        if (!part.has_value) {
+            continue;
+        }
+
+        newMinX = std::min(newMinX, part.x);
+        newMinY = std::min(newMinY, part.y);
+        newMaxX = std::max(newMaxX, part.x);
+        newMaxY = std::max(newMaxY, part.y);
+        count++;
+    }
+
+    // only crop around the pose next frame if we actually trust it
+    if (pose.score < MIN_SCORE || count < MIN_PARTS) {
+        Reset();
+        return;
+    }
+
+    minX = std::max(newMinX, 0.0f);
+    minY = std::max(newMinY, 0.0f);
+    maxX = std::min(newMaxX, 1.0f);
+    maxY = std::min(newMaxY, 1.0f);
+    valid = true;
+}
+
+void RegionOfInterest::Reset() {
+    valid = false;
+}
+
+bool RegionOfInterest::IsCropped() const {
+    return current.width != frameSize.width || current.height != frameSize.height;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <hyperpose/hyperpose.hpp>
+#include <opencv2/opencv.hpp>
+
+/**
+ * Tracks the region of the frame the user is in, so we only have to
+ * run the network on that region instead of the full frame.
+ *
+ * The region is computed from the keypoints of the previous frame, padded
+ * and expanded to the aspect ratio of the network input, which means the
+ * person is seen at a higher resolution for the same network input size.
+ */
+class RegionOfInterest {
+private:
+    /**
+     * The size of the network input, the region is
+     * resized to this
+     */
+    cv::Size inputSize;
+
+    /**
+     * The aspect ratio (width / height) of the network input
+     */
+    float aspectRatio;
+
+    /**
+     * The region we are going to crop on the next frame, in
+     * normalized frame coordinates
+     */
+    float minX, minY, maxX, maxY;
+
+    /**
+     * Do we have a valid region from the last frame, if not
+     * we are going to use the full frame
+     */
+    bool valid;
+
+    /**
+     * The region that was used for the current frame, in pixels
+     */
+    cv::Rect current;
+
+    /**
+     * The size of the full frame
+     */
+    cv::Size frameSize;
+
+    /**
+     * The cropped and resized region, kept around so we
+     * don't allocate a new image every frame
+     */
+    cv::Mat cropped;
+
+public:
+
+    explicit RegionOfInterest(cv::Size network_input);
+
+    /**
+     * Crop and resize the region of the frame we think the user is in, the
+     * output is going to be the size of the network input, or the full frame
+     * if we have no region.
+     *
+     * @param frame     [IN] The full camera frame
+     */
+    const cv::Mat& Crop(const cv::Mat& frame);
+
+    /**
+     * Map the keypoints of the pose from the cropped region back into
+     * normalized full-frame coordinates.
+     *
+     * @param pose      [IN/OUT] The pose found in the cropped frame
+     */
+    void MapToFrame(hyperpose::human_t& pose);
+
+    /**
+     * Set the region for the next frame from a pose that is already in
+     * normalized full-frame coordinates.
+     *
+     * @param pose      [IN] The pose to crop around
+     */
+    void Update(const hyperpose::human_t& pose);
+
+    /**
+     * Tell the tracker that we could not find a good pose this frame, the next
+     * frame will go back to the full frame.
+     */
+    void Reset();
+
+    /**
+     * Is the current frame cropped or is it the full frame
+     */
+    bool IsCropped() const;
+};
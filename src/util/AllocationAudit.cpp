@@ -0,0 +1,161 @@
+#include <cerrno>
+#include <cstdlib>
+#include <cstdio>
+#include <new>
+
+#include "AllocationAudit.hpp"
+
+/**
+ * The first frames fill the buffers of the pipeline, allocations
+ * are only a bug after that
+ */
+constexpr uint64_t WARMUP_FRAMES = 120;
+
+/**
+ * How often to log the allocations of the libraries
+ */
+constexpr uint64_t REPORT_INTERVAL = 300;
+
+/**
+ * The counts of the calling thread, and how deep we are in library calls
+ */
+static thread_local AllocationCounts mCounts {};
+static thread_local int mLibraryDepth = 0;
+
+static inline void CountAllocation() {
+    if (mLibraryDepth > 0) {
+        mCounts.library++;
+    } else {
+        mCounts.pipeline++;
+    }
+}
+
+#ifdef PMFBT_ALLOCATION_AUDIT
+
+#ifdef __GLIBC__
+
+/**
+ * glibc lets us replace malloc and call its own one underneath, this catches
+ * everything including OpenCV and operator new
+ */
+extern "C" {
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* pointer, size_t size);
+    void* __libc_memalign(size_t alignment, size_t size);
+
+    void* malloc(size_t size) {
+        CountAllocation();
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size) {
+        CountAllocation();
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* pointer, size_t size) {
+        CountAllocation();
+        return __libc_realloc(pointer, size);
+    }
+
+    void* memalign(size_t alignment, size_t size) {
+        CountAllocation();
+        return __libc_memalign(alignment, size);
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size) {
+        CountAllocation();
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void** pointer, size_t alignment, size_t size) {
+        CountAllocation();
+        *pointer = __libc_memalign(alignment, size);
+        return *pointer == nullptr ? ENOMEM : 0;
+    }
+}
+
+#else
+
+/**
+ * Elsewhere we can only replace operator new, the array and nothrow
+ * versions all end up in these
+ */
+void* operator new(size_t size) {
+    CountAllocation();
+    void* pointer = std::malloc(size == 0 ? 1 : size);
+    if (pointer == nullptr) {
+        throw std::bad_alloc();
+    }
+    return pointer;
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+#endif
+
+bool IsAllocationAuditEnabled() {
+    return true;
+}
+
+#else
+
+bool IsAllocationAuditEnabled() {
+    return false;
+}
+
+#endif
+
+AllocationCounts GetThreadAllocations() {
+    return mCounts;
+}
+
+LibraryAllocations::LibraryAllocations() {
+    mLibraryDepth++;
+}
+
+LibraryAllocations::~LibraryAllocations() {
+    mLibraryDepth--;
+}
+
+AllocationAudit::AllocationAudit(const char* name)
+    : name(name)
+    , last(GetThreadAllocations())
+    , frames(0)
+    , libraryAllocations(0)
+{
+}
+
+void AllocationAudit::BeginFrame() {
+    // whatever happened since the last frame is not ours to check
+    last = GetThreadAllocations();
+}
+
+void AllocationAudit::EndFrame() {
+    if (!IsAllocationAuditEnabled()) {
+        return;
+    }
+
+    AllocationCounts now = GetThreadAllocations();
+    uint64_t pipeline = now.pipeline - last.pipeline;
+    libraryAllocations += now.library - last.library;
+    last = now;
+
+    if (++frames > WARMUP_FRAMES && pipeline != 0) {
+        std::fprintf(stderr, "%s: allocated %llu times in frame %llu, the pipeline must not allocate once running\n",
+                     name, static_cast<unsigned long long>(pipeline), static_cast<unsigned long long>(frames));
+        std::abort();
+    }
+
+    if (frames % REPORT_INTERVAL == 0) {
+        std::printf("%s: the libraries allocate %.1f times per frame\n", name,
+                    static_cast<double>(libraryAllocations) / REPORT_INTERVAL);
+        libraryAllocations = 0;
+
+        // the log itself may allocate
+        last = GetThreadAllocations();
+    }
+}
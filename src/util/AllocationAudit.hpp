@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * Counts the heap allocations of every thread, to check that the pipeline does
+ * not allocate once it is running. Only does anything when built with
+ * PMFBT_ALLOCATION_AUDIT, which replaces malloc and operator new of the service.
+ */
+
+/**
+ * The allocations of a thread so far, the ones made by the libraries we call
+ * are counted on their own since we can't do anything about them
+ */
+struct AllocationCounts {
+    uint64_t pipeline;
+    uint64_t library;
+};
+
+/**
+ * Is the allocator replaced, without it all the counts stay zero
+ */
+bool IsAllocationAuditEnabled();
+
+/**
+ * Get the allocations of the calling thread
+ */
+AllocationCounts GetThreadAllocations();
+
+/**
+ * Count the allocations made while this is in scope as the allocations of a library
+ */
+class LibraryAllocations {
+public:
+    LibraryAllocations();
+    ~LibraryAllocations();
+
+    LibraryAllocations(const LibraryAllocations&) = delete;
+    LibraryAllocations& operator=(const LibraryAllocations&) = delete;
+};
+
+/**
+ * Checks the allocations of a thread frame by frame, once the pipeline warmed up
+ * any allocation it makes itself aborts the process, so it shows up in tests
+ * and in the debugger
+ */
+class AllocationAudit {
+private:
+    const char* name;
+    AllocationCounts last;
+    uint64_t frames;
+    uint64_t libraryAllocations;
+
+public:
+
+    /**
+     * @param name  [IN] The name of the thread for the log
+     */
+    explicit AllocationAudit(const char* name);
+
+    /**
+     * Start counting a frame from here, for threads that do other work between
+     * the frames, like the workers of a task pool
+     */
+    void BeginFrame();
+
+    /**
+     * Check the allocations of the frame that just ended
+     */
+    void EndFrame();
+};
@@ -0,0 +1,153 @@
+#include "AsyncFileWriter.hpp"
+#include "Process.hpp"
+
+/**
+ * The size of a buffer, big enough that the disk sees a few large writes
+ * instead of many small ones
+ */
+constexpr size_t BUFFER_SIZE = 1 << 20;
+
+/**
+ * The buffers we start with, the disk can fall behind by all but
+ * one of them before we have to add more
+ */
+constexpr size_t BUFFER_COUNT = 4;
+
+AsyncFileWriter::AsyncFileWriter()
+    : file(nullptr)
+    , current()
+    , pending()
+    , spare()
+    , size(0)
+    , thread()
+    , mutex()
+    , wakeup()
+    , closing(false)
+    , failed(false)
+{
+}
+
+AsyncFileWriter::~AsyncFileWriter() {
+    Close();
+}
+
+bool AsyncFileWriter::Open(const std::string& path) {
+    Close();
+
+    this->file = std::fopen(path.c_str(), "wb");
+    if (this->file == nullptr) {
+        return false;
+    }
+
+    // our buffers are already large, don't copy them again
+    std::setvbuf(this->file, nullptr, _IONBF, 0);
+
+    this->current = std::make_unique<std::vector<char>>();
+    this->current->reserve(BUFFER_SIZE);
+    for (size_t i = 1; i < BUFFER_COUNT; i++) {
+        this->spare.push_back(std::make_unique<std::vector<char>>());
+        this->spare.back()->reserve(BUFFER_SIZE);
+    }
+    this->pending.reserve(BUFFER_COUNT);
+
+    this->size = 0;
+    this->closing = false;
+    this->failed = false;
+    this->thread = std::thread(&AsyncFileWriter::WriterThread, this);
+    return true;
+}
+
+bool AsyncFileWriter::IsOpen() const {
+    return this->file != nullptr;
+}
+
+void AsyncFileWriter::Submit() {
+    std::lock_guard<std::mutex> guard{this->mutex};
+    this->pending.push_back(std::move(this->current));
+
+    // the disk is behind by all of the buffers, add another one rather than wait
+    if (this->spare.empty()) {
+        this->current = std::make_unique<std::vector<char>>();
+        this->current->reserve(BUFFER_SIZE);
+    } else {
+        this->current = std::move(this->spare.back());
+        this->spare.pop_back();
+    }
+    this->wakeup.notify_one();
+}
+
+void AsyncFileWriter::Write(const void* data, size_t length) {
+    if (this->file == nullptr) {
+        return;
+    }
+
+    const char* bytes = static_cast<const char*>(data);
+    this->size += length;
+    while (length > 0) {
+        size_t room = BUFFER_SIZE - this->current->size();
+        size_t count = length < room ? length : room;
+        this->current->insert(this->current->end(), bytes, bytes + count);
+        bytes += count;
+        length -= count;
+
+        if (this->current->size() == BUFFER_SIZE) {
+            Submit();
+        }
+    }
+}
+
+uint64_t AsyncFileWriter::GetSize() const {
+    return this->size;
+}
+
+void AsyncFileWriter::WriterThread() {
+    SetThreadName("pmfbt-writer");
+
+    std::unique_lock<std::mutex> lock{this->mutex};
+    while (true) {
+        this->wakeup.wait(lock, [this] { return !this->pending.empty() || this->closing; });
+        if (this->pending.empty()) {
+            break;
+        }
+
+        // write the oldest buffer without holding the lock
+        std::unique_ptr<std::vector<char>> buffer = std::move(this->pending.front());
+        this->pending.erase(this->pending.begin());
+        lock.unlock();
+
+        if (!this->failed && std::fwrite(buffer->data(), 1, buffer->size(), this->file) != buffer->size()) {
+            this->failed = true;
+        }
+        buffer->clear();
+
+        lock.lock();
+        this->spare.push_back(std::move(buffer));
+    }
+}
+
+bool AsyncFileWriter::Close() {
+    if (this->file == nullptr) {
+        return true;
+    }
+
+    // whatever is left goes out last, the thread writes everything before it stops
+    if (!this->current->empty()) {
+        Submit();
+    }
+    {
+        std::lock_guard<std::mutex> guard{this->mutex};
+        this->closing = true;
+        this->wakeup.notify_one();
+    }
+    this->thread.join();
+
+    bool written = !this->failed;
+    if (std::fclose(this->file) != 0) {
+        written = false;
+    }
+    this->file = nullptr;
+    this->current.reset();
+    this->pending.clear();
+    this->spare.clear();
+    return written;
+}
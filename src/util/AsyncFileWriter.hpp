@@ -0,0 +1,87 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <mutex>
+
+/**
+ * Writes a file from a thread of its own, so whoever produces the data never
+ * waits for the disk.
+ *
+ * The data is collected in large buffers, a full one is handed to the thread
+ * which writes it out in a single call while the next one fills up. The buffers
+ * are reused, and if the disk falls behind by all of them another one is added
+ * instead of waiting.
+ */
+class AsyncFileWriter {
+private:
+    FILE* file;
+
+    /**
+     * The buffer being filled, the full ones waiting for the thread and the empty ones
+     */
+    std::unique_ptr<std::vector<char>> current;
+    std::vector<std::unique_ptr<std::vector<char>>> pending;
+    std::vector<std::unique_ptr<std::vector<char>>> spare;
+
+    /**
+     * How much went into the file so far, including what is still in the buffers
+     */
+    uint64_t size;
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    bool closing;
+
+    /**
+     * Set by the thread if a write failed, everything after it is thrown away
+     */
+    std::atomic<bool> failed;
+
+    /**
+     * Hand the current buffer to the thread and take an empty one
+     */
+    void Submit();
+
+    void WriterThread();
+
+public:
+
+    AsyncFileWriter();
+    ~AsyncFileWriter();
+
+    AsyncFileWriter(const AsyncFileWriter&) = delete;
+    AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+    /**
+     * Create the file, or truncate it if it exists, and start the thread
+     */
+    bool Open(const std::string& path);
+
+    bool IsOpen() const;
+
+    /**
+     * Queue data to be written after everything before it, this only
+     * copies it into the current buffer
+     */
+    void Write(const void* data, size_t length);
+
+    /**
+     * How many bytes were written so far, the offset the next write starts at
+     */
+    uint64_t GetSize() const;
+
+    /**
+     * Wait for everything to be written and close the file
+     *
+     * @return False if any of the writes failed
+     */
+    bool Close();
+};
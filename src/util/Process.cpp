@@ -0,0 +1,194 @@
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <sys/resource.h>
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <set>
+#include <thread>
+
+#include "Process.hpp"
+
+#ifdef _WIN32
+
+/**
+ * Turn a list of CPUs into an affinity mask, zero if one of them does not fit
+ */
+static DWORD_PTR MakeAffinityMask(const std::vector<int>& cpus) {
+    DWORD_PTR mask = 0;
+    for (int cpu : cpus) {
+        if (cpu < 0 || cpu >= static_cast<int>(sizeof(mask) * 8)) {
+            return 0;
+        }
+        mask |= static_cast<DWORD_PTR>(1) << cpu;
+    }
+    return mask;
+}
+
+bool SetProcessAffinity(const std::vector<int>& cpus) {
+    DWORD_PTR mask = MakeAffinityMask(cpus);
+    return mask != 0 && SetProcessAffinityMask(GetCurrentProcess(), mask);
+}
+
+bool SetProcessPriority(int nice) {
+    DWORD priorityClass = NORMAL_PRIORITY_CLASS;
+    if (nice <= -10) {
+        priorityClass = HIGH_PRIORITY_CLASS;
+    } else if (nice < 0) {
+        priorityClass = ABOVE_NORMAL_PRIORITY_CLASS;
+    } else if (nice >= 10) {
+        priorityClass = IDLE_PRIORITY_CLASS;
+    } else if (nice > 0) {
+        priorityClass = BELOW_NORMAL_PRIORITY_CLASS;
+    }
+
+    return SetPriorityClass(GetCurrentProcess(), priorityClass);
+}
+
+bool SetThreadAffinity(const std::vector<int>& cpus) {
+    DWORD_PTR mask = MakeAffinityMask(cpus);
+    return mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+}
+
+bool SetThreadRealtime(int priority) {
+    return SetThreadPriority(GetCurrentThread(), priority >= 50 ? THREAD_PRIORITY_TIME_CRITICAL : THREAD_PRIORITY_HIGHEST);
+}
+
+void SetThreadName(const char* name) {
+    // only newer versions of windows can name threads, and only with wide strings
+}
+
+ThreadScheduling GetThreadScheduling() {
+    ThreadScheduling scheduling { SP_DEFAULT, 0, 0 };
+
+    int threadPriority = GetThreadPriority(GetCurrentThread());
+    if (threadPriority >= THREAD_PRIORITY_HIGHEST) {
+        scheduling.policy = SP_REALTIME;
+        scheduling.priority = threadPriority == THREAD_PRIORITY_TIME_CRITICAL ? 99 : 1;
+        return scheduling;
+    }
+
+    // the opposite of the mapping in SetProcessPriority
+    switch (GetPriorityClass(GetCurrentProcess())) {
+        case HIGH_PRIORITY_CLASS: scheduling.priority = -10; break;
+        case ABOVE_NORMAL_PRIORITY_CLASS: scheduling.priority = -5; break;
+        case BELOW_NORMAL_PRIORITY_CLASS: scheduling.priority = 5; break;
+        case IDLE_PRIORITY_CLASS: scheduling.priority = 10; break;
+        default: break;
+    }
+    if (scheduling.priority != 0) {
+        scheduling.policy = SP_NICE;
+    }
+    return scheduling;
+}
+
+std::vector<int> GetPhysicalCores() {
+    std::vector<int> cores;
+    for (int cpu = 0; cpu < static_cast<int>(std::thread::hardware_concurrency()); cpu++) {
+        cores.push_back(cpu);
+    }
+    return cores;
+}
+
+#else
+
+bool SetProcessAffinity(const std::vector<int>& cpus) {
+    // on linux the affinity of the process is the affinity of the calling thread
+    return SetThreadAffinity(cpus);
+}
+
+bool SetProcessPriority(int nice) {
+    return setpriority(PRIO_PROCESS, 0, nice) == 0;
+}
+
+bool SetThreadAffinity(const std::vector<int>& cpus) {
+#ifdef LINUX
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu < 0 || cpu >= CPU_SETSIZE) {
+            return false;
+        }
+        CPU_SET(cpu, &set);
+    }
+
+    return !cpus.empty() && sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    // there is no way to pin threads on osx
+    return false;
+#endif
+}
+
+bool SetThreadRealtime(int priority) {
+    sched_param param {};
+    param.sched_priority = priority;
+    return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+}
+
+void SetThreadName(const char* name) {
+#ifdef LINUX
+    // linux only keeps the first 15 characters
+    std::string shortName(name, std::min<size_t>(std::char_traits<char>::length(name), 15));
+    pthread_setname_np(pthread_self(), shortName.c_str());
+#else
+    pthread_setname_np(name);
+#endif
+}
+
+ThreadScheduling GetThreadScheduling() {
+    ThreadScheduling scheduling { SP_DEFAULT, 0, 0 };
+
+    int policy;
+    sched_param param {};
+    if (pthread_getschedparam(pthread_self(), &policy, &param) == 0 && (policy == SCHED_FIFO || policy == SCHED_RR)) {
+        scheduling.policy = SP_REALTIME;
+        scheduling.priority = param.sched_priority;
+        return scheduling;
+    }
+
+    // on linux the nice value is per thread, and this gets the one of the calling thread
+    scheduling.priority = getpriority(PRIO_PROCESS, 0);
+    if (scheduling.priority != 0) {
+        scheduling.policy = SP_NICE;
+    }
+    return scheduling;
+}
+
+std::vector<int> GetPhysicalCores() {
+    std::vector<int> cores;
+
+#ifdef LINUX
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        // keep the first allowed CPU of every group of hyper threads
+        std::set<std::string> seen;
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (!CPU_ISSET(cpu, &allowed)) {
+                continue;
+            }
+
+            std::string siblings = std::to_string(cpu);
+            std::ifstream file("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/thread_siblings_list");
+            std::getline(file, siblings);
+            if (seen.insert(siblings).second) {
+                cores.push_back(cpu);
+            }
+        }
+    }
+#endif
+
+    if (cores.empty()) {
+        for (int cpu = 0; cpu < static_cast<int>(std::thread::hardware_concurrency()); cpu++) {
+            cores.push_back(cpu);
+        }
+    }
+    return cores;
+}
+
+#endif
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+
+/**
+ * Pin the process to the given CPUs. On linux this only applies to the calling
+ * thread and the threads it creates afterwards, so call it before starting
+ * any other thread.
+ *
+ * @param cpus  [IN] The indexes of the CPUs to run on
+ *
+ * @return False if the system refused or does not support it
+ */
+bool SetProcessAffinity(const std::vector<int>& cpus);
+
+/**
+ * Change the scheduling priority of the process, same rules as the affinity
+ * about which threads it applies to.
+ *
+ * @param nice  [IN] The unix nice value, -20 is the highest priority and 19 the
+ *                   lowest, on windows it is mapped to a priority class
+ *
+ * @return False if the system refused, raising the priority usually needs privileges
+ */
+bool SetProcessPriority(int nice);
+
+/**
+ * How a thread is scheduled
+ */
+enum SchedulingPolicy {
+    /**
+     * The normal time sharing scheduler at the default priority
+     */
+    SP_DEFAULT,
+
+    /**
+     * The normal scheduler, with the priority raised or lowered
+     */
+    SP_NICE,
+
+    /**
+     * A real time policy, the thread runs before any normal thread
+     */
+    SP_REALTIME,
+};
+
+struct ThreadScheduling {
+    SchedulingPolicy policy;
+
+    /**
+     * The real time priority, or the nice value for the other policies
+     */
+    int priority;
+
+    /**
+     * The CPUs the thread was pinned to, zero if it can run anywhere
+     */
+    uint64_t cpuMask;
+};
+
+/**
+ * Pin the calling thread to the given CPUs
+ *
+ * @param cpus  [IN] The indexes of the CPUs to run on
+ *
+ * @return False if the system refused or does not support it
+ */
+bool SetThreadAffinity(const std::vector<int>& cpus);
+
+/**
+ * Move the calling thread to the real time scheduler (SCHED_FIFO), on windows
+ * it gets a time critical priority instead
+ *
+ * @param priority  [IN] The real time priority, 1 to 99
+ *
+ * @return False if the system refused, this usually needs privileges (CAP_SYS_NICE
+ *         or an rtprio limit on linux)
+ */
+bool SetThreadRealtime(int priority);
+
+/**
+ * Name the calling thread, so it can be told apart in top and debuggers
+ */
+void SetThreadName(const char* name);
+
+/**
+ * Get how the calling thread is scheduled right now, the cpu mask is not set
+ */
+ThreadScheduling GetThreadScheduling();
+
+/**
+ * Get a single CPU of every physical core we are allowed to run on, hyper threads
+ * of the same core share their caches and execution units so busy threads are
+ * better off on different cores
+ */
+std::vector<int> GetPhysicalCores();
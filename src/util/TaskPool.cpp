@@ -0,0 +1,125 @@
+#include <algorithm>
+
+#include "TaskPool.hpp"
+
+/**
+ * Enough room in every queue for a couple of tasks per camera, so
+ * queueing never allocates
+ */
+constexpr size_t QUEUE_RESERVE = 64;
+
+/**
+ * The pool and worker of the calling thread, so tasks submitted
+ * from a worker stay on it
+ */
+static thread_local TaskPool* mCurrentPool = nullptr;
+static thread_local int mCurrentWorker = -1;
+
+/**
+ * Orders the heaps so the oldest task is on top
+ */
+static bool IsNewer(const Task& a, const Task& b) {
+    return a.priority > b.priority;
+}
+
+TaskPool::TaskPool(int workerCount, WorkerStart onStart)
+    : workers()
+    , threads()
+    , onStart(onStart)
+    , pending(0)
+    , nextWorker(0)
+    , sleepMutex()
+    , wakeup()
+    , running(true)
+{
+    workerCount = std::max(workerCount, 1);
+    for (int i = 0; i < workerCount; i++) {
+        workers.emplace_back(new Worker());
+        workers.back()->queue.reserve(QUEUE_RESERVE);
+    }
+
+    for (int i = 0; i < workerCount; i++) {
+        threads.emplace_back(&TaskPool::WorkerThread, this, i);
+    }
+}
+
+TaskPool::~TaskPool() {
+    Stop();
+}
+
+int TaskPool::GetWorkerCount() const {
+    return static_cast<int>(workers.size());
+}
+
+void TaskPool::Submit(const Task& task) {
+    int worker = mCurrentPool == this ? mCurrentWorker : static_cast<int>(nextWorker++ % workers.size());
+    {
+        Worker& target = *workers[worker];
+        std::lock_guard<std::mutex> guard{target.mutex};
+        target.queue.push_back(task);
+        std::push_heap(target.queue.begin(), target.queue.end(), IsNewer);
+    }
+    pending++;
+
+    // take the lock so a worker can't miss the wakeup between checking and sleeping
+    {
+        std::lock_guard<std::mutex> guard{this->sleepMutex};
+    }
+    wakeup.notify_one();
+}
+
+bool TaskPool::Take(int worker, Task& task) {
+    // our own queue first, then the others starting from our neighbor
+    int count = static_cast<int>(workers.size());
+    for (int i = 0; i < count; i++) {
+        Worker& victim = *workers[(worker + i) % count];
+        std::lock_guard<std::mutex> guard{victim.mutex};
+        if (victim.queue.empty()) {
+            continue;
+        }
+
+        std::pop_heap(victim.queue.begin(), victim.queue.end(), IsNewer);
+        task = victim.queue.back();
+        victim.queue.pop_back();
+        pending--;
+        return true;
+    }
+
+    return false;
+}
+
+void TaskPool::WorkerThread(int worker) {
+    mCurrentPool = this;
+    mCurrentWorker = worker;
+    if (onStart != nullptr) {
+        onStart(worker);
+    }
+
+    while (true) {
+        Task task;
+        if (Take(worker, task)) {
+            task.run(task.context);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock{this->sleepMutex};
+        wakeup.wait(lock, [this] { return !running || pending > 0; });
+        if (!running) {
+            break;
+        }
+    }
+}
+
+void TaskPool::Stop() {
+    {
+        std::lock_guard<std::mutex> guard{this->sleepMutex};
+        running = false;
+    }
+    wakeup.notify_all();
+
+    for (auto& thread : threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <mutex>
+
+/**
+ * A piece of work for the task pool, a plain function and what it works
+ * on so submitting never allocates
+ */
+struct Task {
+    void (*run)(void* context);
+    void* context;
+
+    /**
+     * Lower runs first, the capture time of the frame the task works on
+     * so the oldest frames are always done first
+     */
+    int64_t priority;
+};
+
+/**
+ * Runs tasks on a fixed set of worker threads.
+ *
+ * Every worker has its own queue, tasks submitted from a worker go to its own
+ * queue and the rest are spread over all of them. A worker runs its oldest task
+ * first, and once its queue is empty it steals the oldest task of the others,
+ * so no core sits idle while another one has a backlog.
+ */
+class TaskPool {
+public:
+    /**
+     * Called on every worker before it runs any task
+     */
+    using WorkerStart = void (*)(int worker);
+
+private:
+    struct Worker {
+        std::mutex mutex;
+
+        /**
+         * A heap with the oldest task on top
+         */
+        std::vector<Task> queue;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+    WorkerStart onStart;
+
+    /**
+     * The tasks in all the queues, the workers sleep while it is zero
+     */
+    std::atomic<int> pending;
+
+    /**
+     * Where the next task from outside of the pool goes
+     */
+    std::atomic<uint32_t> nextWorker;
+
+    std::mutex sleepMutex;
+    std::condition_variable wakeup;
+    bool running;
+
+    /**
+     * Take the oldest task of the worker, or steal one
+     */
+    bool Take(int worker, Task& task);
+
+    void WorkerThread(int worker);
+
+public:
+
+    /**
+     * @param workerCount   [IN] The amount of worker threads
+     * @param onStart       [IN] Sets up every worker, can be null
+     */
+    TaskPool(int workerCount, WorkerStart onStart);
+    ~TaskPool();
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    /**
+     * Queue a task, it can be submitted from anywhere including other tasks
+     */
+    void Submit(const Task& task);
+
+    /**
+     * Stop the workers once they ran every task that is queued, including the ones
+     * the tasks queue while finishing up. Tasks submitted after it returned never run.
+     */
+    void Stop();
+
+    int GetWorkerCount() const;
+};
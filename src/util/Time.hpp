@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+#include <chrono>
+
+/**
+ * Get the current time of the monotonic clock in microseconds, all the
+ * timestamps in the pipeline use this clock
+ */
+static inline int64_t GetMicroseconds() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
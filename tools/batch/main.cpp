@@ -0,0 +1,328 @@
+#include <hyperpose/hyperpose.hpp>
+#include <opencv2/opencv.hpp>
+
+#include <condition_variable>
+#include <algorithm>
+#include <fstream>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <chrono>
+#include <memory>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+#include <pose/ProposalParser.hpp>
+#include <pose/Pose3D.hpp>
+#include <util/TaskPool.hpp>
+#include <util/Process.hpp>
+
+/**
+ * Runs recorded videos through the same network, parser and reconstruction as
+ * the service, as fast as the machine allows, to tune parameters offline.
+ *
+ * The video is decoded and run through the network a batch of frames at a time on
+ * the main thread, and the batches are parsed and reconstructed on all the other
+ * cores while the next batch is in the network.
+ *
+ * The output starts with a header:
+ *      uint32  magic "PMBT"
+ *      uint32  version
+ *      float   frame rate of the video
+ *      uint32  width, height of the video
+ *
+ * And then a record for every frame, little endian with no padding:
+ *      uint32  the index of the frame
+ *      float   the score of the pose, zero if nobody was found
+ *      uint16  x, y of the 18 COCO keypoints, in 1/65535 of the frame
+ *      uint8   the confidence of the 18 keypoints, in 1/255
+ *      float   x, y, z of the 15 joints, in the space of the camera
+ */
+
+/**
+ * The first bytes of an output file, "PMBT"
+ */
+constexpr uint32_t BATCH_MAGIC = 0x54424D50;
+constexpr uint32_t BATCH_VERSION = 1;
+
+/**
+ * How many batches can wait to be parsed per worker, the network
+ * is held back once the workers fall behind
+ */
+constexpr size_t BATCHES_PER_WORKER = 2;
+
+static void Usage(const char* name) {
+    std::printf("usage: %s <model.onnx> <video> <output> [options]\n", name);
+    std::printf("  %-16s %s\n", "--batch <n>", "frames per inference, 8 by default");
+    std::printf("  %-16s %s\n", "--workers <n>", "threads parsing the output, one per core by default");
+    std::printf("  %-16s %s\n", "--frames <n>", "stop after this many frames");
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Processing
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * The result of a single frame
+ */
+struct FrameRecord {
+    uint32_t frame;
+    hyperpose::human_t pose;
+    std::array<vector3, JT_COUNT> joints;
+};
+
+/**
+ * A batch of frames that went through the network, and what we got out of them
+ */
+struct Batch {
+    uint32_t firstFrame;
+    std::vector<std::vector<hyperpose::feature_map_t>> featureMaps;
+    std::vector<FrameRecord> records;
+    bool done;
+};
+
+/**
+ * The batches waiting to be written, in order
+ */
+static std::deque<std::unique_ptr<Batch>> mBatches;
+static std::mutex mBatchesMutex;
+static std::condition_variable mBatchDone;
+
+/**
+ * The size of the network input, for the HyperPose parser
+ */
+static cv::Size mInputSize;
+
+/**
+ * Every worker has its own parsers, and we only fall back to the
+ * HyperPose one for models ours can't parse
+ */
+static thread_local std::unique_ptr<ProposalParser> mProposalParser;
+static thread_local std::unique_ptr<ParsedPoses> mParsedPoses;
+static thread_local std::unique_ptr<hyperpose::parser::pose_proposal> mHyperPoseParser;
+
+/**
+ * Find the best pose of a frame and reconstruct it
+ */
+static void ProcessFrame(const std::vector<hyperpose::feature_map_t>& maps, FrameRecord& record) {
+    if (mProposalParser == nullptr) {
+        mProposalParser = std::make_unique<ProposalParser>();
+        mParsedPoses = std::make_unique<ParsedPoses>();
+    }
+
+    std::vector<hyperpose::human_t> fallbackPoses;
+    const hyperpose::human_t* poses = mParsedPoses->poses.data();
+    size_t count = 0;
+    if (mProposalParser->Parse(maps, *mParsedPoses)) {
+        count = mParsedPoses->count;
+    } else {
+        if (mHyperPoseParser == nullptr) {
+            mHyperPoseParser = std::make_unique<hyperpose::parser::pose_proposal>(mInputSize);
+        }
+        fallbackPoses = mHyperPoseParser->process(maps);
+        poses = fallbackPoses.data();
+        count = fallbackPoses.size();
+    }
+
+    // the offline runs only look at a single person
+    const hyperpose::human_t* best = nullptr;
+    for (size_t i = 0; i < count; i++) {
+        if (best == nullptr || poses[i].score > best->score) {
+            best = &poses[i];
+        }
+    }
+
+    if (best == nullptr) {
+        record.pose = hyperpose::human_t();
+        record.pose.score = 0;
+        record.joints = {};
+        return;
+    }
+
+    record.pose = *best;
+    record.joints = ReconstructPose<CocoTopology>(best->parts.data()).joints;
+}
+
+static void ProcessBatch(void* context) {
+    auto* batch = static_cast<Batch*>(context);
+    for (size_t i = 0; i < batch->featureMaps.size(); i++) {
+        batch->records[i].frame = batch->firstFrame + static_cast<uint32_t>(i);
+        ProcessFrame(batch->featureMaps[i], batch->records[i]);
+    }
+
+    // we don't need the maps anymore, free them on this thread
+    batch->featureMaps.clear();
+
+    {
+        std::lock_guard<std::mutex> guard{mBatchesMutex};
+        batch->done = true;
+    }
+    mBatchDone.notify_all();
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Output
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+static void WriteValue(std::ofstream& file, T value) {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static uint16_t Quantize16(float value) {
+    return static_cast<uint16_t>(std::min(std::max(value, 0.0f), 1.0f) * 65535.0f + 0.5f);
+}
+
+static uint8_t Quantize8(float value) {
+    return static_cast<uint8_t>(std::min(std::max(value, 0.0f), 1.0f) * 255.0f + 0.5f);
+}
+
+static void WriteRecord(std::ofstream& file, const FrameRecord& record) {
+    WriteValue<uint32_t>(file, record.frame);
+    WriteValue<float>(file, record.pose.score);
+    for (const auto& part : record.pose.parts) {
+        WriteValue<uint16_t>(file, part.has_value ? Quantize16(part.x) : 0);
+        WriteValue<uint16_t>(file, part.has_value ? Quantize16(part.y) : 0);
+    }
+    for (const auto& part : record.pose.parts) {
+        WriteValue<uint8_t>(file, part.has_value ? Quantize8(part.score) : 0);
+    }
+    for (const auto& joint : record.joints) {
+        WriteValue<float>(file, joint.x);
+        WriteValue<float>(file, joint.y);
+        WriteValue<float>(file, joint.z);
+    }
+}
+
+/**
+ * Write out the batches that are done, in order
+ *
+ * @param maxWaiting    [IN] Wait until no more than this many batches are left
+ */
+static void WriteBatches(std::ofstream& file, size_t maxWaiting) {
+    std::unique_lock<std::mutex> lock{mBatchesMutex};
+    while (!mBatches.empty()) {
+        if (!mBatches.front()->done) {
+            if (mBatches.size() <= maxWaiting) {
+                break;
+            }
+            mBatchDone.wait(lock);
+            continue;
+        }
+
+        std::unique_ptr<Batch> batch = std::move(mBatches.front());
+        mBatches.pop_front();
+
+        lock.unlock();
+        for (const auto& record : batch->records) {
+            WriteRecord(file, record);
+        }
+        lock.lock();
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char* argv[]) {
+    if (argc < 4) {
+        Usage(argv[0]);
+        return 1;
+    }
+
+    int batchSize = 8;
+    int workers = static_cast<int>(GetPhysicalCores().size());
+    long maxFrames = -1;
+    for (int i = 4; i < argc; i++) {
+        if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batchSize = std::max(std::atoi(argv[++i]), 1);
+        } else if (std::strcmp(argv[i], "--workers") == 0 && i + 1 < argc) {
+            workers = std::max(std::atoi(argv[++i]), 1);
+        } else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            maxFrames = std::atol(argv[++i]);
+        } else {
+            Usage(argv[0]);
+            return 1;
+        }
+    }
+
+    cv::VideoCapture capture(argv[2]);
+    if (!capture.isOpened()) {
+        std::printf("failed to open %s\n", argv[2]);
+        return 1;
+    }
+
+    std::ofstream file(argv[3], std::ios::binary);
+    if (!file) {
+        std::printf("failed to create %s\n", argv[3]);
+        return 1;
+    }
+    WriteValue(file, BATCH_MAGIC);
+    WriteValue(file, BATCH_VERSION);
+    WriteValue<float>(file, static_cast<float>(capture.get(cv::CAP_PROP_FPS)));
+    WriteValue<uint32_t>(file, static_cast<uint32_t>(capture.get(cv::CAP_PROP_FRAME_WIDTH)));
+    WriteValue<uint32_t>(file, static_cast<uint32_t>(capture.get(cv::CAP_PROP_FRAME_HEIGHT)));
+
+    hyperpose::dnn::tensorrt engine(hyperpose::dnn::onnx{ argv[1] }, { 384, 384 }, batchSize);
+    mInputSize = engine.input_size();
+
+    // the main thread decodes and runs the network, and the workers do the rest
+    TaskPool taskPool(workers, nullptr);
+    size_t maxWaiting = BATCHES_PER_WORKER * taskPool.GetWorkerCount();
+
+    using Clock = std::chrono::steady_clock;
+    std::chrono::duration<double> decodeTime {};
+    std::chrono::duration<double> inferenceTime {};
+    auto start = Clock::now();
+
+    std::vector<cv::Mat> images(batchSize);
+    uint32_t frames = 0;
+    bool more = true;
+    while (more) {
+        auto decodeStart = Clock::now();
+        int count = 0;
+        while (count < batchSize && (maxFrames < 0 || static_cast<long>(frames) + count < maxFrames)) {
+            if (!capture.read(images[count])) {
+                break;
+            }
+            count++;
+        }
+        more = count == batchSize;
+        if (count == 0) {
+            break;
+        }
+
+        auto inferenceStart = Clock::now();
+        auto batch = std::make_unique<Batch>();
+        batch->firstFrame = frames;
+        batch->featureMaps = engine.inference(std::vector<cv::Mat>(images.begin(), images.begin() + count));
+        batch->records.resize(count);
+        batch->done = false;
+        frames += count;
+
+        auto inferenceEnd = Clock::now();
+        decodeTime += inferenceStart - decodeStart;
+        inferenceTime += inferenceEnd - inferenceStart;
+
+        Batch* pending = batch.get();
+        {
+            std::lock_guard<std::mutex> guard{mBatchesMutex};
+            mBatches.push_back(std::move(batch));
+        }
+        taskPool.Submit({ ProcessBatch, pending, static_cast<int64_t>(pending->firstFrame) });
+
+        // write whatever is done, and hold back if the workers can't keep up
+        WriteBatches(file, maxWaiting);
+    }
+
+    WriteBatches(file, 0);
+    taskPool.Stop();
+
+    std::chrono::duration<double> total = Clock::now() - start;
+    std::printf("%u frames in %.2f s, %.1f fps\n", frames, total.count(), frames / std::max(total.count(), 1e-9));
+    std::printf("  decode     %.2f ms per frame\n", decodeTime.count() * 1000.0 / std::max<uint32_t>(frames, 1));
+    std::printf("  inference  %.2f ms per frame, batches of %d\n", inferenceTime.count() * 1000.0 / std::max<uint32_t>(frames, 1), batchSize);
+    std::printf("  %d workers parsing and reconstructing\n", taskPool.GetWorkerCount());
+    return file ? 0 : 1;
+}
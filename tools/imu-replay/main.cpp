@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <fstream>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cmath>
+
+#include <net/ImuPacket.hpp>
+#include <net/UdpSocket.hpp>
+
+/**
+ * Sends IMU samples to the driver just like a phone strapped to a tracker would, so
+ * the fusion can be tested on loopback without a phone.
+ *
+ * The samples come from a CSV file with a line per sample of time in seconds,
+ * acceleration in m/s^2 and rotation rate in rad/s:
+ *
+ *      time,ax,ay,az,gx,gy,gz
+ *
+ * Without a file a phone going around in a circle while turning with it is made up.
+ */
+
+/**
+ * The made up phone, it goes around a circle of this radius this many times a second
+ */
+constexpr double CIRCLE_RADIUS = 0.3;
+constexpr double CIRCLE_RATE = 0.5;
+
+constexpr double GRAVITY = 9.81;
+constexpr double PI = 3.14159265358979;
+
+static void Usage(const char* name) {
+    std::printf("usage: %s [file.csv|-] [host] [port] [options]\n", name);
+    std::printf("  %-16s %s\n", "file.csv", "the samples to send, - or nothing makes them up");
+    std::printf("  %-16s %s\n", "host", "where to send the samples (default 127.0.0.1)");
+    std::printf("  %-16s %s\n", "port", "the port the driver listens on (default 5100)");
+    std::printf("  %-16s %s\n", "--tracker <n>", "the tracker the phone is on (default 2, the hip)");
+    std::printf("  %-16s %s\n", "--rate <hz>", "the rate of the made up samples (default 200)");
+    std::printf("  %-16s %s\n", "--batch <n>", "how many samples to send in a packet (default 1)");
+    std::printf("  %-16s %s\n", "--loop", "start over at the end of the file");
+}
+
+/**
+ * Read the samples of a CSV file, lines that are not numbers (like a header) are skipped
+ */
+static bool ReadSamples(const std::string& path, std::vector<ImuPacketSample>& samples) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        double time;
+        float a[3], g[3];
+        if (std::sscanf(line.c_str(), "%lf,%f,%f,%f,%f,%f,%f", &time, &a[0], &a[1], &a[2], &g[0], &g[1], &g[2]) != 7) {
+            continue;
+        }
+
+        ImuPacketSample sample {};
+        sample.time = static_cast<int64_t>(time * 1000000.0);
+        std::memcpy(sample.acceleration, a, sizeof(a));
+        std::memcpy(sample.rotationRate, g, sizeof(g));
+        samples.push_back(sample);
+    }
+
+    return !samples.empty();
+}
+
+/**
+ * Make up a few seconds of a phone lying flat, going around a circle and turning with
+ * it, with y up like the play space
+ */
+static void MakeSamples(double rate, std::vector<ImuPacketSample>& samples) {
+    double omega = 2.0 * PI * CIRCLE_RATE;
+    int count = static_cast<int>(rate / CIRCLE_RATE);
+
+    for (int i = 0; i < count; i++) {
+        double time = i / rate;
+        double angle = omega * time;
+
+        // towards the center of the circle, turned into the axes of the phone
+        double ax = -CIRCLE_RADIUS * omega * omega * std::cos(angle);
+        double az = -CIRCLE_RADIUS * omega * omega * std::sin(angle);
+        double c = std::cos(angle);
+        double s = std::sin(angle);
+
+        ImuPacketSample sample {};
+        sample.time = static_cast<int64_t>(time * 1000000.0);
+        sample.acceleration[0] = static_cast<float>(c * ax - s * az);
+        sample.acceleration[1] = static_cast<float>(GRAVITY);
+        sample.acceleration[2] = static_cast<float>(s * ax + c * az);
+        sample.rotationRate[1] = static_cast<float>(omega);
+        samples.push_back(sample);
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string path;
+    std::string host = "127.0.0.1";
+    int port = IMU_DEFAULT_PORT;
+    int tracker = 2;
+    double rate = 200;
+    int batch = 1;
+    bool loop = false;
+
+    int positional = 0;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--loop") == 0) {
+            loop = true;
+        } else if (std::strcmp(argv[i], "--tracker") == 0 && i + 1 < argc) {
+            tracker = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            rate = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc) {
+            batch = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--help") == 0) {
+            Usage(argv[0]);
+            return 0;
+        } else {
+            switch (positional++) {
+                case 0: path = argv[i]; break;
+                case 1: host = argv[i]; break;
+                case 2: port = std::atoi(argv[i]); break;
+                default: Usage(argv[0]); return 1;
+            }
+        }
+    }
+
+    if (tracker < 0 || tracker > 255 || rate <= 0 || batch < 1 || batch > static_cast<int>(IMU_PACKET_MAX_SAMPLES)) {
+        Usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<ImuPacketSample> samples;
+    if (path.empty() || path == "-") {
+        MakeSamples(rate, samples);
+        loop = true;
+    } else if (!ReadSamples(path, samples)) {
+        std::printf("failed to read %s\n", path.c_str());
+        return 1;
+    }
+
+    UdpSocket socket;
+    if (!socket.Connect(host.c_str(), static_cast<uint16_t>(port))) {
+        std::printf("invalid address %s\n", host.c_str());
+        return 1;
+    }
+    std::printf("sending %zu samples to tracker %d, %d per packet\n", samples.size(), tracker, batch);
+
+    // every pass starts where the last one ended, so the clock only goes forward
+    int64_t first = samples.front().time;
+    int64_t length = samples.back().time - first + static_cast<int64_t>(1000000.0 / rate);
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<uint8_t> packet(sizeof(ImuPacketHeader) + IMU_PACKET_MAX_SAMPLES * sizeof(ImuPacketSample));
+    ImuPacketHeader header {};
+    header.magic = IMU_PACKET_MAGIC;
+    header.version = IMU_PACKET_VERSION;
+    header.tracker = static_cast<uint8_t>(tracker);
+
+    uint64_t sent = 0;
+    int64_t base = 0;
+    do {
+        for (size_t i = 0; i < samples.size(); i += batch) {
+            size_t count = std::min(samples.size() - i, static_cast<size_t>(batch));
+
+            // a packet goes out once its newest sample was taken
+            int64_t last = base + samples[i + count - 1].time - first;
+            std::this_thread::sleep_until(start + std::chrono::microseconds(last));
+
+            header.count = static_cast<uint8_t>(count);
+            std::memcpy(packet.data(), &header, sizeof(header));
+            for (size_t j = 0; j < count; j++) {
+                ImuPacketSample sample = samples[i + j];
+                sample.time = base + sample.time - first;
+                std::memcpy(packet.data() + sizeof(header) + j * sizeof(sample), &sample, sizeof(sample));
+            }
+
+            if (!socket.Send(packet.data(), sizeof(header) + count * sizeof(ImuPacketSample))) {
+                std::printf("failed to send packet %u\n", header.sequence);
+                return 1;
+            }
+            header.sequence++;
+            sent += count;
+        }
+        base += length;
+    } while (loop);
+
+    std::printf("sent %llu samples\n", static_cast<unsigned long long>(sent));
+    return 0;
+}
@@ -0,0 +1,148 @@
+"""
+Exports a VideoPose3D checkpoint to the lifter model of pmfbt (--lifter).
+
+The checkpoint must be of a causal model (trained with --causal), a symmetric one
+gives the pose of the middle frame of its window, which the lifter can't know about.
+The filters must all have the same width, like the pretrained 3,3,3 (27 frames) or
+3,3,3,3,3 (243 frames) ones.
+
+The 2d keypoints of VideoPose3D are in pixels normalized by the width of the image,
+ours are normalized by the width and the height, so the normalization is folded into
+the first convolution with the aspect ratio of the camera. The batch norms are folded
+into the convolutions before them. The joints we don't have as inputs (the eyes and
+the ears) get the head, and the outputs are picked and scaled from meters to body
+proportion units.
+
+usage: export.py <checkpoint.bin> <output.pmlf> [--layout coco|h36m] [--aspect 0.5625] [--height 1.7]
+"""
+
+import argparse
+import struct
+
+import numpy as np
+import torch
+
+MAGIC = 0x464C4D50
+VERSION = 1
+
+# the joints of pmfbt, in the order of src/pose/Joints.hpp
+JOINTS = [
+    'head', 'collarbone', 'tailbone', 'right shoulder', 'left shoulder', 'right hip', 'left hip',
+    'right elbow', 'left elbow', 'right knee', 'left knee', 'right wrist', 'left wrist',
+    'right ankle', 'left ankle',
+]
+
+# the body height in src/pose/Skeleton.hpp
+HEIGHT = 70.0
+
+# the 2d inputs of the checkpoint, as how much of every one of our joints they are
+INPUT_LAYOUTS = {
+    # COCO keypoints, like the pretrained_h36m_detectron_coco checkpoint
+    'coco': [
+        {'head': 1.0}, {'head': 1.0}, {'head': 1.0}, {'head': 1.0}, {'head': 1.0},
+        {'left shoulder': 1.0}, {'right shoulder': 1.0},
+        {'left elbow': 1.0}, {'right elbow': 1.0},
+        {'left wrist': 1.0}, {'right wrist': 1.0},
+        {'left hip': 1.0}, {'right hip': 1.0},
+        {'left knee': 1.0}, {'right knee': 1.0},
+        {'left ankle': 1.0}, {'right ankle': 1.0},
+    ],
+    # Human3.6M joints, like the pretrained_h36m_cpn checkpoint
+    'h36m': [
+        {'tailbone': 1.0},
+        {'right hip': 1.0}, {'right knee': 1.0}, {'right ankle': 1.0},
+        {'left hip': 1.0}, {'left knee': 1.0}, {'left ankle': 1.0},
+        {'tailbone': 0.5, 'collarbone': 0.5}, {'collarbone': 1.0}, {'head': 1.0}, {'head': 1.0},
+        {'left shoulder': 1.0}, {'left elbow': 1.0}, {'left wrist': 1.0},
+        {'right shoulder': 1.0}, {'right elbow': 1.0}, {'right wrist': 1.0},
+    ],
+}
+
+# the 3d outputs of VideoPose3D are always the Human3.6M joints
+OUTPUTS = {
+    'head': 10, 'collarbone': 8, 'tailbone': 0,
+    'right shoulder': 14, 'left shoulder': 11, 'right hip': 1, 'left hip': 4,
+    'right elbow': 15, 'left elbow': 12, 'right knee': 2, 'left knee': 5,
+    'right wrist': 16, 'left wrist': 13, 'right ankle': 3, 'left ankle': 6,
+}
+
+
+def fold_batch_norm(weights, bias, state, name):
+    """ Fold the batch norm called name into a convolution without a bias of its own """
+    scale = state[name + '.weight'] / np.sqrt(state[name + '.running_var'] + 1e-5)
+    weights = weights * scale[:, None, None]
+    bias = (bias - state[name + '.running_mean']) * scale + state[name + '.bias']
+    return weights, bias
+
+
+def remap_inputs(weights, layout, aspect):
+    """
+    Make the expansion take x, y of our joints normalized by the width and the height,
+    gives the new weights and the bias the normalization adds
+    """
+    sources = INPUT_LAYOUTS[layout]
+    if weights.shape[1] != len(sources) * 2:
+        raise SystemExit('the checkpoint takes %d inputs, the %s layout has %d' % (weights.shape[1], layout, len(sources) * 2))
+
+    # x' = 2x - 1 and y' = aspect * (2y - 1)
+    factors = [2.0, 2.0 * aspect]
+    offsets = [-1.0, -aspect]
+
+    remapped = np.zeros((weights.shape[0], len(JOINTS) * 2, weights.shape[2]), dtype=np.float64)
+    bias = np.zeros(weights.shape[0], dtype=np.float64)
+    for source, joints in enumerate(sources):
+        for axis in range(2):
+            column = weights[:, source * 2 + axis, :]
+            bias += column.sum(axis=1) * offsets[axis]
+            for joint, amount in joints.items():
+                remapped[:, JOINTS.index(joint) * 2 + axis, :] += column * factors[axis] * amount
+    return remapped, bias
+
+
+def write_layer(out, weights, bias):
+    out.write(np.ascontiguousarray(weights, dtype='<f4').tobytes())
+    out.write(np.ascontiguousarray(bias, dtype='<f4').tobytes())
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Export a causal VideoPose3D checkpoint for the pmfbt lifter')
+    parser.add_argument('checkpoint')
+    parser.add_argument('output')
+    parser.add_argument('--layout', choices=INPUT_LAYOUTS.keys(), default='coco', help='the keypoints the checkpoint takes')
+    parser.add_argument('--aspect', type=float, default=9.0 / 16.0, help='the height of the camera image over its width')
+    parser.add_argument('--height', type=float, default=1.7, help='how tall a person is, in meters')
+    args = parser.parse_args()
+
+    checkpoint = torch.load(args.checkpoint, map_location='cpu')
+    state = checkpoint.get('model_pos', checkpoint)
+    state = {key.replace('module.', '', 1): value.double().numpy() for key, value in state.items()}
+
+    expand = state['expand_conv.weight']
+    channels, _, width = expand.shape
+    blocks = len([key for key in state if key.startswith('layers_conv.') and key.endswith('.weight')]) // 2
+    if channels % 4 != 0:
+        raise SystemExit('the lifter needs a multiple of 4 channels, the checkpoint has %d' % channels)
+    for block in range(blocks):
+        if state['layers_conv.%d.weight' % (block * 2)].shape[2] != width:
+            raise SystemExit('the lifter needs filters of the same width')
+
+    with open(args.output, 'wb') as out:
+        out.write(struct.pack('<5If', MAGIC, VERSION, channels, blocks, width, HEIGHT / args.height))
+
+        weights, bias = remap_inputs(expand, args.layout, args.aspect)
+        write_layer(out, *fold_batch_norm(weights, bias, state, 'expand_bn'))
+
+        for block in range(blocks):
+            for layer in (block * 2, block * 2 + 1):
+                weights = state['layers_conv.%d.weight' % layer]
+                write_layer(out, *fold_batch_norm(weights, np.zeros(channels), state, 'layers_bn.%d' % layer))
+
+        # the shrink gives x, y, z of the Human3.6M joints, pick ours out of it
+        rows = [OUTPUTS[joint] * 3 + axis for joint in JOINTS for axis in range(3)]
+        write_layer(out, state['shrink.weight'][rows], state['shrink.bias'][rows])
+
+    print('%d channels, %d blocks, %d wide, %d frames' % (channels, blocks, width, width ** (blocks + 1)))
+
+
+if __name__ == '__main__':
+    main()
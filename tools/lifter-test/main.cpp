@@ -0,0 +1,311 @@
+#include <filesystem>
+#include <algorithm>
+#include <fstream>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <array>
+
+#include <pose/TemporalLifter.hpp>
+#include <pose/Skeleton.hpp>
+
+/**
+ * Checks the temporal lifter against a straightforward version of the same network,
+ * on random weights and keypoints.
+ *
+ * The lifter only runs the newest frame, with the SSE or NEON kernels, out of the
+ * rings of the older frames. The reference here runs every layer for every frame
+ * in double precision, so a mistake in the kernels, the layout of the weights or
+ * the rings shows up as a difference in the joints.
+ */
+
+/**
+ * How far the joints may be from the reference, relative to the largest of them
+ */
+constexpr double TOLERANCE = 1e-4;
+
+/**
+ * How many frames every network lifts, a few times the largest receptive field
+ */
+constexpr int FRAMES = 200;
+
+/**
+ * The time between frames, in microseconds
+ */
+constexpr int64_t FRAME_TIME = 33333;
+
+/**
+ * The shapes to check, the channels cover both the kernels that do 16 outputs at
+ * a time and the ones that do 4
+ */
+struct Shape {
+    int channels;
+    int blocks;
+    int width;
+};
+
+static const Shape SHAPES[] = {
+    { 16, 1, 2 },
+    { 20, 2, 3 },
+    { 36, 3, 2 },
+    { 64, 2, 3 },
+    { 12, 4, 3 },
+};
+
+/**
+ * The distributions of the standard library differ between implementations,
+ * so only the engine is used and the rest is done here
+ */
+class Random {
+private:
+    std::mt19937_64 engine;
+
+public:
+
+    explicit Random(uint64_t seed)
+        : engine(seed)
+    {
+    }
+
+    float Uniform(float min, float max) {
+        double unit = static_cast<double>(engine() >> 11) * (1.0 / 9007199254740992.0);
+        return static_cast<float>(min + (max - min) * unit);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Reference
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A convolution as it is in the file, weights[out][in][tap]
+ */
+struct Convolution {
+    int inputs;
+    int outputs;
+    int taps;
+    int dilation;
+    std::vector<float> weights;
+    std::vector<float> bias;
+};
+
+static Convolution MakeConvolution(Random& random, int inputs, int outputs, int taps, int dilation) {
+    Convolution conv { inputs, outputs, taps, dilation, {}, {} };
+
+    // scaled so the activations stay around one through all the layers
+    float range = 1.0f / std::sqrt(static_cast<float>(inputs * taps));
+    conv.weights.resize(static_cast<size_t>(outputs) * inputs * taps);
+    for (float& weight : conv.weights) {
+        weight = random.Uniform(-range, range);
+    }
+    conv.bias.resize(outputs);
+    for (float& bias : conv.bias) {
+        bias = random.Uniform(-0.1f, 0.1f);
+    }
+    return conv;
+}
+
+struct Network {
+    Shape shape;
+    float scale;
+    Convolution expand;
+    std::vector<Convolution> dilated;
+    std::vector<Convolution> pointwise;
+    Convolution shrink;
+};
+
+static Network MakeNetwork(Random& random, const Shape& shape) {
+    Network network { shape, random.Uniform(10.0f, 50.0f), {}, {}, {}, {} };
+    network.expand = MakeConvolution(random, LifterModel::INPUTS, shape.channels, shape.width, 1);
+    int dilation = shape.width;
+    for (int block = 0; block < shape.blocks; block++) {
+        network.dilated.push_back(MakeConvolution(random, shape.channels, shape.channels, shape.width, dilation));
+        network.pointwise.push_back(MakeConvolution(random, shape.channels, shape.channels, 1, 1));
+        dilation *= shape.width;
+    }
+    network.shrink = MakeConvolution(random, shape.channels, LifterModel::OUTPUTS, 1, 1);
+    return network;
+}
+
+template <typename T>
+static void WriteValue(std::ofstream& file, T value) {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void WriteConvolution(std::ofstream& file, const Convolution& conv) {
+    file.write(reinterpret_cast<const char*>(conv.weights.data()), static_cast<std::streamsize>(conv.weights.size() * sizeof(float)));
+    file.write(reinterpret_cast<const char*>(conv.bias.data()), static_cast<std::streamsize>(conv.bias.size() * sizeof(float)));
+}
+
+/**
+ * Write the network in the layout described in TemporalLifter.hpp
+ */
+static bool WriteNetwork(const std::string& path, const Network& network) {
+    std::ofstream file(path, std::ios::binary);
+    WriteValue<uint32_t>(file, 0x464C4D50);
+    WriteValue<uint32_t>(file, 1);
+    WriteValue<uint32_t>(file, network.shape.channels);
+    WriteValue<uint32_t>(file, network.shape.blocks);
+    WriteValue<uint32_t>(file, network.shape.width);
+    WriteValue<float>(file, network.scale);
+    WriteConvolution(file, network.expand);
+    for (int block = 0; block < network.shape.blocks; block++) {
+        WriteConvolution(file, network.dilated[block]);
+        WriteConvolution(file, network.pointwise[block]);
+    }
+    WriteConvolution(file, network.shrink);
+    return static_cast<bool>(file);
+}
+
+/**
+ * Run a convolution for a frame, the frames before the first one are the first one
+ */
+static std::vector<double> Convolve(const Convolution& conv, const std::vector<std::vector<double>>& frames, int frame) {
+    std::vector<double> output(conv.bias.begin(), conv.bias.end());
+    for (int tap = 0; tap < conv.taps; tap++) {
+        const auto& input = frames[std::max(frame - (conv.taps - 1 - tap) * conv.dilation, 0)];
+        for (int o = 0; o < conv.outputs; o++) {
+            for (int i = 0; i < conv.inputs; i++) {
+                output[o] += conv.weights[(static_cast<size_t>(o) * conv.inputs + i) * conv.taps + tap] * input[i];
+            }
+        }
+    }
+    return output;
+}
+
+static void Relu(std::vector<double>& values) {
+    for (double& value : values) {
+        value = std::max(value, 0.0);
+    }
+}
+
+/**
+ * Run the whole network on every frame, and give the joints of every frame
+ * relative to the root, in body proportion units
+ */
+static std::vector<std::array<vector3, JT_COUNT>> RunReference(const Network& network, const std::vector<std::vector<double>>& inputs) {
+    int frames = static_cast<int>(inputs.size());
+
+    std::vector<std::vector<double>> layer(frames);
+    for (int frame = 0; frame < frames; frame++) {
+        layer[frame] = Convolve(network.expand, inputs, frame);
+        Relu(layer[frame]);
+    }
+
+    for (int block = 0; block < network.shape.blocks; block++) {
+        std::vector<std::vector<double>> next(frames);
+        for (int frame = 0; frame < frames; frame++) {
+            std::vector<std::vector<double>> hidden { Convolve(network.dilated[block], layer, frame) };
+            Relu(hidden[0]);
+            next[frame] = Convolve(network.pointwise[block], hidden, 0);
+            Relu(next[frame]);
+            for (int i = 0; i < network.shape.channels; i++) {
+                next[frame][i] += layer[frame][i];
+            }
+        }
+        layer = std::move(next);
+    }
+
+    std::vector<std::array<vector3, JT_COUNT>> joints(frames);
+    for (int frame = 0; frame < frames; frame++) {
+        std::vector<double> output = Convolve(network.shrink, layer, frame);
+        for (int i = 0; i < JT_COUNT; i++) {
+            joints[frame][i] = vector3(
+                    static_cast<float>((output[i * 3] - output[SKELETON_ROOT * 3]) * network.scale),
+                    static_cast<float>((output[i * 3 + 1] - output[SKELETON_ROOT * 3 + 1]) * network.scale),
+                    static_cast<float>((output[i * 3 + 2] - output[SKELETON_ROOT * 3 + 2]) * network.scale));
+        }
+    }
+    return joints;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Test
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Lift random keypoints with both, and give the largest difference relative to the largest joint
+ */
+static double Check(Random& random, const Shape& shape, const std::string& path) {
+    Network network = MakeNetwork(random, shape);
+    if (!WriteNetwork(path, network)) {
+        std::printf("  failed to write %s\n", path.c_str());
+        return INFINITY;
+    }
+
+    LifterModel model;
+    if (!model.Load(path)) {
+        std::printf("  failed to load the model\n");
+        return INFINITY;
+    }
+    TemporalLifter lifter;
+    lifter.SetModel(&model);
+
+    // a person moving around a bit in the middle of the frame
+    std::vector<SkeletonObservation> observations(FRAMES);
+    std::vector<std::vector<double>> inputs(FRAMES);
+    std::array<vector2, JT_COUNT> points;
+    for (auto& point : points) {
+        point = vector2(random.Uniform(0.3f, 0.7f), random.Uniform(0.2f, 0.8f));
+    }
+    for (int frame = 0; frame < FRAMES; frame++) {
+        for (int i = 0; i < JT_COUNT; i++) {
+            points[i] = points[i] + vector2(random.Uniform(-0.01f, 0.01f), random.Uniform(-0.01f, 0.01f));
+            observations[frame].points[i] = points[i];
+            observations[frame].confidences[i] = 1.0f;
+            inputs[frame].push_back(points[i].x);
+            inputs[frame].push_back(points[i].y);
+        }
+    }
+
+    auto reference = RunReference(network, inputs);
+
+    double largest = 0.0;
+    double difference = 0.0;
+    for (int frame = 0; frame < FRAMES; frame++) {
+        std::array<vector3, JT_COUNT> joints;
+        if (!lifter.Lift(frame * FRAME_TIME, observations[frame], joints)) {
+            std::printf("  frame %d was not lifted\n", frame);
+            return INFINITY;
+        }
+
+        // the lifter places the person in front of the camera, the reference only has the pose
+        for (int i = 0; i < JT_COUNT; i++) {
+            vector3 joint = joints[i] - joints[SKELETON_ROOT];
+            const vector3& expected = reference[frame][i];
+            largest = std::max<double>(largest, expected.magnitude());
+            difference = std::max<double>(difference, (joint - expected).magnitude());
+        }
+    }
+
+    return difference / std::max(largest, 1e-9);
+}
+
+int main() {
+    Random random(1);
+    std::string path = (std::filesystem::temp_directory_path() / "pmfbt-lifter-test.pmlf").string();
+
+#if defined(__SSE2__) || defined(_M_X64)
+    std::printf("checking the SSE kernels\n");
+#elif defined(__ARM_NEON)
+    std::printf("checking the NEON kernels\n");
+#else
+    std::printf("checking the scalar kernels\n");
+#endif
+
+    bool passed = true;
+    for (const auto& shape : SHAPES) {
+        double error = Check(random, shape, path);
+        bool ok = error <= TOLERANCE;
+        std::printf("  %4d channels, %d blocks, %d wide: %.3e %s\n", shape.channels, shape.blocks, shape.width,
+                    error, ok ? "ok" : "FAILED");
+        passed = passed && ok;
+    }
+
+    std::error_code error;
+    std::filesystem::remove(path, error);
+    return passed ? 0 : 1;
+}
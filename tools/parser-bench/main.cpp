@@ -0,0 +1,316 @@
+#include <hyperpose/hyperpose.hpp>
+#include <opencv2/opencv.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <pose/ProposalParser.hpp>
+
+/**
+ * Compares our proposal parser with the one of HyperPose on recorded feature
+ * maps, for speed and for how well the poses agree.
+ *
+ * The maps are recorded once from a video with the model, the comparison
+ * itself doesn't need a GPU.
+ */
+
+/**
+ * The first bytes of a maps file
+ */
+constexpr uint32_t MAPS_MAGIC = 0x4D464D50;
+
+/**
+ * Keypoints closer than this, in normalized image coordinates, count as the same
+ */
+constexpr float MATCH_DISTANCE = 0.02f;
+
+using FeatureMaps = std::vector<hyperpose::feature_map_t>;
+
+static void Usage(const char* name) {
+    std::printf("usage: %s record <model.onnx> <video> <maps> [frames]\n", name);
+    std::printf("       %s <maps> [iterations] [--min-agreement <percent>]\n", name);
+    std::printf("  record           run the model on a video and save the feature maps\n");
+    std::printf("  iterations       how many times to parse every frame (default 100)\n");
+    std::printf("  --min-agreement  fail if fewer of the keypoints agree, for the tests\n");
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Maps file
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+static void WriteValue(std::ofstream& file, T value) {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+static bool ReadValue(std::ifstream& file, T& value) {
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+static void WriteMaps(std::ofstream& file, const FeatureMaps& maps) {
+    WriteValue<uint32_t>(file, maps.size());
+    for (const auto& map : maps) {
+        WriteValue<uint32_t>(file, map.name().size());
+        file.write(map.name().data(), map.name().size());
+
+        size_t size = 1;
+        WriteValue<uint32_t>(file, map.shape().size());
+        for (int dimension : map.shape()) {
+            WriteValue<int32_t>(file, dimension);
+            size *= dimension;
+        }
+        file.write(reinterpret_cast<const char*>(map.view<float>()), size * sizeof(float));
+    }
+}
+
+static bool ReadMaps(std::ifstream& file, FeatureMaps& maps) {
+    uint32_t count;
+    if (!ReadValue(file, count)) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t nameLength;
+        if (!ReadValue(file, nameLength)) {
+            return false;
+        }
+        std::string name(nameLength, '\0');
+        file.read(&name[0], nameLength);
+
+        uint32_t dimensions;
+        if (!ReadValue(file, dimensions)) {
+            return false;
+        }
+        std::vector<int> shape(dimensions);
+        size_t size = 1;
+        for (auto& dimension : shape) {
+            int32_t value;
+            if (!ReadValue(file, value)) {
+                return false;
+            }
+            dimension = value;
+            size *= value;
+        }
+
+        std::unique_ptr<char[]> data(new char[size * sizeof(float)]);
+        if (!file.read(data.get(), size * sizeof(float))) {
+            return false;
+        }
+        maps.emplace_back(name, std::move(data), shape);
+    }
+
+    return true;
+}
+
+static int Record(const char* model, const char* video, const char* output, int maxFrames) {
+    cv::VideoCapture capture(video);
+    if (!capture.isOpened()) {
+        std::printf("failed to open %s\n", video);
+        return 1;
+    }
+
+    std::ofstream file(output, std::ios::binary);
+    if (!file) {
+        std::printf("failed to create %s\n", output);
+        return 1;
+    }
+    WriteValue(file, MAPS_MAGIC);
+
+    hyperpose::dnn::tensorrt engine(hyperpose::dnn::onnx{ model }, { 384, 384 }, 1);
+
+    cv::Mat image;
+    int frames = 0;
+    while (frames < maxFrames && capture.read(image)) {
+        auto featureMaps = engine.inference({ image });
+        WriteMaps(file, featureMaps.front());
+        frames++;
+    }
+
+    std::printf("recorded %d frames\n", frames);
+    return 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Comparison
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * How well the poses of our parser match the ones of HyperPose
+ */
+struct Agreement {
+    uint64_t ourPoses = 0;
+    uint64_t theirPoses = 0;
+    uint64_t matchedKeypoints = 0;
+    uint64_t totalKeypoints = 0;
+    double distance = 0;
+};
+
+/**
+ * Match every one of our poses with the pose of HyperPose that shares the most
+ * keypoints with it, and count the keypoints both found at the same place
+ */
+static void Compare(const ParsedPoses& ours, const std::vector<hyperpose::human_t>& theirs, Agreement& agreement) {
+    agreement.ourPoses += ours.count;
+    agreement.theirPoses += theirs.size();
+
+    std::vector<bool> taken(theirs.size());
+    for (int i = 0; i < ours.count; i++) {
+        const auto& pose = ours.poses[i];
+
+        int best = -1;
+        int bestMatches = 0;
+        for (size_t j = 0; j < theirs.size(); j++) {
+            int matches = 0;
+            for (size_t part = 0; part < hyperpose::COCO_N_PARTS; part++) {
+                const auto& a = pose.parts[part];
+                const auto& b = theirs[j].parts[part];
+                if (a.has_value && b.has_value && std::hypot(a.x - b.x, a.y - b.y) < MATCH_DISTANCE) {
+                    matches++;
+                }
+            }
+            if (!taken[j] && matches > bestMatches) {
+                best = static_cast<int>(j);
+                bestMatches = matches;
+            }
+        }
+
+        if (best >= 0) {
+            taken[best] = true;
+        }
+
+        for (size_t part = 0; part < hyperpose::COCO_N_PARTS; part++) {
+            const auto& a = pose.parts[part];
+            const hyperpose::body_part_t* b = best >= 0 ? &theirs[best].parts[part] : nullptr;
+            bool theyHave = b != nullptr && b->has_value;
+            if (!a.has_value && !theyHave) {
+                continue;
+            }
+
+            agreement.totalKeypoints++;
+            if (a.has_value && theyHave) {
+                float distance = std::hypot(a.x - b->x, a.y - b->y);
+                if (distance < MATCH_DISTANCE) {
+                    agreement.matchedKeypoints++;
+                    agreement.distance += distance;
+                }
+            }
+        }
+    }
+
+    // the poses only they found count as missed keypoints
+    for (size_t j = 0; j < theirs.size(); j++) {
+        if (taken[j]) {
+            continue;
+        }
+        for (const auto& part : theirs[j].parts) {
+            agreement.totalKeypoints += part.has_value ? 1 : 0;
+        }
+    }
+}
+
+static int Benchmark(const char* path, int iterations, double minAgreement) {
+    std::ifstream file(path, std::ios::binary);
+    uint32_t magic;
+    if (!file || !ReadValue(file, magic) || magic != MAPS_MAGIC) {
+        std::printf("%s is not a maps file\n", path);
+        return 1;
+    }
+
+    std::vector<FeatureMaps> frames;
+    while (true) {
+        FeatureMaps maps;
+        if (!ReadMaps(file, maps)) {
+            break;
+        }
+        frames.push_back(std::move(maps));
+    }
+    if (frames.empty()) {
+        std::printf("no frames in %s\n", path);
+        return 1;
+    }
+
+    // the grid is 32 pixels a cell, which gives us the input size back
+    const auto& shape = frames.front().front().shape();
+    int gridHeight = shape[shape.size() - 2];
+    int gridWidth = shape[shape.size() - 1];
+    hyperpose::parser::pose_proposal theirParser({ gridWidth * 32, gridHeight * 32 });
+    ProposalParser ourParser;
+
+    ParsedPoses ours {};
+    std::vector<hyperpose::human_t> theirs;
+    Agreement agreement;
+    std::chrono::duration<double, std::micro> ourTime {};
+    std::chrono::duration<double, std::micro> theirTime {};
+
+    for (const auto& maps : frames) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            theirs = theirParser.process(maps);
+        }
+        auto middle = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            if (!ourParser.Parse(maps, ours)) {
+                std::printf("our parser can't parse these maps\n");
+                return 1;
+            }
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        theirTime += middle - start;
+        ourTime += end - middle;
+        Compare(ours, theirs, agreement);
+    }
+
+    double runs = static_cast<double>(frames.size()) * iterations;
+    std::printf("%zu frames, %d iterations each\n", frames.size(), iterations);
+    std::printf("  hyperpose  %8.2f us per frame, %.2f poses per frame\n", theirTime.count() / runs,
+                static_cast<double>(agreement.theirPoses) / frames.size());
+    std::printf("  ours       %8.2f us per frame, %.2f poses per frame\n", ourTime.count() / runs,
+                static_cast<double>(agreement.ourPoses) / frames.size());
+    double agreed = 100.0 * agreement.matchedKeypoints / std::max<uint64_t>(agreement.totalKeypoints, 1);
+    std::printf("  %.1f%% of the keypoints agree, %.4f apart on average\n", agreed,
+                agreement.distance / std::max<uint64_t>(agreement.matchedKeypoints, 1));
+
+    // every keypoint either of the parsers found counts, so poses only one of them found fail it too
+    if (agreed < minAgreement) {
+        std::printf("FAILED: less than %.1f%% of the keypoints agree\n", minAgreement);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc >= 5 && std::strcmp(argv[1], "record") == 0) {
+        int frames = argc >= 6 ? std::atoi(argv[5]) : 1000;
+        return Record(argv[2], argv[3], argv[4], frames);
+    }
+
+    if (argc >= 2 && argv[1][0] != '-' && std::strcmp(argv[1], "record") != 0) {
+        int iterations = 100;
+        double minAgreement = 0.0;
+        for (int i = 2; i < argc; i++) {
+            if (std::strcmp(argv[i], "--min-agreement") == 0 && i + 1 < argc) {
+                minAgreement = std::strtod(argv[++i], nullptr);
+            } else if (argv[i][0] != '-') {
+                iterations = std::atoi(argv[i]);
+            } else {
+                Usage(argv[0]);
+                return 1;
+            }
+        }
+        return Benchmark(argv[1], std::max(iterations, 1), minAgreement);
+    }
+
+    Usage(argv[0]);
+    return 1;
+}
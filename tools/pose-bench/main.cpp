@@ -0,0 +1,416 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <array>
+
+#include <pose/Pose3D.hpp>
+#include <pose/Skeleton.hpp>
+#include <pose/Topology.hpp>
+
+/**
+ * Measures how well and how fast Pose3D reconstructs poses, on random skeletons
+ * that are projected through a camera with noisy and missing keypoints.
+ *
+ * Everything comes from a seeded generator of our own, so the same options give
+ * the same numbers on every machine, and it doesn't need a model or a GPU.
+ */
+
+constexpr float PI = 3.14159265358979f;
+constexpr float DEGREES = PI / 180.0f;
+
+struct Options {
+    long poses = 1000000;
+    uint64_t seed = 1;
+
+    /**
+     * The camera, in normalized image coordinates
+     */
+    float focalLength = FOCAL_LENGTH;
+    float distance = 150.0f;
+
+    /**
+     * The standard deviation of the keypoint positions, in normalized image
+     * coordinates, and the chance that a keypoint is missing
+     */
+    float noise = 0.003f;
+    float dropout = 0.0f;
+
+    /**
+     * How much the proportions of the people differ from the average, per bone
+     */
+    float proportions = 0.05f;
+
+    /**
+     * Give the reconstruction the real depth order of the bones
+     */
+    bool oracleDepth = false;
+
+    const char* topology = "coco";
+
+    /**
+     * Fail if the MPJPE is above this, so the bench can gate changes to the reconstruction
+     */
+    double maxError = 0.0;
+};
+
+static void Usage(const char* name) {
+    std::printf("usage: %s [options]\n", name);
+    std::printf("  %-24s %s\n", "--poses <n>", "how many poses to reconstruct, 1000000 by default");
+    std::printf("  %-24s %s\n", "--seed <n>", "the seed of the random poses");
+    std::printf("  %-24s %s\n", "--focal <f>", "the focal length, in image widths");
+    std::printf("  %-24s %s\n", "--distance <d>", "how far the people stand, in proportion units");
+    std::printf("  %-24s %s\n", "--noise <sigma>", "keypoint noise, in image widths");
+    std::printf("  %-24s %s\n", "--dropout <p>", "the chance a keypoint is missing");
+    std::printf("  %-24s %s\n", "--proportions <p>", "how much the bone lengths differ from the average");
+    std::printf("  %-24s %s\n", "--oracle-depth", "give the real depth order of the bones");
+    std::printf("  %-24s %s\n", "--topology <name>", "coco, coco17 or body25");
+    std::printf("  %-24s %s\n", "--max-error <e>", "fail if the MPJPE is above this");
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Random poses
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * The distributions of the standard library differ between implementations,
+ * so only the engine is used and the rest is done here
+ */
+class Random {
+private:
+    std::mt19937_64 engine;
+
+public:
+
+    explicit Random(uint64_t seed)
+        : engine(seed)
+    {
+    }
+
+    float Uniform(float min, float max) {
+        double unit = static_cast<double>(engine() >> 11) * (1.0 / 9007199254740992.0);
+        return static_cast<float>(min + (max - min) * unit);
+    }
+
+    float Normal() {
+        // Box-Muller, keeping only one of the two
+        float u = Uniform(1e-7f, 1.0f);
+        float v = Uniform(0.0f, 1.0f);
+        return std::sqrt(-2.0f * std::log(u)) * std::cos(2.0f * PI * v);
+    }
+
+    /**
+     * A direction at most the given angle away from the axis
+     */
+    vector3 Cone(const vector3& axis, float maxAngle) {
+        float cosAngle = Uniform(std::cos(maxAngle), 1.0f);
+        float sinAngle = std::sqrt(1.0f - cosAngle * cosAngle);
+        float around = Uniform(0.0f, 2.0f * PI);
+
+        // any two directions perpendicular to the axis
+        vector3 helper = std::fabs(axis.x) < 0.9f ? vector3(1, 0, 0) : vector3(0, 1, 0);
+        vector3 u = axis.cross(helper).normalize();
+        vector3 v = axis.cross(u);
+        return axis * cosAngle + (u * std::cos(around) + v * std::sin(around)) * sinAngle;
+    }
+};
+
+/**
+ * Rotate a direction around an axis
+ */
+static vector3 Rotate(const vector3& direction, const vector3& axis, float angle) {
+    // Rodrigues
+    float c = std::cos(angle);
+    float s = std::sin(angle);
+    return direction * c + axis.cross(direction) * s + axis * (axis.dot(direction) * (1.0f - c));
+}
+
+/**
+ * Make a random person, in the space of the camera. The person is built facing the camera,
+ * with x to their left, y down and z away from the camera, and then turned around.
+ */
+static void MakeSkeleton(Random& random, const Options& options, std::array<vector3, JT_COUNT>& joints) {
+    std::array<float, BONE_COUNT> lengths;
+    for (int i = 0; i < BONE_COUNT; i++) {
+        lengths[i] = BONES[i].length * (1.0f + options.proportions * random.Normal());
+    }
+    auto length = [&](JointType child) {
+        for (int i = 0; i < BONE_COUNT; i++) {
+            if (BONES[i].child == child) {
+                return lengths[i];
+            }
+        }
+        return 0.0f;
+    };
+
+    // the torso, leaning a bit
+    std::array<vector3, JT_COUNT> body;
+    vector3 spine = random.Cone(vector3(0, 1, 0), 20 * DEGREES);
+    body[JT_COLLARBONE] = vector3::zero();
+    body[JT_TAILBONE] = spine * length(JT_TAILBONE);
+    body[JT_HEAD] = random.Cone(-spine, 30 * DEGREES) * length(JT_HEAD);
+
+    vector3 across = vector3(1, 0, 0);
+    body[JT_RIGHT_SHOULDER] = -across * length(JT_RIGHT_SHOULDER);
+    body[JT_LEFT_SHOULDER] = across * length(JT_LEFT_SHOULDER);
+    body[JT_RIGHT_HIP] = body[JT_TAILBONE] - across * length(JT_RIGHT_HIP);
+    body[JT_LEFT_HIP] = body[JT_TAILBONE] + across * length(JT_LEFT_HIP);
+
+    // the arms can go almost anywhere but into the body, and the elbows only bend one way
+    for (int side = 0; side < 2; side++) {
+        JointType shoulder = side == 0 ? JT_RIGHT_SHOULDER : JT_LEFT_SHOULDER;
+        JointType elbow = side == 0 ? JT_RIGHT_ELBOW : JT_LEFT_ELBOW;
+        JointType wrist = side == 0 ? JT_RIGHT_WRIST : JT_LEFT_WRIST;
+        vector3 outward = side == 0 ? -across : across;
+
+        vector3 upperArm = random.Cone((vector3(0, 1, 0) + outward * 0.3f).normalize(), 100 * DEGREES);
+        if (upperArm.dot(outward) < -0.2f) {
+            upperArm = (upperArm + outward * 0.5f).normalize();
+        }
+        vector3 bendAxis = upperArm.cross(random.Cone(vector3(0, 0, -1), 60 * DEGREES)).normalize();
+        vector3 forearm = Rotate(upperArm, bendAxis, random.Uniform(0, 140 * DEGREES));
+
+        body[elbow] = body[shoulder] + upperArm * length(elbow);
+        body[wrist] = body[elbow] + forearm * length(wrist);
+    }
+
+    // the legs mostly swing forward, and the knees only bend backward
+    for (int side = 0; side < 2; side++) {
+        JointType hip = side == 0 ? JT_RIGHT_HIP : JT_LEFT_HIP;
+        JointType knee = side == 0 ? JT_RIGHT_KNEE : JT_LEFT_KNEE;
+        JointType ankle = side == 0 ? JT_RIGHT_ANKLE : JT_LEFT_ANKLE;
+
+        vector3 thigh = random.Cone(vector3(0, 1, -0.3f).normalize(), 45 * DEGREES);
+        vector3 shin = Rotate(thigh, vector3(1, 0, 0), random.Uniform(0, 110 * DEGREES));
+
+        body[knee] = body[hip] + thigh * length(knee);
+        body[ankle] = body[knee] + shin * length(ankle);
+    }
+
+    // turn the whole person, mostly around the vertical
+    float yaw = random.Uniform(-70, 70) * DEGREES;
+    float pitch = random.Uniform(-15, 15) * DEGREES;
+    float roll = random.Uniform(-10, 10) * DEGREES;
+
+    // and put them somewhere in front of the camera, where they fit in the image
+    float depth = options.distance * random.Uniform(0.8f, 1.2f);
+    vector3 position(random.Uniform(-0.1f, 0.1f) * depth, random.Uniform(-0.3f, -0.1f) * depth, depth);
+
+    for (int i = 0; i < JT_COUNT; i++) {
+        vector3 joint = Rotate(body[i], vector3(0, 1, 0), yaw);
+        joint = Rotate(joint, vector3(1, 0, 0), pitch);
+        joint = Rotate(joint, vector3(0, 0, 1), roll);
+        joints[i] = joint + position;
+    }
+}
+
+/**
+ * A keypoint the way a network gives it
+ */
+struct Keypoint {
+    float x, y;
+    float score;
+    bool has_value;
+};
+
+/**
+ * Project the joints into the keypoints of a topology, every keypoint our
+ * joints have directly, the rest stays missing
+ */
+template <typename Topology>
+static void Project(Random& random, const Options& options, const std::array<vector3, JT_COUNT>& joints,
+                    std::array<Keypoint, Topology::KEYPOINT_COUNT>& keypoints) {
+    keypoints = {};
+    for (int i = 0; i < JT_COUNT; i++) {
+        const KeypointSource& source = Topology::JOINTS[i];
+        if (source.first != source.second) {
+            continue;
+        }
+
+        Keypoint& keypoint = keypoints[source.first];
+        if (random.Uniform(0, 1) < options.dropout) {
+            continue;
+        }
+        keypoint.x = 0.5f + options.focalLength * joints[i].x / joints[i].z + options.noise * random.Normal();
+        keypoint.y = 0.5f + options.focalLength * joints[i].y / joints[i].z + options.noise * random.Normal();
+        keypoint.score = 1.0f;
+        keypoint.has_value = true;
+    }
+}
+
+/**
+ * The bones in the order of the relorder of Pose3D
+ */
+static const JointType RELORDER_BONES[11][2] = {
+    { JT_RIGHT_SHOULDER, JT_LEFT_SHOULDER },
+    { JT_COLLARBONE, JT_TAILBONE },
+    { JT_TAILBONE, JT_RIGHT_HIP },
+    { JT_RIGHT_SHOULDER, JT_RIGHT_ELBOW },
+    { JT_LEFT_SHOULDER, JT_LEFT_ELBOW },
+    { JT_RIGHT_HIP, JT_RIGHT_KNEE },
+    { JT_LEFT_HIP, JT_LEFT_KNEE },
+    { JT_RIGHT_ELBOW, JT_RIGHT_WRIST },
+    { JT_LEFT_ELBOW, JT_LEFT_WRIST },
+    { JT_RIGHT_KNEE, JT_RIGHT_ANKLE },
+    { JT_LEFT_KNEE, JT_LEFT_ANKLE },
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Benchmark
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static const char* JOINT_NAMES[JT_COUNT] = {
+    "head", "collarbone", "tailbone", "right shoulder", "left shoulder", "right hip", "left hip",
+    "right elbow", "left elbow", "right knee", "left knee", "right wrist", "left wrist",
+    "right ankle", "left ankle",
+};
+
+template <typename Topology>
+static int Run(const Options& options) {
+    Random random(options.seed);
+
+    // the poses are made in chunks so the timing only covers the reconstruction
+    constexpr int CHUNK = 4096;
+    static std::array<vector3, JT_COUNT> truths[CHUNK];
+    static std::array<Keypoint, Topology::KEYPOINT_COUNT> keypoints[CHUNK];
+    static std::array<int, 11> relorders[CHUNK];
+    static std::array<vector3, JT_COUNT> results[CHUNK];
+
+    std::array<double, JT_COUNT> jointErrors {};
+    std::array<long, JT_COUNT> jointCounts {};
+    double alignedError = 0;
+    double absoluteError = 0;
+    long measured = 0;
+    long nonFinite = 0;
+    long failed = 0;
+    std::chrono::duration<double> time {};
+
+    // the joints are summed up to use them, so the reconstruction can't be optimized away
+    double checksum = 0;
+
+    for (long done = 0; done < options.poses; done += CHUNK) {
+        int count = static_cast<int>(std::min<long>(CHUNK, options.poses - done));
+        for (int i = 0; i < count; i++) {
+            MakeSkeleton(random, options, truths[i]);
+            Project<Topology>(random, options, truths[i], keypoints[i]);
+
+            relorders[i] = {};
+            if (options.oracleDepth) {
+                for (int bone = 0; bone < 11; bone++) {
+                    float parent = truths[i][RELORDER_BONES[bone][0]].z;
+                    float child = truths[i][RELORDER_BONES[bone][1]].z;
+                    relorders[i][bone] = child < parent ? 1 : -1;
+                }
+            }
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < count; i++) {
+            results[i] = ReconstructPose<Topology>(keypoints[i].data(), relorders[i]).joints;
+        }
+        time += std::chrono::steady_clock::now() - start;
+
+        for (int i = 0; i < count; i++) {
+            const auto& truth = truths[i];
+            const auto& result = results[i];
+            if (!std::isfinite(result[JT_COLLARBONE].x + result[JT_COLLARBONE].y + result[JT_COLLARBONE].z)) {
+                failed++;
+                continue;
+            }
+
+            // the error of the pose itself is with both collarbones at the same place
+            vector3 offset = truth[JT_COLLARBONE] - result[JT_COLLARBONE];
+            for (int joint = 0; joint < JT_COUNT; joint++) {
+                float aligned = (result[joint] + offset).distance(truth[joint]);
+                float absolute = result[joint].distance(truth[joint]);
+
+                // a joint that came out as NaN failed, it is counted but not in the error,
+                // and fails the run
+                if (!std::isfinite(aligned) || !std::isfinite(absolute)) {
+                    nonFinite++;
+                    continue;
+                }
+                jointErrors[joint] += aligned;
+                jointCounts[joint]++;
+                alignedError += aligned;
+                absoluteError += absolute;
+                measured++;
+                checksum += result[joint].x;
+            }
+        }
+    }
+
+    double joints = static_cast<double>(std::max<long>(measured, 1));
+    std::printf("%ld poses, %s keypoints, noise %.4f, dropout %.2f, %s depth order\n", options.poses, options.topology,
+                options.noise, options.dropout, options.oracleDepth ? "real" : "no");
+    std::printf("  %.0f poses per second, %.3f us per pose\n", options.poses / std::max(time.count(), 1e-9),
+                time.count() * 1e6 / std::max<long>(options.poses, 1));
+    std::printf("  MPJPE %.3f (%.2f%% of the height), %.3f without aligning the collarbone, %ld joints (%.3f%%) not finite\n",
+                alignedError / joints, 100.0 * alignedError / joints / HEIGHT, absoluteError / joints,
+                nonFinite, 100.0 * nonFinite / static_cast<double>(std::max<long>(measured + nonFinite, 1)));
+    for (int joint = 0; joint < JT_COUNT; joint++) {
+        std::printf("    %-16s %.3f\n", JOINT_NAMES[joint], jointErrors[joint] / std::max<long>(jointCounts[joint], 1));
+    }
+    if (failed > 0) {
+        std::printf("  %ld poses could not be reconstructed\n", failed);
+    }
+    std::printf("  checksum %.6e\n", checksum);
+
+    // any broken pose fails the run, whatever the error of the others is
+    if (failed > 0 || nonFinite > 0) {
+        std::printf("FAILED: the reconstruction gave non-finite joints\n");
+        return 1;
+    }
+    if (options.maxError > 0.0 && alignedError / joints > options.maxError) {
+        std::printf("FAILED: the MPJPE is above %.3f\n", options.maxError);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(arg, "--poses") == 0 && hasValue) {
+            options.poses = std::max(std::atol(argv[++i]), 1L);
+        } else if (std::strcmp(arg, "--seed") == 0 && hasValue) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(arg, "--focal") == 0 && hasValue) {
+            options.focalLength = std::strtof(argv[++i], nullptr);
+        } else if (std::strcmp(arg, "--distance") == 0 && hasValue) {
+            options.distance = std::strtof(argv[++i], nullptr);
+        } else if (std::strcmp(arg, "--noise") == 0 && hasValue) {
+            options.noise = std::strtof(argv[++i], nullptr);
+        } else if (std::strcmp(arg, "--dropout") == 0 && hasValue) {
+            options.dropout = std::strtof(argv[++i], nullptr);
+        } else if (std::strcmp(arg, "--proportions") == 0 && hasValue) {
+            options.proportions = std::strtof(argv[++i], nullptr);
+        } else if (std::strcmp(arg, "--oracle-depth") == 0) {
+            options.oracleDepth = true;
+        } else if (std::strcmp(arg, "--topology") == 0 && hasValue) {
+            options.topology = argv[++i];
+        } else if (std::strcmp(arg, "--max-error") == 0 && hasValue) {
+            options.maxError = std::strtod(argv[++i], nullptr);
+        } else {
+            Usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (std::strcmp(options.topology, "coco") == 0) {
+        return Run<CocoTopology>(options);
+    } else if (std::strcmp(options.topology, "coco17") == 0) {
+        return Run<Coco17Topology>(options);
+    } else if (std::strcmp(options.topology, "body25") == 0) {
+        return Run<Body25Topology>(options);
+    }
+
+    Usage(argv[0]);
+    return 1;
+}
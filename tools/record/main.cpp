@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <atomic>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cstdio>
+#include <chrono>
+#include <string>
+#include <array>
+#include <thread>
+
+#include <ipc/PoseChannel.hpp>
+#include <pose/MotionExport.hpp>
+
+/**
+ * Records the motion of a person from the pose feed of a running service, as a
+ * BVH file for animation tools or as our own binary stream.
+ *
+ * Every frame of the feed is read, not just the newest one, and the file is written
+ * from a thread of its own, so the recording keeps up with the service at its full
+ * rate. The service itself never waits for us, if we fall behind by more than the
+ * ring of the feed the lost frames are counted and reported.
+ */
+
+/**
+ * How long to sleep when there is no new frame, well below a camera frame
+ */
+constexpr auto POLL_INTERVAL = std::chrono::milliseconds(1);
+
+/**
+ * Set by the signal handler to stop recording
+ */
+static std::atomic<bool> mStop { false };
+
+static void OnSignal(int) {
+    mStop = true;
+}
+
+static void Usage(const char* name) {
+    std::printf("usage: %s <output.bvh|output.pmms> [options]\n", name);
+    std::printf("  %-16s %s\n", "--person <n>", "the slot of the person to record, 0 (the user) by default");
+    std::printf("  %-16s %s\n", "--camera <n>", "record from the feed of this camera, 0 by default");
+    std::printf("  %-16s %s\n", "--frames <n>", "stop after this many frames");
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        Usage(argv[0]);
+        return 1;
+    }
+
+    int person = 0;
+    int camera = 0;
+    long maxFrames = -1;
+    for (int i = 2; i < argc; i++) {
+        if (std::strcmp(argv[i], "--person") == 0 && i + 1 < argc) {
+            person = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--camera") == 0 && i + 1 < argc) {
+            camera = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            maxFrames = std::atol(argv[++i]);
+        } else {
+            Usage(argv[0]);
+            return 1;
+        }
+    }
+    if (person < 0 || person >= static_cast<int>(POSE_FEED_MAX_PERSONS)) {
+        std::printf("the person must be between 0 and %u\n", POSE_FEED_MAX_PERSONS - 1);
+        return 1;
+    }
+
+    std::string name = camera == 0 ? POSE_FEED_NAME : std::string(POSE_FEED_NAME) + "-" + std::to_string(camera);
+    PoseReader reader;
+    if (!reader.Open(name.c_str())) {
+        std::printf("failed to open the pose feed %s\n", name.c_str());
+        return 1;
+    }
+
+    MotionExporter exporter;
+    if (!exporter.Open(argv[1])) {
+        std::printf("failed to create %s\n", argv[1]);
+        return 1;
+    }
+
+    std::signal(SIGINT, OnSignal);
+    std::signal(SIGTERM, OnSignal);
+    std::printf("recording %s to %s, ctrl+c to stop\n", name.c_str(), argv[1]);
+
+    PoseFeedFrame frame;
+    uint64_t totalLost = 0;
+    std::array<vector3, JT_COUNT> joints;
+    while (!mStop && (maxFrames < 0 || static_cast<long>(exporter.GetFrameCount()) < maxFrames)) {
+        uint64_t lost;
+        if (!reader.ReadNext(frame, lost)) {
+            std::this_thread::sleep_for(POLL_INTERVAL);
+            continue;
+        }
+        totalLost += lost;
+
+        const PoseFeedPerson& out = frame.persons[person];
+        for (int i = 0; i < JT_COUNT; i++) {
+            joints[i] = { out.joints[i].x, out.joints[i].y, out.joints[i].z };
+        }
+        exporter.Write(frame.captureTime, joints, out.active != 0);
+    }
+
+    uint64_t frames = exporter.GetFrameCount();
+    if (!exporter.Close()) {
+        std::printf("failed to write %s\n", argv[1]);
+        return 1;
+    }
+
+    std::printf("recorded %llu frames, %llu lost\n", static_cast<unsigned long long>(frames), static_cast<unsigned long long>(totalLost));
+    return 0;
+}
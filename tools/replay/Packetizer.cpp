@@ -0,0 +1,265 @@
+#include <algorithm>
+#include <cstring>
+
+#include "Packetizer.hpp"
+
+RtpSender::RtpSender(UdpSocket& socket, uint8_t payloadType, size_t mtu)
+    : socket(socket)
+    , header()
+    , mtu(mtu)
+    , packet(mtu)
+{
+    header.payloadType = payloadType;
+    header.sequence = 0;
+    header.ssrc = 0x504d4642;
+}
+
+void RtpSender::SetTimestamp(uint32_t timestamp) {
+    header.timestamp = timestamp;
+}
+
+size_t RtpSender::GetMaxPayload() const {
+    return mtu - RTP_HEADER_SIZE;
+}
+
+bool RtpSender::Send(const uint8_t* prefix, size_t prefixSize, const uint8_t* payload, size_t payloadSize, bool marker) {
+    header.marker = marker;
+    size_t offset = WriteRtpHeader(packet.data(), header);
+    if (prefixSize != 0) {
+        std::memcpy(packet.data() + offset, prefix, prefixSize);
+    }
+    std::memcpy(packet.data() + offset + prefixSize, payload, payloadSize);
+    header.sequence++;
+    return socket.Send(packet.data(), offset + prefixSize + payloadSize);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// JPEG (RFC 2435)
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+bool SendJpeg(RtpSender& sender, const uint8_t* jpeg, size_t size) {
+    if (size < 4 || jpeg[0] != 0xff || jpeg[1] != 0xd8) {
+        return false;
+    }
+
+    uint8_t tables[128] = {};
+    int type = -1;
+    int width = 0, height = 0;
+    uint16_t restartInterval = 0;
+    size_t scanStart = 0;
+
+    // go over the markers until the start of the scan
+    size_t offset = 2;
+    while (offset + 4 <= size && scanStart == 0) {
+        if (jpeg[offset] != 0xff) {
+            return false;
+        }
+
+        uint8_t marker = jpeg[offset + 1];
+        size_t length = (jpeg[offset + 2] << 8) | jpeg[offset + 3];
+        const uint8_t* segment = jpeg + offset + 4;
+        if (offset + 2 + length > size) {
+            return false;
+        }
+
+        switch (marker) {
+            // quantization tables, we only support 8bit ones
+            case 0xdb: {
+                for (size_t i = 0; i + 65 <= length - 2; i += 65) {
+                    int index = segment[i] & 0x0f;
+                    if ((segment[i] >> 4) != 0 || index > 1) {
+                        return false;
+                    }
+                    std::memcpy(tables + index * 64, segment + i + 1, 64);
+                }
+            } break;
+
+            // baseline frame, must be YUV with 4:2:2 or 4:2:0 subsampling
+            case 0xc0: {
+                height = (segment[1] << 8) | segment[2];
+                width = (segment[3] << 8) | segment[4];
+                if (segment[5] != 3 || segment[10] != 0x11 || segment[13] != 0x11) {
+                    return false;
+                }
+                if (segment[7] == 0x21) {
+                    type = 0;
+                } else if (segment[7] == 0x22) {
+                    type = 1;
+                } else {
+                    return false;
+                }
+            } break;
+
+            // restart interval
+            case 0xdd: {
+                restartInterval = static_cast<uint16_t>((segment[0] << 8) | segment[1]);
+            } break;
+
+            // start of scan, the rest is the entropy coded data
+            case 0xda: {
+                scanStart = offset + 2 + length;
+            } break;
+
+            // progressive and other kinds of frames
+            case 0xc1: case 0xc2: case 0xc3:
+                return false;
+
+            default:
+                break;
+        }
+
+        offset += 2 + length;
+    }
+
+    if (type < 0 || scanStart == 0 || width % 8 != 0 || height % 8 != 0 || width > 2040 || height > 2040) {
+        return false;
+    }
+
+    // drop the EOI, the receiver adds it back
+    size_t scanEnd = size;
+    if (jpeg[scanEnd - 2] == 0xff && jpeg[scanEnd - 1] == 0xd9) {
+        scanEnd -= 2;
+    }
+
+    if (restartInterval != 0) {
+        type += 64;
+    }
+
+    size_t fragmentOffset = 0;
+    size_t scanSize = scanEnd - scanStart;
+    while (fragmentOffset < scanSize) {
+        uint8_t prefix[8 + 4 + 4 + 128];
+        size_t prefixSize = 0;
+
+        // main header, we always send the tables in-band
+        prefix[prefixSize++] = 0;
+        prefix[prefixSize++] = (fragmentOffset >> 16) & 0xff;
+        prefix[prefixSize++] = (fragmentOffset >> 8) & 0xff;
+        prefix[prefixSize++] = fragmentOffset & 0xff;
+        prefix[prefixSize++] = static_cast<uint8_t>(type);
+        prefix[prefixSize++] = 255;
+        prefix[prefixSize++] = static_cast<uint8_t>(width / 8);
+        prefix[prefixSize++] = static_cast<uint8_t>(height / 8);
+
+        // restart header, we don't align fragments to the intervals
+        if (restartInterval != 0) {
+            prefix[prefixSize++] = restartInterval >> 8;
+            prefix[prefixSize++] = restartInterval & 0xff;
+            prefix[prefixSize++] = 0xff;
+            prefix[prefixSize++] = 0xff;
+        }
+
+        // the quantization tables go in the first packet
+        if (fragmentOffset == 0) {
+            prefix[prefixSize++] = 0;
+            prefix[prefixSize++] = 0;
+            prefix[prefixSize++] = 0;
+            prefix[prefixSize++] = 128;
+            std::memcpy(prefix + prefixSize, tables, sizeof(tables));
+            prefixSize += sizeof(tables);
+        }
+
+        size_t chunk = std::min(scanSize - fragmentOffset, sender.GetMaxPayload() - prefixSize);
+        bool last = fragmentOffset + chunk == scanSize;
+        if (!sender.Send(prefix, prefixSize, jpeg + scanStart + fragmentOffset, chunk, last)) {
+            return false;
+        }
+
+        fragmentOffset += chunk;
+    }
+
+    return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// H.264 (RFC 6184)
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Find the next start code, returns the offset of the first byte after it
+ */
+static size_t NextNalUnit(const uint8_t* stream, size_t size, size_t offset, size_t& startCode) {
+    for (size_t i = offset; i + 3 <= size; i++) {
+        if (stream[i] == 0 && stream[i + 1] == 0 && stream[i + 2] == 1) {
+            startCode = (i > 0 && stream[i - 1] == 0) ? i - 1 : i;
+            return i + 3;
+        }
+    }
+    startCode = size;
+    return size;
+}
+
+void SplitAccessUnits(const uint8_t* stream, size_t size, std::vector<std::pair<size_t, size_t>>& units) {
+    units.clear();
+
+    size_t startCode;
+    size_t nal = NextNalUnit(stream, size, 0, startCode);
+    size_t unitStart = startCode;
+    bool haveSlice = false;
+
+    while (nal < size) {
+        size_t nextStartCode;
+        size_t next = NextNalUnit(stream, size, nal, nextStartCode);
+
+        uint8_t type = stream[nal] & 0x1f;
+        bool slice = type == 1 || type == 5;
+
+        // a slice with first_mb_in_slice == 0 starts a new picture, and so
+        // does any parameter set or delimiter after a slice
+        bool newPicture = slice ? (nal + 1 < size && (stream[nal + 1] & 0x80) != 0) : (type >= 6 && type <= 9);
+        if (newPicture && haveSlice) {
+            units.emplace_back(unitStart, startCode - unitStart);
+            unitStart = startCode;
+            haveSlice = false;
+        }
+        haveSlice |= slice;
+
+        startCode = nextStartCode;
+        nal = next;
+    }
+
+    if (unitStart < size) {
+        units.emplace_back(unitStart, size - unitStart);
+    }
+}
+
+bool SendAccessUnit(RtpSender& sender, const uint8_t* unit, size_t size) {
+    size_t startCode;
+    size_t nal = NextNalUnit(unit, size, 0, startCode);
+
+    while (nal < size) {
+        size_t nextStartCode;
+        size_t next = NextNalUnit(unit, size, nal, nextStartCode);
+        size_t nalSize = nextStartCode - nal;
+        bool lastNal = next >= size;
+
+        if (nalSize <= sender.GetMaxPayload()) {
+            // fits as is
+            if (!sender.Send(nullptr, 0, unit + nal, nalSize, lastNal)) {
+                return false;
+            }
+        } else {
+            // split into FU-A fragments, the NAL header is moved into the FU headers
+            uint8_t nalHeader = unit[nal];
+            size_t offset = 1;
+            while (offset < nalSize) {
+                size_t chunk = std::min(nalSize - offset, sender.GetMaxPayload() - 2);
+                bool first = offset == 1;
+                bool last = offset + chunk == nalSize;
+
+                uint8_t prefix[2];
+                prefix[0] = (nalHeader & 0xe0) | 28;
+                prefix[1] = (first ? 0x80 : 0) | (last ? 0x40 : 0) | (nalHeader & 0x1f);
+                if (!sender.Send(prefix, sizeof(prefix), unit + nal + offset, chunk, last && lastNal)) {
+                    return false;
+                }
+
+                offset += chunk;
+            }
+        }
+
+        nal = next;
+    }
+
+    return true;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include <net/UdpSocket.hpp>
+#include <capture/RtpPayload.hpp>
+
+/**
+ * Sends frames as RTP packets, keeping track of the sequence numbers
+ */
+class RtpSender {
+private:
+    UdpSocket& socket;
+    RtpHeader header;
+    size_t mtu;
+    std::vector<uint8_t> packet;
+
+public:
+
+    RtpSender(UdpSocket& socket, uint8_t payloadType, size_t mtu);
+
+    /**
+     * Set the timestamp of the next packets
+     */
+    void SetTimestamp(uint32_t timestamp);
+
+    /**
+     * How much payload fits in a single packet
+     */
+    size_t GetMaxPayload() const;
+
+    /**
+     * Send a single packet, made of a payload header and the payload itself
+     */
+    bool Send(const uint8_t* prefix, size_t prefixSize, const uint8_t* payload, size_t payloadSize, bool marker);
+};
+
+/**
+ * Send a baseline JPEG image as RFC 2435 packets, the quantization tables are
+ * sent in-band and the huffman tables must be the standard ones.
+ *
+ * @return False if the JPEG can not be sent as RTP
+ */
+bool SendJpeg(RtpSender& sender, const uint8_t* jpeg, size_t size);
+
+/**
+ * Split an H.264 Annex B stream into access units
+ *
+ * @param stream    [IN]    The whole stream
+ * @param size      [IN]    The size of the stream
+ * @param units     [OUT]   The offset and size of each access unit
+ */
+void SplitAccessUnits(const uint8_t* stream, size_t size, std::vector<std::pair<size_t, size_t>>& units);
+
+/**
+ * Send a single H.264 access unit as RFC 6184 packets, using FU-A for
+ * NAL units that don't fit in a single packet.
+ */
+bool SendAccessUnit(RtpSender& sender, const uint8_t* unit, size_t size);
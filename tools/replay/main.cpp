@@ -0,0 +1,190 @@
+#include <opencv2/opencv.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <net/UdpSocket.hpp>
+
+#include "Packetizer.hpp"
+
+/**
+ * Replays a video file as an RTP stream, just like the phone app would send
+ * it, so the network source can be tested on loopback without a phone.
+ *
+ * Any video OpenCV can open is sent as MJPEG, raw .h264 files are sent
+ * as is as H.264.
+ */
+
+/**
+ * A packet size that fits in a regular ethernet frame
+ */
+constexpr size_t MTU = 1400;
+
+/**
+ * The quality used to encode the frames for MJPEG
+ */
+constexpr int JPEG_QUALITY = 80;
+
+static void Usage(const char* name) {
+    std::printf("usage: %s <file> [host] [port] [fps] [--loop]\n", name);
+    std::printf("  host     where to send the stream (default 127.0.0.1)\n");
+    std::printf("  port     the port the service listens on (default 5000)\n");
+    std::printf("  fps      the rate to send at (default from the file, or 30)\n");
+    std::printf("  --loop   start over at the end of the file\n");
+}
+
+static bool EndsWith(const std::string& string, const char* suffix) {
+    size_t length = std::strlen(suffix);
+    return string.size() >= length && string.compare(string.size() - length, length, suffix) == 0;
+}
+
+/**
+ * Send frames at a steady rate
+ */
+class Pacer {
+private:
+    std::chrono::steady_clock::time_point start;
+    std::chrono::duration<double> interval;
+    uint64_t frame;
+
+public:
+    explicit Pacer(double fps)
+        : start(std::chrono::steady_clock::now())
+        , interval(1.0 / fps)
+        , frame(0)
+    {}
+
+    uint32_t Next() {
+        std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(interval * frame));
+        return static_cast<uint32_t>(frame++ * interval.count() * RTP_CLOCK_RATE);
+    }
+};
+
+static int ReplayH264(const std::string& path, UdpSocket& socket, double fps, bool loop) {
+    std::ifstream file(path, std::ios::binary);
+    std::vector<uint8_t> stream((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (stream.empty()) {
+        std::printf("failed to read %s\n", path.c_str());
+        return 1;
+    }
+
+    std::vector<std::pair<size_t, size_t>> units;
+    SplitAccessUnits(stream.data(), stream.size(), units);
+    std::printf("sending %zu access units at %.1f fps\n", units.size(), fps);
+
+    RtpSender sender(socket, RTP_PAYLOAD_H264, MTU);
+    Pacer pacer(fps);
+    do {
+        for (const auto& unit : units) {
+            sender.SetTimestamp(pacer.Next());
+            if (!SendAccessUnit(sender, stream.data() + unit.first, unit.second)) {
+                std::printf("failed to send\n");
+                return 1;
+            }
+        }
+    } while (loop);
+
+    return 0;
+}
+
+static int ReplayMjpeg(const std::string& path, UdpSocket& socket, double fps, bool loop) {
+    cv::VideoCapture capture(path);
+    if (!capture.isOpened()) {
+        std::printf("failed to open %s\n", path.c_str());
+        return 1;
+    }
+
+    if (fps <= 0) {
+        fps = capture.get(cv::CAP_PROP_FPS);
+        if (fps <= 0) {
+            fps = 30;
+        }
+    }
+    std::printf("sending at %.1f fps\n", fps);
+
+    RtpSender sender(socket, RTP_PAYLOAD_JPEG, MTU);
+    Pacer pacer(fps);
+    cv::Mat image, resized;
+    std::vector<uint8_t> jpeg;
+    std::vector<int> params { cv::IMWRITE_JPEG_QUALITY, JPEG_QUALITY };
+    uint64_t sent = 0;
+
+    while (true) {
+        if (!capture.read(image)) {
+            if (!loop) {
+                break;
+            }
+            capture.set(cv::CAP_PROP_POS_FRAMES, 0);
+            continue;
+        }
+
+        // the payload can only describe sizes that are a multiple of 8
+        cv::Size size(std::min(image.cols / 8 * 8, 2040), std::min(image.rows / 8 * 8, 2040));
+        if (size != image.size()) {
+            cv::resize(image, resized, size);
+            cv::imencode(".jpg", resized, jpeg, params);
+        } else {
+            cv::imencode(".jpg", image, jpeg, params);
+        }
+
+        sender.SetTimestamp(pacer.Next());
+        if (!SendJpeg(sender, jpeg.data(), jpeg.size())) {
+            std::printf("failed to send frame %llu\n", static_cast<unsigned long long>(sent));
+            return 1;
+        }
+        sent++;
+    }
+
+    std::printf("sent %llu frames\n", static_cast<unsigned long long>(sent));
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    std::string path;
+    std::string host = "127.0.0.1";
+    int port = 5000;
+    double fps = 0;
+    bool loop = false;
+
+    int positional = 0;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--loop") == 0) {
+            loop = true;
+        } else if (std::strcmp(argv[i], "--help") == 0) {
+            Usage(argv[0]);
+            return 0;
+        } else {
+            switch (positional++) {
+                case 0: path = argv[i]; break;
+                case 1: host = argv[i]; break;
+                case 2: port = std::atoi(argv[i]); break;
+                case 3: fps = std::atof(argv[i]); break;
+                default: Usage(argv[0]); return 1;
+            }
+        }
+    }
+
+    if (path.empty()) {
+        Usage(argv[0]);
+        return 1;
+    }
+
+    UdpSocket socket;
+    if (!socket.Connect(host.c_str(), static_cast<uint16_t>(port))) {
+        std::printf("invalid address %s\n", host.c_str());
+        return 1;
+    }
+
+    if (EndsWith(path, ".h264") || EndsWith(path, ".264")) {
+        return ReplayH264(path, socket, fps > 0 ? fps : 30, loop);
+    } else {
+        return ReplayMjpeg(path, socket, fps, loop);
+    }
+}
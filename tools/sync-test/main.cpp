@@ -0,0 +1,178 @@
+#include <cstdint>
+#include <cstdio>
+#include <cmath>
+
+#include <tracking/FrameSynchronizer.hpp>
+
+/**
+ * Checks the frame synchronizer on made up cameras, where every keypoint moves
+ * linearly with the capture time so the interpolated keypoints must land exactly
+ * on the instant of the set.
+ */
+
+/**
+ * The time between frames of the cameras, and how long to wait for a slow one, in microseconds
+ */
+constexpr int64_t FRAME_TIME = 33333;
+constexpr int64_t MAX_WAIT = 50000;
+
+/**
+ * How far the interpolated keypoints may be from where they should be
+ */
+constexpr float TOLERANCE = 1e-4f;
+
+static int failures = 0;
+
+static void Expect(bool condition, const char* what) {
+    if (!condition) {
+        std::printf("  FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+/**
+ * Where the keypoints of a person are at a given time
+ */
+static float PositionAt(int64_t timestamp) {
+    return static_cast<float>(timestamp) / 1e6f;
+}
+
+static CameraKeypoints MakeFrame(int64_t timestamp, uint32_t id) {
+    CameraKeypoints keypoints {};
+    keypoints.timestamp = timestamp;
+    keypoints.ids[0] = id;
+    for (int joint = 0; joint < JT_COUNT; joint++) {
+        keypoints.persons[0].points[joint] = vector2(PositionAt(timestamp), 0.5f);
+        keypoints.persons[0].confidences[joint] = 1.0f;
+    }
+    return keypoints;
+}
+
+/**
+ * Is the keypoint of every valid camera where it should be at the instant of the set
+ */
+static bool IsInterpolated(const FrameSet& set, int cameras) {
+    for (int camera = 0; camera < cameras; camera++) {
+        if (!set.valid[camera]) {
+            continue;
+        }
+        const auto& person = set.cameras[camera].persons[0];
+        if (std::fabs(person.points[JT_HEAD].x - PositionAt(set.timestamp)) > TOLERANCE) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Two cameras half a frame apart, every set must be at a new instant and
+ * have both cameras interpolated to it. The first set is older than the first
+ * frame of one of them, which stands in for it, so that one is not checked.
+ */
+static void CheckInterleaved() {
+    std::printf("two cameras half a frame apart\n");
+    FrameSynchronizer synchronizer(2, MAX_WAIT);
+    FrameSet set;
+
+    int sets = 0;
+    int64_t last = -1;
+    bool increasing = true;
+    bool interpolated = true;
+    bool bothValid = true;
+    for (int frame = 0; frame < 30; frame++) {
+        synchronizer.Push(0, MakeFrame(frame * FRAME_TIME, 1));
+        synchronizer.Push(1, MakeFrame(frame * FRAME_TIME + FRAME_TIME / 2, 1));
+        while (synchronizer.Assemble(set)) {
+            increasing = increasing && set.timestamp > last;
+            interpolated = interpolated && (sets == 0 || IsInterpolated(set, 2));
+            bothValid = bothValid && set.valid[0] && set.valid[1];
+            last = set.timestamp;
+            sets++;
+        }
+    }
+
+    Expect(sets == 30, "a set for every frame of the slower camera");
+    Expect(increasing, "the sets go forward in time");
+    Expect(interpolated, "the keypoints are interpolated to the instant of the set");
+    Expect(bothValid, "both cameras are in every set");
+    Expect(synchronizer.GetStatistics().stragglers == 0, "nobody is left out");
+}
+
+/**
+ * A camera that stops is waited for only as long as the wait, then the
+ * other one goes on without it, and it comes back once it catches up
+ */
+static void CheckStraggler() {
+    std::printf("a camera that stalls\n");
+    FrameSynchronizer synchronizer(2, MAX_WAIT);
+    FrameSet set;
+
+    int withoutSecond = 0;
+    int withBoth = 0;
+    bool interpolated = true;
+    for (int frame = 0; frame < 30; frame++) {
+        synchronizer.Push(0, MakeFrame(frame * FRAME_TIME, 1));
+        bool stalled = frame >= 10 && frame < 20;
+        if (!stalled) {
+            synchronizer.Push(1, MakeFrame(frame * FRAME_TIME + 1000, 1));
+        }
+        while (synchronizer.Assemble(set)) {
+            interpolated = interpolated && (withBoth + withoutSecond == 0 || IsInterpolated(set, 2));
+            if (set.valid[1]) {
+                withBoth++;
+            } else {
+                withoutSecond++;
+            }
+        }
+    }
+
+    Expect(interpolated, "the keypoints are interpolated to the instant of the set");
+    Expect(withoutSecond > 0, "the first camera goes on without the stalled one");
+    Expect(withoutSecond < 10, "the stalled camera is waited for a bit");
+    Expect(withBoth >= 19, "the stalled camera comes back");
+    Expect(synchronizer.GetStatistics().stragglers == static_cast<uint64_t>(withoutSecond), "the stragglers are counted");
+}
+
+/**
+ * Someone that is only in one of the frames around the instant is taken from
+ * the nearest frame, and a keypoint only one of them has loses confidence
+ */
+static void CheckMissing() {
+    std::printf("people and keypoints in only one frame\n");
+    FrameSet set;
+
+    // the second camera puts the set a quarter of the way between the frames of the first
+    FrameSynchronizer people(2, MAX_WAIT);
+    people.Push(0, MakeFrame(0, 1));
+    people.Push(0, MakeFrame(FRAME_TIME, 2));
+    people.Push(1, MakeFrame(FRAME_TIME / 4, 1));
+    Expect(people.Assemble(set) && set.timestamp == FRAME_TIME / 4 && set.valid[0], "a set between the two frames");
+    Expect(set.cameras[0].ids[0] == 1 && set.cameras[0].persons[0].points[JT_HEAD].x == PositionAt(0),
+           "someone else in the next frame is taken from the nearest frame");
+
+    CameraKeypoints second = MakeFrame(FRAME_TIME, 1);
+    second.persons[0].confidences[JT_LEFT_WRIST] = 0.0f;
+    FrameSynchronizer keypoints(2, MAX_WAIT);
+    keypoints.Push(0, MakeFrame(0, 1));
+    keypoints.Push(0, second);
+    keypoints.Push(1, MakeFrame(FRAME_TIME / 4, 1));
+    Expect(keypoints.Assemble(set) && set.valid[0], "a set between the two frames");
+
+    const auto& person = set.cameras[0].persons[0];
+    Expect(IsInterpolated(set, 2), "the keypoints both frames have are interpolated");
+    Expect(person.points[JT_LEFT_WRIST].x == PositionAt(0), "a keypoint only one frame has is taken as it is");
+    Expect(std::fabs(person.confidences[JT_LEFT_WRIST] - 0.75f) < TOLERANCE, "with less confidence the further away it is");
+}
+
+int main() {
+    CheckInterleaved();
+    CheckStraggler();
+    CheckMissing();
+
+    if (failures > 0) {
+        std::printf("%d checks failed\n", failures);
+        return 1;
+    }
+    std::printf("all passed\n");
+    return 0;
+}